@@ -32,6 +32,18 @@
 /* set to false to save memory and optimise MCU speed */
 bool const DEBUG = false;
 #define DEBUG_BAUDRATE 115200 // Or the usual 9600
+/* MEMORY MONITOR, UNCOMMENT to check RAM use while the pack runs (AVR boards) : stack max size, */
+/* free RAM left between heap and stack, heap fragmentation. Send 'm' in the Serial monitor to print the report. */
+// #define MEMORY_MONITOR
+#define MEMORY_GUARD_MARGIN 64 // bytes, min free RAM between heap and stack before a warning
+/* UNCOMMENT to stop the pack (LEDs, sound, smoke and rumble OFF) when the guard margin is crossed, */
+/* instead of running on until a random reset. */
+// #define MEMORY_GUARD_HALT
+/* BENCHMARK MODE, UNCOMMENT to measure the CPU cycles of the engines hot functions at boot (AVR boards). */
+/* The results table is printed on the Serial monitor, then the pack starts normally. */
+/* Copy the table in a file to compare code versions. Use PLAYER_MOCK to run it without audio board. */
+// #define BENCHMARK_MODE
+#define BENCHMARK_DURATION 1000 // ms of calls for each function
 
 /*********************************************/
 /*                                           */
@@ -95,6 +107,85 @@ const uint32_t RUMBLER_MAX_ON_TIME = 15000; // in ms
 const uint32_t RUMBLER_MIN_OFF_TIME = 2000; // in ms
                                             /* Rumbler is activated, if minimum off time is respected, when the pack goes into firing */
 
+/*********************************************/
+/*        OPTION : DIMMED GPIO INDICATOR     */
+/*********************************************/
+/* UNCOMMENT and DEFINE PIN number of a plain LED indicator (ex. power LED on the pack front) : it breathes */
+/* while the pack is powered down and stays ON otherwise, dimmed by the soft PWM timer interrupt. Timer 1 */
+/* on Nano (analogWrite() on D9/D10 lost, servos can't be used), TCB1 on Nano Every (tone() and */
+/* analogWrite() on D3 lost). Without this option, the soft PWM and its interrupt are not in the build. */
+/* With DEBUG or a Serial monitor option, send 'p' to print the longest interrupt in CPU cycles (256 max). */
+// #define GPIO_INDICATOR_PIN A2    /* plain LED indicator, through its resistor */
+#define GPIO_INDICATOR_PULSE 2000 // breathing period in ms
+
+/*********************************************/
+/*     OPTION : PARALLEL LEDS CHAINS OUTPUT  */
+/*********************************************/
+/* UNCOMMENT to send the pack and wand LEDs chains in one pass when PK_LEDS and WD_LEDS are on the same */
+/* MCU port (ex. D2/D3 on a Nano, D8/D12 on a Nano Every), 16 MHz AVR only. Interrupts are off for the */
+/* longest chain only, and both chains are updated on each LEDs update. Ignored on other boards or pins. */
+/* Bit timings are in spec for WS2812B and later LEDs, not the original WS2812 (1 bits low too short). */
+// #define WS2812_PARALLEL
+
+/*********************************************/
+/*     OPTION : PACK LEDS BY USART (SPI)     */
+/*********************************************/
+/* UNCOMMENT to send the pack LEDs chain with the ATmega4809 USART in SPI mode (Nano Every only) */
+/* PK_LEDS must be D2 or D6. Interrupts stay enabled while the pack chain is sent, player serial and */
+/* millis() are not disturbed, but the CPU is mostly busy feeding the USART (1.2 ms for 45 pixels). */
+/* Takes the level 1 interrupt priority, not compatible with DUAL_PLAYER (Software Serial) : no code may */
+/* turn interrupts off for more than about 2 us while the chain is sent (one symbol byte each 3 us), or */
+/* the USART runs dry in the middle of a LED bit and the rest of the frame is lost. */
+/* Ignored on other boards or pins. Bit timings are in spec for WS2812B and later LEDs, not the original */
+/* WS2812 (1 bits low too short). */
+// #define WS2812_USART
+
+/*********************************************/
+/*  OPTION : LEDS GAMMA, BRIGHTNESS & BALANCE */
+/*********************************************/
+/* UNCOMMENT to apply gamma correction, chain brightness and white balance when the LEDs chains are sent. */
+/* Fades look smoother at low levels. The lowest levels get a linear toe (a quarter of the level) under */
+/* the gamma curve : ex. GB12_PWD_MAX_BRIGHTNESS 10 pulses over 3 steps. Uses 768 bytes of RAM for each */
+/* chain : Nano Every recommended. */
+// #define WS2812_COLOR_STAGE
+#define PACK_LEDS_BRIGHTNESS 255       // 0-255
+#define WAND_LEDS_BRIGHTNESS 255       // 0-255
+#define PACK_LEDS_BALANCE 255, 255, 255 // red, green, blue max levels, lower one to correct the LEDs white
+#define WAND_LEDS_BALANCE 255, 255, 255 // red, green, blue max levels
+
+/*********************************************/
+/*     OPTION : LEDS LOW LEVELS DITHERING    */
+/*********************************************/
+/* UNCOMMENT, with WS2812_COLOR_STAGE, to dither the lowest LEDs levels (powered down cyclotron, rod tail end) */
+/* between their two nearest values. A chain with dithered levels is sent again between its updates, */
+/* about 11 us by chain byte with interrupts off (10 us output, 1 us dithering) : 1.5 ms for a 45 pixels */
+/* chain, 0.23 ms for 7 pixels, each 10 ms. Chains longer than 2 ms to send are not dithered. */
+/* Uses one more byte of RAM by chain byte. */
+// #define WS2812_DITHER
+
+/*********************************************/
+/*     OPTION : LEDS CROSSFADE & OVERLAYS    */
+/*********************************************/
+/* UNCOMMENT to crossfade the LEDs chains between the pack states animations, and flash the cyclotron */
+/* over its animation while overheating. Uses two more RAM buffers of each chain size. */
+// #define LEDS_COMPOSITOR
+#define LEDS_CROSSFADE_TIME 250 // ms, from the previous state animations to the new ones
+#define LEDS_OVERHEAT_FLASH 160 // 0-255, cyclotron overheat flash level
+
+/*********************************************/
+/*    OPTION : KEYFRAMES VENT BOOT SEQUENCE  */
+/*********************************************/
+/* UNCOMMENT to play the pack vent boot sequence from KeyframeAnimations.h instead of its built-in fades. */
+/* New sequences are made from CSV or PNG files with Tools/SBK_KEYFRAME_ENCODER. */
+// #define VENT_KEYFRAMES
+
+/*********************************************/
+/*   OPTION : LEDS OUTPUT INTERRUPTS CHECK   */
+/*********************************************/
+/* UNCOMMENT to count the LEDs outputs sent with interrupts off, and how many audio player reply bytes */
+/* they could make lost in the worst case. Send 'w' in the Serial monitor to print the counts. */
+// #define WS2812_BLACKOUT_STATS
+
 /*********************************************/
 /*           BAR GRAPH & DRIVER(s)           */
 /*********************************************/
@@ -110,7 +201,8 @@ const bool BG_DIRECTION = FORWARD; // animation direction (FORWARD/REVERSE)
 /*  DEFINE segments mapping on bar graph driver {ROW,COL}.    */
 /*  This mapping works for SBK_BARGRAPH_28_SEG_SK_PCB    */
 /*  or SBK_BARGRAPH_10_SEG_SK_PCB, those are common cathode    */
-const uint8_t BG_SEG_MAP[28][2] = {
+/*  Kept in flash memory (PROGMEM), read directly by the driver. */
+const uint8_t BG_SEG_MAP[28][2] PROGMEM = {
     {0, 0}, // SEG #1
     {0, 1}, // SEG #2
     {0, 2}, // SEG #3
@@ -170,24 +262,30 @@ const bool CYCLOTRON_DIRECTION = FORWARD; // animation direction (FORWARD/REVERS
 // >>> Uncomment only one cyclotron style and define cyclotron LEDs index on the PACK chain:
 #define GB12 /* cyclotron with 4 rotating positions, could be use with ring LEDs or 4 pixels/jewels*/
 // #define AFFE /* Only available for ring LEDS */
+// >>> Uncomment to compile both styles and switch between them : with the pack powered down and the themes
+// switch OFF, hold fire and rod buttons for CYC_STYLE_HOLD_TIME. The style is saved in EEPROM, the one
+// above is the default. Define both styles LEDs below. Both styles share one LEDs buffer.
+// #define CYC_STYLE_SWITCH
+#define CYC_STYLE_HOLD_TIME 3000 // ms
+#define CYC_STYLE_EEPROM_ADDR 0  // EEPROM byte for the saved style
 /*****************************/
 /* >>>>> GB1/GB2 style <<<<< */
 /*****************************/
-#ifdef GB12
-// Cyclotron 4 positions 1st and last pixels index (each jewel) in the WS2812 pack chain
-const uint8_t CYC_POS1_1ST_LED = 7;
-const uint8_t CYC_POS1_LAST_LED = 13;
-const uint8_t CYC_POS2_1ST_LED = 14;
-const uint8_t CYC_POS2_LAST_LED = 20;
-const uint8_t CYC_POS3_1ST_LED = 21;
-const uint8_t CYC_POS3_LAST_LED = 27;
-const uint8_t CYC_POS4_1ST_LED = 28;
-const uint8_t CYC_POS4_LAST_LED = 34;
+#if defined(GB12) || defined(CYC_STYLE_SWITCH)
+// Cyclotron positions 1st and last pixels index (each jewel) in the WS2812 pack chain, in rotation order.
+// GB1/GB2 packs have 4 positions, add or remove lines for custom cyclotrons (5, 6, 8 positions...)
+const uint8_t CYC_POSITIONS[][2] PROGMEM = {
+    // {1ST LED, LAST LED}
+    {7, 13},  // Position 1
+    {14, 20}, // Position 2
+    {21, 27}, // Position 3
+    {28, 34}  // Position 4
+};
 #endif
 /***************************/
 /* >>>>> AF/FE style <<<<< */
 /***************************/
-#ifdef AFFE
+#if defined(AFFE) || defined(CYC_STYLE_SWITCH)
 const uint8_t CYC_RING_1ST_LED = 0;   // Cyclotron first pixel index position in WS2812 pack chain
 const uint8_t CYC_RING_LAST_LED = 44; // Cyclotron last pixel index position in WS2812 pack chain
 #endif
@@ -217,6 +315,23 @@ const uint8_t WAND_LED_TIP_LAST = 12;
 const uint8_t INDICATOR_FAST_FLASH = 100;
 const uint16_t INDICATOR_MEDIUM_FLASH = 500;
 const uint16_t INDICATOR_SLOW_FLASH = 1000;
+// Indicators blink patterns, all advanced by one shared tick : {steps bits (bit 0 first, 1 = ON), steps number (8 or 16), step time (ms)}
+// Step times are rounded to INDICATOR_TICK multiples, up to 255 ticks. Add lines for new patterns, with their index below.
+const uint8_t INDICATOR_TICK = 20; // ms
+const uint16_t INDICATOR_PATTERNS[][3] PROGMEM = {
+    {0xFFFF, 16, INDICATOR_TICK},         // 0 : solid
+    {0xAAAA, 16, INDICATOR_FAST_FLASH},   // 1 : fast flash
+    {0xAAAA, 16, INDICATOR_MEDIUM_FLASH}, // 2 : medium flash
+    {0xAAAA, 16, INDICATOR_SLOW_FLASH},   // 3 : slow flash
+    {0x0005, 16, INDICATOR_FAST_FLASH},   // 4 : double blink
+    {0x000B, 16, 60},                     // 5 : heartbeat
+};
+const uint8_t INDICATOR_SOLID = 0;
+const uint8_t INDICATOR_FAST = 1;
+const uint8_t INDICATOR_MEDIUM = 2;
+const uint8_t INDICATOR_SLOW = 3;
+const uint8_t INDICATOR_DOUBLE_BLINK = 4;
+const uint8_t INDICATOR_HEARTBEAT = 5;
 
 /*********************************************/
 /*                                           */
@@ -239,6 +354,21 @@ const uint16_t AUDIO_ADVANCE = 150;        // short advance to call the next tra
 /*  SELECT (uncommnent) your supported audio board and library : */
 #define DFP_MINI_FAST /* To use DFPlayer Mini with the Fast library */
 // #define DFP_MINI /* To use DFPlayer Mini with the DFRobot library */
+// #define PLAYER_MOCK /* No audio board : commands are only counted, tracks are timed with TRACK_LENGTH. For tests and benchmarks. */
+/**************************************/
+/*     OPTION : DUAL AUDIO PLAYER     */
+/**************************************/
+/* UNCOMMENT and DEFINE PINS if a second audio player of the same type is used as a sound FX voice : */
+/* looping tracks (idle hum, themes) stay on the first player, the other tracks play on the second one. */
+/* TRACK_OVERLAY tracks are then layered over the hum instead of pausing it. Both SD cards need the same tracks. */
+/* Nano Every only : the first player stays on Serial1, the second player uses a Software Serial on these pins. */
+/* Each byte sent to the second player blocks interrupts for about 1 ms (10 bits at 9600 baud), so about 10 ms */
+/* for each command. A Nano has only one hardware UART for the debug Serial Monitor : not supported. */
+// #define DUAL_PLAYER
+// #define SFX_RX A0 /* If dual player is used, to second audio board Tx pin */
+// #define SFX_TX A1 /* If dual player is used, to second audio board Rx pin */
+const uint8_t LOOP_VOICE_GAIN = 80; // 0-100 % of the volume for the looping tracks player, to balance it with sound FX
+const uint8_t SFX_VOICE_GAIN = 100; // 0-100 % of the volume for the sound FX player
 /****************************/
 /*  SOUND FX TRACKS INDEX   */
 /****************************/
@@ -264,8 +394,8 @@ const int16_t SHUTDOWN_TRACK = 11;
 /*  Those are used to determine the track's playing end in the CORE main loop to minimize delay in switching sound FX tracks, no BUSY pin is used. */
 /*  It also prevent using the get track length functions that could cause some delay with some players */
 /*  You can get your exact track lengths in Audacity or others audio software*/
-/*  DEFINE the tracks lengths in milliseconde here :*/
-const uint16_t TRACK_LENGTH[] = {
+/*  DEFINE the tracks lengths in milliseconde here (kept in flash memory) :*/
+const uint16_t TRACK_LENGTH[] PROGMEM = {
     0,     // no track, it just to offset with tracks index
     5000,  // track #1
     10000, // track #2
@@ -283,19 +413,47 @@ const uint16_t TRACK_LENGTH[] = {
 /* SOUND FX TRACKS LOOPING  */
 /****************************/
 /* Tracks that need looping must be set to 'true' : */
-const uint16_t TRACK_LOOPING[] = {
-    false, // no track, powered down, no looping
-    false, // track #1
-    true,  // track #2 Idle track needs looping
-    true,  // track #3 Idle track needs looping
-    false, // track #4
-    false, // track #5
-    false, // track #6
-    true,  // track #7 Idle firing needs looping if shorter then FIRE_DURATION
-    false, // track #8
-    false, // track #9
-    false, // track #10
-    false  // track #11
+/* One bit per track, packed at compile time, no memory used. 16 tracks at most (0 to 15). */
+const uint16_t TRACK_LOOPING =
+    (false << 0) |    // no track, powered down, no looping
+    (false << 1) |    // track #1
+    (true << 2) |     // track #2 Idle track needs looping
+    (true << 3) |     // track #3 Idle track needs looping
+    (false << 4) |    // track #4
+    (false << 5) |    // track #5
+    (false << 6) |    // track #6
+    (true << 7) |     // track #7 Idle firing needs looping if shorter then FIRE_DURATION
+    (false << 8) |    // track #8
+    (false << 9) |    // track #9
+    (false << 10) |   // track #10
+    (false << 11);    // track #11
+static_assert(sizeof(TRACK_LENGTH) / sizeof(TRACK_LENGTH[0]) <= 16, "TRACK_LOOPING holds 16 tracks flags (0 to 15), TRACK_LENGTH has more tracks");
+/****************************/
+/* SOUND FX TRACKS OVERLAY  */
+/****************************/
+/* How each pack state track is started : */
+/*  TRACK_REPLACE : the track replaces the playing one (stop and play, or loop). */
+/*  TRACK_OVERLAY : the track is inserted over the looping idle hum with the player "advertisement" feature, */
+/*                  the hum resumes by itself when the inserted track is done : one command, no restart gap. */
+/*                  Overlay tracks must ALSO be copied in the >>> "/ADVERT/" <<< folder of the SD card, */
+/*                  named with the track number : 0006.mp3, 0007.mp3, etc. */
+/*                  Looping overlay tracks are inserted again each time they are done. */
+/* Only use TRACK_OVERLAY for states entered while a looping track is playing (firing and tail states). */
+const uint8_t TRACK_REPLACE = 0;
+const uint8_t TRACK_OVERLAY = 1;
+const uint8_t TRACK_MODE[] PROGMEM = {
+    TRACK_REPLACE, // no track, powered down
+    TRACK_REPLACE, // track #1
+    TRACK_REPLACE, // track #2
+    TRACK_REPLACE, // track #3
+    TRACK_REPLACE, // track #4
+    TRACK_REPLACE, // track #5
+    TRACK_REPLACE, // track #6 Firing ramp, can be TRACK_OVERLAY
+    TRACK_REPLACE, // track #7 Firing max, can be TRACK_OVERLAY
+    TRACK_REPLACE, // track #8 Firing overheat, can be TRACK_OVERLAY
+    TRACK_REPLACE, // track #9 Tail, can be TRACK_OVERLAY
+    TRACK_REPLACE, // track #10
+    TRACK_REPLACE  // track #11
 };
 /*****************/
 /* THEMES TRACKS */
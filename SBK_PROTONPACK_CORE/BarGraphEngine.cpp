@@ -18,11 +18,20 @@
 
 #include "BarGraphEngine.h"
 
-BarGraphAnimation::BarGraphAnimation(uint8_t numLeds) : _numLeds(numLeds) {}
+BarGraphAnimation::BarGraphAnimation(uint8_t numLeds) : _numLeds(numLeds)
+{
+    _all = _lowSegments(numLeds);
+    _frame = 0;
+}
 
 bool BarGraphAnimation::getLedState(uint8_t index)
 {
-    return _ledState[index];
+    return (_frame >> index) & 1;
+}
+
+BarGraphMask BarGraphAnimation::getFrame()
+{
+    return _frame;
 }
 
 void BarGraphAnimation::clear()
@@ -36,7 +45,7 @@ void BarGraphAnimation::clear()
     setLow();
 }
 
-bool BarGraphAnimation::boot(uint8_t bootSp, uint8_t idle1Sp, bool init)
+bool BarGraphAnimation::boot(uint8_t bootSp, uint8_t idle1Sp, bool init, unsigned long now)
 {
     static bool flag = false;
     if (init)
@@ -48,23 +57,12 @@ bool BarGraphAnimation::boot(uint8_t bootSp, uint8_t idle1Sp, bool init)
 
     if (!_bootState)
     {
-        if (millis() - _prevTime >= bootSp)
+        for (uint8_t n = _step.steps(now, bootSp); n > 0 && !_bootState; n--)
         {
-            //_prevTime += (unsigned long)bootSp;
-            _prevTime = millis();
             if (!flag)
             {
-                for (int8_t i = _numLeds - 1; i >= 0; i--)
-                {
-                    if (i >= _runningLedTracker)
-                    {
-                        _ledState[i] = true;
-                    }
-                    else
-                    {
-                        _ledState[i] = false;
-                    }
-                }
+                // Segments from the running led tracker to the top are ON
+                _frame = _all & ~_lowSegments(_runningLedTracker);
                 if (_runningLedTracker >= 0)
                 {
                     _runningLedTracker--;
@@ -77,17 +75,8 @@ bool BarGraphAnimation::boot(uint8_t bootSp, uint8_t idle1Sp, bool init)
             }
             else
             {
-                for (int8_t i = _numLeds - 1; i >= 0; i--)
-                {
-                    if (i >= _runningLedTracker)
-                    {
-                        _ledState[i] = false;
-                    }
-                    else
-                    {
-                        _ledState[i] = true;
-                    }
-                }
+                // Segments below the running led tracker are ON
+                _frame = _lowSegments(_runningLedTracker);
                 if (_runningLedTracker >= 0)
                 {
                     _runningLedTracker--;
@@ -102,36 +91,18 @@ bool BarGraphAnimation::boot(uint8_t bootSp, uint8_t idle1Sp, bool init)
     }
     else
     {
-        idleOne(idle1Sp);
+        idleOne(idle1Sp, now);
     }
     return _bootState;
 }
 
-void BarGraphAnimation::idleOne(uint8_t idle1Sp)
+void BarGraphAnimation::idleOne(uint8_t idle1Sp, unsigned long now)
 { // In Idle mode safety ON
     // normal sync animation on the bar graph while safety ON
-    if (millis() - _prevTime >= idle1Sp)
+    for (uint8_t n = _step.steps(now, idle1Sp); n > 0; n--)
     {
-        _prevTime = millis();
-        for (int8_t i = 0; i < _numLeds; i++)
-        {
-            // All segements equal and below running led tracker will be ON
-            if (_runningLedTracker <= 0)
-            {
-                _ledState[i] = false;
-            }
-            else
-            {
-                if (i <= _runningLedTracker - 1)
-                {
-                    _ledState[i] = true;
-                }
-                else
-                {
-                    _ledState[i] = false;
-                }
-            }
-        }
+        // All segements equal and below running led tracker will be ON
+        _frame = (_runningLedTracker <= 0) ? 0 : _lowSegments(_runningLedTracker);
         if (_reverseSeqTracker == false)
         {
             _runningLedTracker++;
@@ -155,25 +126,13 @@ void BarGraphAnimation::idleOne(uint8_t idle1Sp)
     }
 }
 
-void BarGraphAnimation::idleTwo(uint8_t idle2Sp)
+void BarGraphAnimation::idleTwo(uint8_t idle2Sp, unsigned long now)
 {
     // normal sync animation on the bar graph while safety OFF
-    if (millis() - _prevTime >= idle2Sp)
+    for (uint8_t n = _step.steps(now, idle2Sp); n > 0; n--)
     {
-        _prevTime = millis();
-        // constrain(_runningLedTracker, 1, 10);
-        for (int8_t i = 0; i < _numLeds; i++)
-        {
-            // Only segement equal to running led tracker will be ON
-            if (i == _runningLedTracker - 1)
-            {
-                _ledState[i] = true;
-            }
-            else
-            {
-                _ledState[i] = false;
-            }
-        }
+        // Only segement equal to running led tracker will be ON
+        _frame = (_runningLedTracker <= 0) ? 0 : _segment(_runningLedTracker - 1);
         if (_reverseSeqTracker == false)
         {
             _runningLedTracker++;
@@ -195,39 +154,19 @@ void BarGraphAnimation::idleTwo(uint8_t idle2Sp)
     }
 }
 
-void BarGraphAnimation::firing(uint8_t firingSp)
+void BarGraphAnimation::firing(uint8_t firingSp, unsigned long now)
 {
-    if (millis() - _prevTime >= firingSp)
+    for (uint8_t n = _step.steps(now, firingSp); n > 0; n--)
     {
-        _prevTime = millis();
-        for (int8_t i = 0; i < _numLeds; i++)
+        // Segment at fire tracker and its mirror from the top are ON
+        _frame = _segment(_fireSeqTracker) | _segment((_numLeds - 1) - _fireSeqTracker);
+        // For many segements bar graph (17 and more), 2 segments on each side
+        if (_numLeds > 16)
         {
-            // For low segments (16 and less) bar graph
-            if (_numLeds <= 16)
-            {
-                if ((i == _fireSeqTracker) || (i == (_numLeds - 1) - _fireSeqTracker))
-                {
-                    _ledState[i] = true;
-                }
-                else
-                {
-                    _ledState[i] = false;
-                }
-            }
-            // For many segements bar graph (17 and more)
-            else
+            _frame |= _segment(_fireSeqTracker + 1);
+            if (_fireSeqTracker > 0)
             {
-                if ((i == _fireSeqTracker) ||
-                    (i == _fireSeqTracker + 1) ||
-                    (i == (_numLeds - 1) - _fireSeqTracker) ||
-                    (i == (_numLeds - 1) - (_fireSeqTracker - 1)))
-                {
-                    _ledState[i] = true;
-                }
-                else
-                {
-                    _ledState[i] = false;
-                }
+                _frame |= _segment(_numLeds - _fireSeqTracker);
             }
         }
         if (_reverseSeqTracker == false)
@@ -253,7 +192,7 @@ void BarGraphAnimation::firing(uint8_t firingSp)
     }
 }
 
-bool BarGraphAnimation::shuttingDown(uint8_t shutdownSp, bool init)
+bool BarGraphAnimation::shuttingDown(uint8_t shutdownSp, bool init, unsigned long now)
 {
     static bool flag = false;
     if (init)
@@ -265,23 +204,12 @@ bool BarGraphAnimation::shuttingDown(uint8_t shutdownSp, bool init)
 
     if (_bootState)
     {
-        if (millis() - _prevTime >= shutdownSp)
+        for (uint8_t n = _step.steps(now, shutdownSp); n > 0 && _bootState; n--)
         {
-            //_prevTime += shutdownSp;
-            _prevTime = millis();
             if (!flag)
             {
-                for (int8_t i = 0; i < _numLeds; i++)
-                {
-                    if (i < _runningLedTracker)
-                    {
-                        _ledState[i] = true;
-                    }
-                    else
-                    {
-                        _ledState[i] = false;
-                    }
-                }
+                // Segments below the running led tracker are ON
+                _frame = _lowSegments(_runningLedTracker);
                 if (_runningLedTracker < _numLeds)
                 {
                     _runningLedTracker++;
@@ -294,17 +222,8 @@ bool BarGraphAnimation::shuttingDown(uint8_t shutdownSp, bool init)
             }
             else
             {
-                for (int8_t i = 0; i < _numLeds; i++)
-                {
-                    if (i < _runningLedTracker)
-                    {
-                        _ledState[i] = false;
-                    }
-                    else
-                    {
-                        _ledState[i] = true;
-                    }
-                }
+                // Segments from the running led tracker to the top are ON
+                _frame = _all & ~_lowSegments(_runningLedTracker);
                 if (_runningLedTracker < _numLeds)
                 {
                     _runningLedTracker++;
@@ -326,18 +245,32 @@ bool BarGraphAnimation::shuttingDown(uint8_t shutdownSp, bool init)
 
 void BarGraphAnimation::setHigh()
 {
-    for (uint8_t i = 0; i < _numLeds; i++)
+    _frame = _all; // All LEDs ON
+}
+
+void BarGraphAnimation::setLow()
+{
+    _frame = 0; // All LEDs OFF
+}
+
+// Mask of the segments 0 to count - 1
+BarGraphMask BarGraphAnimation::_lowSegments(uint8_t count)
+{
+    if (count >= BG_MASK_BITS)
     {
-        _ledState[i] = 1; // All LEDs ON
+        return ~(BarGraphMask)0;
     }
+    return ((BarGraphMask)1 << count) - 1;
 }
 
-void BarGraphAnimation::setLow()
+// Mask of one segment, none if out of the bar graph
+BarGraphMask BarGraphAnimation::_segment(uint8_t index)
 {
-    for (uint8_t i = 0; i < _numLeds; i++)
+    if (index >= _numLeds)
     {
-        _ledState[i] = 0; // All LEDs OFF
+        return 0;
     }
+    return (BarGraphMask)1 << index;
 }
 
 /*************************************************************************************************************/
@@ -351,13 +284,7 @@ HT16K33Driver::HT16K33Driver(uint8_t numLeds, bool direction, uint8_t dataPin, u
 
 void HT16K33Driver::begin(const uint8_t segMap[][2], uint8_t rows, uint8_t cols)
 {
-    for (int i = 0; i < rows; ++i)
-    {
-        for (int j = 0; j < cols; ++j)
-        {
-            _segMap[i][j] = segMap[i][j];
-        }
-    }
+    _segMap = segMap; // in flash memory (PROGMEM), not copied
     _driver.init(_address);
     _driver.setBrightness(15); // Set maxBri level (0 is min, 15 is max)
     _driver.clear();
@@ -367,8 +294,9 @@ void HT16K33Driver::begin(const uint8_t segMap[][2], uint8_t rows, uint8_t cols)
 void HT16K33Driver::update()
 {
     // To be configure for in relation with bar graph total leds number and connections matrix to the MAX72xx
-    // Leds mapping might be different for your setup, check rows and columns orders : _bargraph.setLed(0, ROW, COL, _ledState[i]))
-    for (uint8_t i = 0; i < _numLeds; i++)
+    // Leds mapping might be different for your setup, check rows and columns orders : _bargraph.setLed(0, ROW, COL, segment state))
+    BarGraphMask frame = getFrame();
+    for (uint8_t i = 0; i < _numLeds; i++, frame >>= 1)
     {
         uint8_t j = i;
         if (_direction) // If animation is REVERSED
@@ -376,7 +304,7 @@ void HT16K33Driver::update()
             j = (_numLeds - 1) - i;
         }
         // set segments according to mapping define in setting
-        _driver.setPixel(_segMap[j][0], _segMap[j][1], getLedState(i));
+        _driver.setPixel(pgm_read_byte(&_segMap[j][0]), pgm_read_byte(&_segMap[j][1]), frame & 1);
     }
     _driver.write();
 }
@@ -392,13 +320,7 @@ MAX72xxDriver::MAX72xxDriver(uint8_t numLeds, bool direction, uint8_t dataPin, u
 
 void MAX72xxDriver::begin(const uint8_t segMap[][2], uint8_t rows, uint8_t cols)
 {
-    for (int i = 0; i < rows; ++i)
-    {
-        for (int j = 0; j < cols; ++j)
-        {
-            _segMap[i][j] = segMap[i][j];
-        }
-    }
+    _segMap = segMap; // in flash memory (PROGMEM), not copied
     pinMode(_loadPin, OUTPUT);
     pinMode(_clockPin, OUTPUT);
     pinMode(_dataPin, OUTPUT);
@@ -411,8 +333,9 @@ void MAX72xxDriver::begin(const uint8_t segMap[][2], uint8_t rows, uint8_t cols)
 void MAX72xxDriver::update()
 {
     // To be configure for in relation with bar graph total leds number and connections matrix to the MAX72xx
-    // Leds mapping might be different for your setup, check rows and columns orders : _bargraph.setLed(0, ROW, COL, _ledState[i]))
-    for (uint8_t i = 0; i < _numLeds; i++)
+    // Leds mapping might be different for your setup, check rows and columns orders : _bargraph.setLed(0, ROW, COL, segment state))
+    BarGraphMask frame = getFrame();
+    for (uint8_t i = 0; i < _numLeds; i++, frame >>= 1)
     {
         uint8_t j = i;
         if (_direction) // If animation is REVERSED
@@ -420,6 +343,6 @@ void MAX72xxDriver::update()
             j = (_numLeds - 1) - i;
         }
         // set segments according to mapping define in setting
-        _driver.setLed(0, _segMap[j][0], _segMap[j][1], getLedState(i));
+        _driver.setLed(0, pgm_read_byte(&_segMap[j][0]), pgm_read_byte(&_segMap[j][1]), frame & 1);
     }
 }
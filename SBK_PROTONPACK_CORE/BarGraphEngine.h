@@ -23,6 +23,13 @@
 #include <LedControl.h>
 #include <SPI.h>
 #include "SBK_HT16K33.h"
+#include "TimestepEngine.h"
+
+/*  Animations frames are segments masks : bit 0 is the first segment. Animations steps are */
+/*  shifts and ORs on the mask, the drivers read it bit by bit. uint32_t masks are for bar graphs */
+/*  up to 32 segments, change BarGraphMask to uint64_t for bigger ones (40, 64 segments). */
+typedef uint32_t BarGraphMask;
+#define BG_MASK_BITS (sizeof(BarGraphMask) * 8)
 
 class BarGraphAnimation
 {
@@ -30,19 +37,23 @@ public:
     // Accessing lEDs states
     BarGraphAnimation(uint8_t numLeds);
     bool getLedState(uint8_t index);
-    bool boot(uint8_t bootSp, uint8_t idle1Sp, bool init);
-    void idleOne(uint8_t idle1Sp);
-    void idleTwo(uint8_t idle2Sp);
-    void firing(uint8_t firingSp);
-    bool shuttingDown(uint8_t shutdownSp, bool init);
+    BarGraphMask getFrame();
+    bool boot(uint8_t bootSp, uint8_t idle1Sp, bool init, unsigned long now);
+    void idleOne(uint8_t idle1Sp, unsigned long now);
+    void idleTwo(uint8_t idle2Sp, unsigned long now);
+    void firing(uint8_t firingSp, unsigned long now);
+    bool shuttingDown(uint8_t shutdownSp, bool init, unsigned long now);
     void clear();
     void setHigh();
     void setLow();
 
 private:
-    unsigned long _prevTime;
+    BarGraphMask _lowSegments(uint8_t count);
+    BarGraphMask _segment(uint8_t index);
+    Timestep _step;
     uint8_t _numLeds;
-    bool _ledState[28];
+    BarGraphMask _frame;
+    BarGraphMask _all; // all segments ON
     int8_t _runningLedTracker;
     bool _reverseSeqTracker;
     int8_t _fireSeqTracker;
@@ -66,7 +77,7 @@ private:
     uint8_t _dataPin;
     uint8_t _address;
     HT16K33 _driver;
-    uint8_t _segMap[28][2];
+    const uint8_t (*_segMap)[2]; // {ROW,COL} segments map in flash memory
 };
 
 
@@ -86,7 +97,7 @@ private:
     uint8_t _clockPin;
     uint8_t _dataPin;
     LedControl _driver;
-    uint8_t _segMap[28][2];
+    const uint8_t (*_segMap)[2]; // {ROW,COL} segments map in flash memory
 };
 
 #endif
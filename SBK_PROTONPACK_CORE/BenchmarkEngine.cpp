@@ -0,0 +1,132 @@
+/*
+ *  BenchmarkEngine.cpp is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+#include "BenchmarkEngine.h"
+
+Benchmark::Benchmark()
+{
+    _overhead = 0;
+    _startMicros = 0;
+    reset();
+}
+
+void Benchmark::begin()
+{
+#if defined(__AVR_ATmega4809__)
+    TCB2.CTRLA = 0;
+    TCB2.CTRLB = TCB_CNTMODE_INT_gc; // periodic, CAPT flag set when CNT wraps at CCMP
+    TCB2.CCMP = 0xFFFF;
+    TCB2.INTCTRL = 0;
+    TCB2.CTRLA = TCB_CLKSEL_CLKDIV1_gc | TCB_ENABLE_bm;
+#elif defined(__AVR_ATmega328P__)
+    TCCR1A = 0;
+    TCCR1B = _BV(CS10); // normal mode, no prescaler
+    TIMSK1 = 0;
+#endif
+    // Cost of an empty measure, removed from each measure
+    _overhead = 0;
+    start();
+    stop();
+    _overhead = _min;
+    reset();
+}
+
+void Benchmark::reset()
+{
+    _min = 0xFFFFFFFF;
+    _max = 0;
+    _sum = 0;
+    _calls = 0;
+}
+
+void Benchmark::start()
+{
+    noInterrupts();
+#if defined(__AVR_ATmega4809__)
+    TCB2.CNT = 0;
+    TCB2.INTFLAGS = TCB_CAPT_bm;
+#elif defined(__AVR_ATmega328P__)
+    TCNT1 = 0;
+    TIFR1 = _BV(TOV1);
+#else
+    _startMicros = micros();
+#endif
+}
+
+void Benchmark::stop()
+{
+    uint32_t cycles = _read();
+    interrupts();
+    cycles = (cycles > _overhead) ? cycles - _overhead : 0;
+    if (cycles < _min)
+    {
+        _min = cycles;
+    }
+    if (cycles > _max)
+    {
+        _max = cycles;
+    }
+    _sum += cycles;
+    _calls++;
+}
+
+uint32_t Benchmark::_read()
+{
+#if defined(__AVR_ATmega4809__)
+    uint32_t cycles = TCB2.CNT;
+    if (TCB2.INTFLAGS & TCB_CAPT_bm)
+    {
+        cycles += 0x10000;
+    }
+    return cycles;
+#elif defined(__AVR_ATmega328P__)
+    uint32_t cycles = TCNT1;
+    if (TIFR1 & _BV(TOV1))
+    {
+        cycles += 0x10000;
+    }
+    return cycles;
+#else
+    return (micros() - _startMicros) * clockCyclesPerMicrosecond();
+#endif
+}
+
+void Benchmark::printHeader(Print &out)
+{
+    out.println();
+#if defined(__AVR_ATmega4809__)
+    out.print(F("ATmega4809"));
+#elif defined(__AVR_ATmega328P__)
+    out.print(F("ATmega328P"));
+#else
+    out.print(F("MCU"));
+#endif
+    out.print(F(" @ ")), out.print(F_CPU / 1000000), out.println(F(" MHz, CPU cycles per call"));
+    out.println(F("| function | calls | min | max | avg |"));
+    out.println(F("|---|---|---|---|---|"));
+}
+
+void Benchmark::printRow(Print &out, const __FlashStringHelper *name)
+{
+    out.print(F("| ")), out.print(name);
+    out.print(F(" | ")), out.print(_calls);
+    out.print(F(" | ")), out.print(_calls ? _min : 0);
+    out.print(F(" | ")), out.print(_max);
+    out.print(F(" | ")), out.print(_calls ? _sum / _calls : 0);
+    out.println(F(" |"));
+}
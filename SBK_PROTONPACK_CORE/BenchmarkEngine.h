@@ -0,0 +1,51 @@
+/*
+ *  BenchmarkEngine.h is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+#ifndef BENCHMARKENGINE_H
+#define BENCHMARKENGINE_H
+
+#include <Arduino.h>
+
+/*  CPU cycles counter for the engines hot functions (BENCHMARK_MODE in ACONFIG.h). */
+/*  A spare 16 bits timer counts CPU cycles with no prescaler : Timer1 on ATmega328P, TCB2 on ATmega4809. */
+/*  Interrupts are off between start() and stop(), so the count is exact and only includes the measured */
+/*  code, up to 131071 cycles (one timer overflow). On other MCU, micros() is used. */
+/*  Each row of the results table gives the calls count and the min, max and average cycles per call : */
+/*  max is the cost of the call doing the real work, min is the cost of the call with nothing to do. */
+class Benchmark
+{
+public:
+    Benchmark();
+    void begin();
+    void reset();
+    void start();
+    void stop();
+    void printHeader(Print &out);
+    void printRow(Print &out, const __FlashStringHelper *name);
+
+private:
+    uint32_t _read();
+    uint32_t _min;
+    uint32_t _max;
+    uint32_t _sum;
+    uint16_t _calls;
+    uint16_t _overhead;
+    unsigned long _startMicros;
+};
+
+#endif
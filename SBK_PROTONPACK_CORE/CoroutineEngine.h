@@ -0,0 +1,77 @@
+/*
+ *  CoroutineEngine.h is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+
+#ifndef COROUTINEENGINE_H
+#define COROUTINEENGINE_H
+
+#include <Arduino.h>
+
+/*  Stackless coroutines (protothreads) for multi-steps animations : a sequence is written as a linear */
+/*  script (ramp, wait, ramp, fade...) in a function returning bool, called again at each frame. */
+/*  The function resumes where it stopped : CO_AWAIT() returns false until its step is done, CO_END() */
+/*  returns true once the whole sequence is done, then at each call until CO_RESET(). */
+/*  Resume points are source lines in a switch : one CO_ macro per line, no switch statement around */
+/*  a CO_ macro, and local variables are lost between calls (keep them in members). */
+#define CO_DONE 0xFFFF // sequence done
+
+struct Coroutine
+{
+    uint16_t line;       // resume point, 0 = start, CO_DONE = done
+    bool first;          // first call of the current step, to init ramps
+    unsigned long start; // current step start time, for CO_WAIT()
+};
+
+#define CO_RESET(co) ((co).line = 0)
+#define CO_FIRST(co) ((co).first)
+#define CO_BEGIN(co)   \
+    switch ((co).line) \
+    {                  \
+    case 0:
+// Call step again at each frame until it returns true, CO_FIRST() is true on its first call
+#define CO_AWAIT(co, step)          \
+    do                              \
+    {                               \
+        (co).line = __LINE__;       \
+        (co).first = true;          \
+    case __LINE__:                  \
+        bool done = (step);         \
+        (co).first = false;         \
+        if (!done)                  \
+        {                           \
+            return false;           \
+        }                           \
+    } while (0)
+// Wait for ms from now
+#define CO_WAIT(co, ms, now)                            \
+    do                                                  \
+    {                                                   \
+        (co).line = __LINE__;                           \
+        (co).start = (now);                             \
+    case __LINE__:                                      \
+        if ((unsigned long)((now) - (co).start) < (ms)) \
+        {                                               \
+            return false;                               \
+        }                                               \
+    } while (0)
+#define CO_END(co)         \
+    }                      \
+    (co).line = CO_DONE;   \
+    return true;
+
+#endif
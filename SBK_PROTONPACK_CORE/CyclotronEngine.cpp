@@ -50,24 +50,29 @@
 
 // Cyclotron GB1/GB2 style object and functions
 
-Cyclotron_GB1_GB2::Cyclotron_GB1_GB2(Adafruit_NeoPixel &strip, bool direction,
-                                     uint8_t start1, uint8_t end1,
-                                     uint8_t start2, uint8_t end2,
-                                     uint8_t start3, uint8_t end3,
-                                     uint8_t start4, uint8_t end4)
-    : _strip(strip), _direction(direction),
-      _start1(start1), _end1(end1),
-      _start2(start2), _end2(end2),
-      _start3(start3), _end3(end3),
-      _start4(start4), _end4(end4)
-{
-    _numLeds = (_end4 - _start1 + 1);
-    _ledState = new uint8_t *[_numLeds];
-    for (uint8_t i = 0; i < _numLeds; ++i)
+Cyclotron_GB1_GB2::Cyclotron_GB1_GB2(Adafruit_NeoPixel &strip, bool direction, const uint8_t cells[][2], uint8_t numCells)
+    : _strip(strip), _direction(direction), _cells(cells), _numCells(numCells) // cells in flash memory (PROGMEM), not copied
+{
+    // Cyclotron pixels span from the lowest to the highest position pixel
+    _start = 255;
+    _end = 0;
+    for (uint8_t c = 0; c < _numCells; c++)
     {
-        _ledState[i] = new uint8_t[3];
+        uint8_t first = pgm_read_byte(&_cells[c][0]);
+        uint8_t last = pgm_read_byte(&_cells[c][1]);
+        if (first < _start)
+        {
+            _start = first;
+        }
+        if (last > _end)
+        {
+            _end = last;
+        }
     }
-    _prevTime = 0;
+    _numLeds = (_end - _start + 1);
+    _ledLevel = nullptr; // buffer given to begin()
+    _cellTracker = nullptr;
+    _cellState = nullptr;
     // initial sequence variables
     _cycUpdateSp = GB12_PWD_UPDATE_SP;
     _cycFadeSp = GB12_PWD_FADE_SP;
@@ -75,14 +80,6 @@ Cyclotron_GB1_GB2::Cyclotron_GB1_GB2(Adafruit_NeoPixel &strip, bool direction,
     _cycFlashDuration = GB12_PWD_FLASH_DURATION;
     _cycPosOffset = GB12_PWD_OFFSET;
     // Idle One sequence variables
-    _cell1Tracker = 0;
-    _cell2Tracker = 0;
-    _cell3Tracker = 0;
-    _cell4Tracker = 0;
-    _cell1State = true;
-    _cell2State = false;
-    _cell3State = false;
-    _cell4State = false;
     _prevUpdateSpTime = 0;
     _prevFadeTime = 0;
     _prevBrightnessTime = 0;
@@ -90,72 +87,77 @@ Cyclotron_GB1_GB2::Cyclotron_GB1_GB2(Adafruit_NeoPixel &strip, bool direction,
     _prevOffsetTime = 0;
 }
 
-Cyclotron_GB1_GB2::~Cyclotron_GB1_GB2()
+// Cells trackers, cells states and 1 byte per pixel, expanded to RGB by update()
+uint16_t Cyclotron_GB1_GB2::bufferSize()
 {
-    for (int i = 0; i < _numLeds; ++i)
+    return _numCells * (sizeof(uint16_t) + sizeof(bool)) + _numLeds;
+}
+
+void Cyclotron_GB1_GB2::begin(uint8_t *buffer)
+{
+    if (buffer == nullptr)
     {
-        delete[] _ledState[i]; // Free memory for each row
+        // Own buffer, allocated once
+        buffer = (_cellTracker != nullptr) ? (uint8_t *)_cellTracker : new uint8_t[bufferSize()];
     }
-    delete[] _ledState;
+    _cellTracker = (uint16_t *)buffer; // first, keeps the buffer alignment
+    _cellState = (bool *)(buffer + _numCells * sizeof(uint16_t));
+    _ledLevel = buffer + _numCells * (sizeof(uint16_t) + sizeof(bool));
+    clear();
 }
 
-void Cyclotron_GB1_GB2::begin() { clear(); }
-
 void Cyclotron_GB1_GB2::clear()
 {
-    _setColorAll(0, 0, 0);
+    _setLevelAll(0);
     _cycUpdateSp = GB12_PWD_UPDATE_SP;
     _cycFadeSp = GB12_PWD_FADE_SP;
     _cycBrightness = GB12_PWD_MAX_BRIGHTNESS;
     _cycFlashDuration = GB12_PWD_FLASH_DURATION;
     _cycPosOffset = GB12_PWD_OFFSET;
-    _cell1Tracker = 0;
-    _cell2Tracker = 0;
-    _cell3Tracker = 0;
-    _cell4Tracker = 0;
-    _cell1State = true;
-    _cell2State = false;
-    _cell3State = false;
-    _cell4State = false;
+    for (uint8_t c = 0; c < _numCells; c++)
+    {
+        _cellTracker[c] = 0;
+        _cellState[c] = (c == 0);
+    }
 }
 
 void Cyclotron_GB1_GB2::update()
 {
-    for (int8_t i = 0; i < _numLeds; i++)
+    for (uint8_t i = 0; i < _numLeds; i++)
     {
         // Offset index to fit ws2812 LEDs strip index
         uint8_t j;
         if (!_direction) // FORWARD durection
         {
-            j = i + _start1;
+            j = i + _start;
         }
         else
         {
-            j = _end4 - i;
+            j = _end - i;
         }
-        // set segments according to mapping define in setting
-        _strip.setPixelColor((j), _ledState[i][0], _ledState[i][1], _ledState[i][2]);
+        // set segments according to mapping define in setting, GB1/GB2 cells are red only
+        _strip.setPixelColor((j), _ledLevel[i], 0, 0);
     }
 }
 
-void Cyclotron_GB1_GB2::rampToPoweredDown(uint16_t ramp_time, bool init)
+void Cyclotron_GB1_GB2::rampToPoweredDown(uint16_t ramp_time, bool init, unsigned long now)
 {
-    _rampCyc(ramp_time, init, GB12_PWD_UPDATE_SP, GB12_PWD_FADE_SP, GB12_PWD_MAX_BRIGHTNESS, GB12_PWD_FLASH_DURATION, GB12_PWD_OFFSET);
+    _rampCyc(ramp_time, init, GB12_PWD_UPDATE_SP, GB12_PWD_FADE_SP, GB12_PWD_MAX_BRIGHTNESS, GB12_PWD_FLASH_DURATION, GB12_PWD_OFFSET, now);
 }
 
-void Cyclotron_GB1_GB2::rampToIdleOne(uint16_t ramp_time, bool init) // Return true when animation is done
+void Cyclotron_GB1_GB2::rampToIdleOne(uint16_t ramp_time, bool init, unsigned long now) // Return true when animation is done
 {
-    _rampCyc(ramp_time, init, GB12_IDLE1_UPDATE_SP, GB12_IDLE1_FADE_SP, GB12_IDLE1_MAX_BRIGHTNESS, GB12_IDLE1_FLASH_DURATION, GB12_IDLE1_OFFSET);
+    _rampCyc(ramp_time, init, GB12_IDLE1_UPDATE_SP, GB12_IDLE1_FADE_SP, GB12_IDLE1_MAX_BRIGHTNESS, GB12_IDLE1_FLASH_DURATION, GB12_IDLE1_OFFSET, now);
 }
 
-void Cyclotron_GB1_GB2::rampToIdleTwo(uint16_t ramp_time, bool init) // Return true when animation is done
+void Cyclotron_GB1_GB2::rampToIdleTwo(uint16_t ramp_time, bool init, unsigned long now) // Return true when animation is done
 {
-    _rampCyc(ramp_time, init, GB12_IDLE2_UPDATE_SP, GB12_IDLE2_FADE_SP, GB12_IDLE2_MAX_BRIGHTNESS, GB12_IDLE2_FLASH_DURATION, GB12_IDLE2_OFFSET);
+    _rampCyc(ramp_time, init, GB12_IDLE2_UPDATE_SP, GB12_IDLE2_FADE_SP, GB12_IDLE2_MAX_BRIGHTNESS, GB12_IDLE2_FLASH_DURATION, GB12_IDLE2_OFFSET, now);
 }
 
-void Cyclotron_GB1_GB2::rampToFiring(uint16_t ramp_time, bool init) // Return true when animation is done
+void Cyclotron_GB1_GB2::rampToFiring(uint16_t ramp_time, bool init, unsigned long now) // Return true when animation is done
 {
-    _rampCyc(ramp_time, init, GB12_FIRE_UPDATE_SP, GB12_FIRE_FADE_SP, GB12_FIRE_MAX_BRIGHTNESS, GB12_FIRE_FLASH_DURATION, GB12_FIRE_OFFSET);
+    _rampCyc(ramp_time, init, GB12_FIRE_UPDATE_SP, GB12_FIRE_FADE_SP, GB12_FIRE_MAX_BRIGHTNESS, GB12_FIRE_FLASH_DURATION, GB12_FIRE_OFFSET, now);
 }
 
 void Cyclotron_GB1_GB2::setDirection(bool direction)
@@ -163,7 +165,18 @@ void Cyclotron_GB1_GB2::setDirection(bool direction)
     _direction = direction;
 }
 
-void Cyclotron_GB1_GB2::_idleCyc(int16_t updateSp, int16_t fadeSp, int16_t maxBri, int16_t flashDur, int16_t offset)
+// Cyclotron pixels span in the WS2812 chain
+uint8_t Cyclotron_GB1_GB2::getFirstLed()
+{
+    return _start;
+}
+
+uint8_t Cyclotron_GB1_GB2::getLastLed()
+{
+    return _end;
+}
+
+void Cyclotron_GB1_GB2::_idleCyc(int16_t updateSp, int16_t fadeSp, int16_t maxBri, int16_t flashDur, int16_t offset, unsigned long now)
 {
     _cycUpdateSp = updateSp;
     _cycFadeSp = fadeSp;
@@ -171,18 +184,11 @@ void Cyclotron_GB1_GB2::_idleCyc(int16_t updateSp, int16_t fadeSp, int16_t maxBr
     _cycFlashDuration = flashDur;
     _cycPosOffset = offset;
 
-    // Update cyclotron
-    if (millis() - _prevTime >= _cycUpdateSp)
-    {
-        //_prevTime += _cycUpdateSp; //This cause problem at powerup MCU ????
-        _prevTime = millis();
-
-        // Update cyclotron _rotation
-        _rotation();
-    }
+    // Update cyclotron _rotation, timed by _rotation() itself
+    _rotation(now);
 }
 
-void Cyclotron_GB1_GB2::_rampCyc(int16_t rampTime, bool init, int16_t tg_updateSp, int16_t tg_fadeSp, int16_t tg_maxBri, int16_t tg_flashDur, int16_t tg_offset)
+void Cyclotron_GB1_GB2::_rampCyc(int16_t rampTime, bool init, int16_t tg_updateSp, int16_t tg_fadeSp, int16_t tg_maxBri, int16_t tg_flashDur, int16_t tg_offset, unsigned long now)
 {
     // trackers
     static int16_t iniUpSp;
@@ -226,26 +232,26 @@ void Cyclotron_GB1_GB2::_rampCyc(int16_t rampTime, bool init, int16_t tg_updateS
     }
 
     // Update cyclotron with current speeds and brightness
-    _rotation();
+    _rotation(now);
 
     // Ramp cyclotron UPDATE SPEED
-    if (millis() - _prevUpdateSpTime >= int_updateSp)
+    if (now - _prevUpdateSpTime >= int_updateSp)
     {
-        _prevUpdateSpTime = millis();
+        _prevUpdateSpTime = now;
         _cycUpdateSp = _ramp_parameter(_cycUpdateSp, iniUpSp, tg_updateSp, incr_updateSp);
     }
 
     // Ramp cyclotron FADE SPEED
-    if (millis() - _prevFadeTime >= int_fadeSp)
+    if (now - _prevFadeTime >= int_fadeSp)
     {
-        _prevFadeTime = millis();
+        _prevFadeTime = now;
         _cycFadeSp = _ramp_parameter(_cycFadeSp, iniFadeSp, tg_fadeSp, incr_fadeSp);
     }
 
     // Ramp cyclotron BRIGHTNESS
-    if (millis() - _prevBrightnessTime >= int_bri)
+    if (now - _prevBrightnessTime >= int_bri)
     {
-        _prevBrightnessTime = millis();
+        _prevBrightnessTime = now;
         _cycBrightness = _ramp_parameter(_cycBrightness, iniBri, tg_maxBri, incr_bri);
         // Helper to clear cyclotron at shutdown : if ramping down and brightness nearly 0, put it to 0...
         if (iniBri > tg_maxBri && _cycBrightness <= 10)
@@ -255,16 +261,16 @@ void Cyclotron_GB1_GB2::_rampCyc(int16_t rampTime, bool init, int16_t tg_updateS
     }
 
     // Ramp cyclotron FLASH DURATION
-    if (millis() - _prevFlasDurTime >= int_dur)
+    if (now - _prevFlasDurTime >= int_dur)
     {
-        _prevFlasDurTime = millis();
+        _prevFlasDurTime = now;
         _cycFlashDuration = _ramp_parameter(_cycFlashDuration, iniDur, tg_flashDur, incr_dur);
     }
 
     // Ramp cyclotron position OFFSET
-    if (millis() - _prevOffsetTime >= int_off)
+    if (now - _prevOffsetTime >= int_off)
     {
-        _prevOffsetTime = millis();
+        _prevOffsetTime = now;
         _cycPosOffset = _ramp_parameter(_cycPosOffset, iniOff, tg_offset, incr_off);
     }
 }
@@ -302,18 +308,17 @@ uint16_t Cyclotron_GB1_GB2::_ramp_parameter(int16_t param, int16_t ini, int16_t
     return param;
 }
 
-void Cyclotron_GB1_GB2::_rotation()
+void Cyclotron_GB1_GB2::_rotation(unsigned long now)
 {
-    if (millis() - _prevTime >= _cycUpdateSp)
+    for (uint8_t n = _step.steps(now, _cycUpdateSp); n > 0; n--)
     {
-        _prevTime = millis();
         // Update cyclotron one position cycle duration
         _cycPosDuration = ((2 * _cycBrightness) + _cycFlashDuration);
 
-        _cell1();
-        _cell2();
-        _cell3();
-        _cell4();
+        for (uint8_t c = 0; c < _numCells; c++)
+        {
+            _cell(c);
+        }
 
         /*
  Serial.print(tg_updateSp), Serial.print(" / "), Serial.println(_cycUpdateSp);
@@ -327,171 +332,73 @@ void Cyclotron_GB1_GB2::_rotation()
     }
 }
 
-void Cyclotron_GB1_GB2::_cell1()
+void Cyclotron_GB1_GB2::_cell(uint8_t cell)
 {
+    uint8_t next = (cell + 1 < _numCells) ? cell + 1 : 0;
 
-    if (_cell1State)
+    if (_cellState[cell])
     {
-        _cellIntensity(_cell1State, _cell1Tracker, _start1, _end1);
-        if (_cell1Tracker < _cycPosDuration)
+        if (_cellTracker[cell] < _cycPosDuration)
         {
-            _cell1Tracker += _cycFadeSp;
+            _cellFill(cell, _cellIntensity(_cellTracker[cell]));
+            _cellTracker[cell] += _cycFadeSp;
         }
         else
         {
-            _cellClear(_start1, _end1);
-            _cell1Tracker = 0;
-            _cell1State = false;
-            // Serial.println("Cell 1 : OFF");
+            _cellFill(cell, 0);
+            _cellTracker[cell] = 0;
+            _cellState[cell] = false;
         }
     }
 
-    // Start the next cell with offset
-    if (!_cell2State && _cell1Tracker > _cycPosDuration - _cycPosOffset)
-    {
-        _cell2State = true;
-        // Serial.println("Cell 2 : ON");
-    }
-}
-
-void Cyclotron_GB1_GB2::_cell2()
-{
-
-    if (_cell2State)
-    {
-        _cellIntensity(_cell2State, _cell2Tracker, _start2, _end2);
-        if (_cell2Tracker < _cycPosDuration)
-        {
-            _cell2Tracker += _cycFadeSp;
-        }
-        else
-        {
-            _cellClear(_start2, _end2);
-            _cell2Tracker = 0;
-            _cell2State = false;
-            // Serial.println("Cell 2 : OFF");
-        }
-    }
-
-    if (!_cell3State && _cell2Tracker > _cycPosDuration - _cycPosOffset)
-    {
-        _cell3State = true;
-        // Serial.println("Cell 3 : ON");
-    }
-}
-
-void Cyclotron_GB1_GB2::_cell3()
-{
-    _cellIntensity(_cell3State, _cell3Tracker, _start3, _end3);
-    if (_cell3State)
+    // Start the next cell with offset, the last cell starts the first one
+    if (!_cellState[next] && _cellTracker[cell] > _cycPosDuration - _cycPosOffset)
     {
-        _cellIntensity(_cell3State, _cell3Tracker, _start3, _end3);
-        if (_cell3Tracker < _cycPosDuration)
-        {
-            _cell3Tracker += _cycFadeSp;
-        }
-        else
-        {
-            _cellClear(_start3, _end3);
-            _cell3Tracker = 0;
-            _cell3State = false;
-            // Serial.println("Cell 3 : OFF");
-        }
-    }
-    if (!_cell4State && _cell3Tracker > _cycPosDuration - _cycPosOffset)
-    {
-        _cell4State = true;
-        // Serial.println("Cell 4 : ON");
+        _cellState[next] = true;
     }
 }
 
-void Cyclotron_GB1_GB2::_cell4()
+uint8_t Cyclotron_GB1_GB2::_cellIntensity(int16_t tracker)
 {
-
-    if (_cell4State)
+    // ramp up intensity
+    if (tracker < _cycBrightness + 1)
     {
-        _cellIntensity(_cell4State, _cell4Tracker, _start4, _end4);
-        if (_cell4Tracker < _cycPosDuration)
-        {
-            _cell4Tracker += _cycFadeSp;
-        }
-        else
-        {
-            _cellClear(_start4, _end4);
-            _cell4Tracker = 0;
-            _cell4State = false;
-            // Serial.println("Cell 4 : OFF");
-        }
+        return tracker;
     }
-    if (!_cell1State && _cell4Tracker > _cycPosDuration - _cycPosOffset)
+    // Flash at same brightness
+    else if ((tracker < (_cycPosDuration - _cycBrightness)) || (_cycBrightness > tracker))
     {
-        _cell1State = true;
-        // Serial.println("Cell 1 : ON");
+        return _cycBrightness;
     }
-}
-
-uint8_t Cyclotron_GB1_GB2::_cellIntensity(bool state, int16_t tracker, uint8_t start, uint8_t end)
-{
-    uint8_t intensity;
-    for (int8_t i = start; i < end + 1; i++)
+    // ramp down
+    else
     {
-        // Offset index to ledState[28][3]array
-        uint8_t j = i - _start1;
-
-        if (state)
-        {
-            // ramp up intensity
-            if (tracker < _cycBrightness + 1)
-            {
-                intensity = tracker;
-            }
-            // Flash at same brightness
-            else if ((tracker < (_cycPosDuration - _cycBrightness)) || (_cycBrightness > tracker))
-            {
-                intensity = _cycBrightness;
-            }
-            // ramp down
-            else
-            {
-                intensity = max(0, _cycPosDuration - tracker);
-            }
-        }
-        else
-        {
-            intensity = 0;
-        }
-
-        _setColor(j, intensity, 0, 0);
+        return max(0, _cycPosDuration - tracker);
     }
-    return intensity;
 }
 
-void Cyclotron_GB1_GB2::_cellClear(uint8_t start, uint8_t end)
+// Same level on all the cell pixels
+void Cyclotron_GB1_GB2::_cellFill(uint8_t cell, uint8_t level)
 {
-    for (int8_t i = start; i < end + 1; i++)
+    uint8_t end = pgm_read_byte(&_cells[cell][1]);
+    for (uint16_t i = pgm_read_byte(&_cells[cell][0]); i <= end; i++)
     {
-        // Offset index to ledState[28][3]array
-        uint8_t j = i - _start1;
-
-        _setColor(j, 0, 0, 0);
+        // Offset index to _ledLevel[] array
+        _setLevel(i - _start, level);
     }
 }
 
-void Cyclotron_GB1_GB2::_setColorAll(uint8_t red, uint8_t green, uint8_t blue)
+void Cyclotron_GB1_GB2::_setLevelAll(uint8_t level)
 {
     for (uint16_t i = 0; i < _numLeds; i++)
     {
-        _ledState[i][0] = red;
-        _ledState[i][1] = green;
-        _ledState[i][2] = blue;
+        _ledLevel[i] = level;
     }
 }
 
-void Cyclotron_GB1_GB2::_setColor(uint16_t pixel, uint8_t red, uint8_t green, uint8_t blue)
+void Cyclotron_GB1_GB2::_setLevel(uint16_t pixel, uint8_t level)
 {
-    _ledState[pixel][0] = red;
-    _ledState[pixel][1] = green;
-    _ledState[pixel][2] = blue;
+    _ledLevel[pixel] = level;
 }
 
 ///////////////////////////////////////////////////////////
@@ -521,6 +428,8 @@ void Cyclotron_GB1_GB2::_setColor(uint16_t pixel, uint8_t red, uint8_t green, ui
 #define AFFE_FIRE_HEAD 4
 #define AFFE_FIRE_FLASH 6
 #define AFFE_FIRE_TRAIL 25
+// Pixel level for flash pixels, trail and head levels are at most 255 / 3
+#define AFFE_FLASH_LEVEL 255
 
 // Cyclotron GB1/GB2 style object and functions
 
@@ -528,12 +437,7 @@ Cyclotron_AF_FE::Cyclotron_AF_FE(Adafruit_NeoPixel &strip, bool direction, uint8
     : _strip(strip), _direction(direction), _start(start), _end(end)
 {
     _numLeds = (_end - _start + 1);
-    _ledState = new uint8_t *[_numLeds];
-    for (uint8_t i = 0; i < _numLeds; ++i)
-    {
-        _ledState[i] = new uint8_t[3];
-    }
-    _prevTime = 0;
+    _ledLevel = nullptr; // buffer given to begin()
     _cycPosTracker = 0;
     // initial sequence variables
     _cycUpdateSp = AFFE_PWD_UPDATE_SP;
@@ -541,6 +445,7 @@ Cyclotron_AF_FE::Cyclotron_AF_FE(Adafruit_NeoPixel &strip, bool direction, uint8
     _cycTrail = AFFE_PWD_TRAIL;
     _cycFlash = AFFE_PWD_FLASH;
     _cycHead = AFFE_FIRE_HEAD;
+    _flashBlue = 0;
     // Idle One sequence variables
     _prevUpdateSpTime = 0;
     _prevFadeTime = 0;
@@ -548,20 +453,26 @@ Cyclotron_AF_FE::Cyclotron_AF_FE(Adafruit_NeoPixel &strip, bool direction, uint8
     _prevOffsetTime = 0;
 }
 
-Cyclotron_AF_FE::~Cyclotron_AF_FE()
+// 1 byte per pixel, expanded to RGB by update()
+uint16_t Cyclotron_AF_FE::bufferSize()
 {
-    for (int i = 0; i < _numLeds; ++i)
+    return _numLeds;
+}
+
+void Cyclotron_AF_FE::begin(uint8_t *buffer)
+{
+    if (buffer == nullptr)
     {
-        delete[] _ledState[i]; // Free memory for each row
+        // Own buffer, allocated once
+        buffer = (_ledLevel != nullptr) ? _ledLevel : new uint8_t[bufferSize()];
     }
-    delete[] _ledState;
+    _ledLevel = buffer;
+    clear();
 }
 
-void Cyclotron_AF_FE::begin() { clear(); }
-
 void Cyclotron_AF_FE::clear()
 {
-    _setColorAll(0, 0, 0);
+    _setLevelAll(0);
     _cycUpdateSp = AFFE_PWD_UPDATE_SP;
     _cycBrightness = AFFE_PWD_MAX_BRIGHTNESS;
     _cycTrail = AFFE_PWD_TRAIL;
@@ -574,36 +485,47 @@ void Cyclotron_AF_FE::update()
     for (int8_t i = 0; i < _numLeds; i++)
     {
 
+        // Expand pixel level to the red/orange gradient, flash pixels share the same color
+        uint8_t level = _ledLevel[i];
+        uint8_t red = level;
+        uint8_t green = level / 25;
+        uint8_t blue = 0;
+        if (level == AFFE_FLASH_LEVEL)
+        {
+            red = _cycBrightness;
+            green = _cycBrightness / 5;
+            blue = _flashBlue;
+        }
         // set segments according to mapping define in setting
         if (!_direction)
         {
-            _strip.setPixelColor((i + _start), _ledState[i][0], _ledState[i][1], _ledState[i][2]);
+            _strip.setPixelColor((i + _start), red, green, blue);
         }
         else
         {
-            _strip.setPixelColor((_end - i), _ledState[i][0], _ledState[i][1], _ledState[i][2]);
+            _strip.setPixelColor((_end - i), red, green, blue);
         }
     }
 }
 
-void Cyclotron_AF_FE::rampToPoweredDown(uint16_t ramp_time, bool init)
+void Cyclotron_AF_FE::rampToPoweredDown(uint16_t ramp_time, bool init, unsigned long now)
 {
-    _ramp(ramp_time, init, AFFE_PWD_UPDATE_SP, 2);
+    _ramp(ramp_time, init, AFFE_PWD_UPDATE_SP, 2, now);
 }
 
-void Cyclotron_AF_FE::rampToIdleOne(uint16_t ramp_time, bool init) // Return true when animation is done
+void Cyclotron_AF_FE::rampToIdleOne(uint16_t ramp_time, bool init, unsigned long now) // Return true when animation is done
 {
-    _ramp(ramp_time, init, AFFE_IDLE1_UPDATE_SP, 2);
+    _ramp(ramp_time, init, AFFE_IDLE1_UPDATE_SP, 2, now);
 }
 
-void Cyclotron_AF_FE::rampToIdleTwo(uint16_t ramp_time, bool init) // Return true when animation is done
+void Cyclotron_AF_FE::rampToIdleTwo(uint16_t ramp_time, bool init, unsigned long now) // Return true when animation is done
 {
-    _ramp(ramp_time, init, AFFE_IDLE2_UPDATE_SP, 3);
+    _ramp(ramp_time, init, AFFE_IDLE2_UPDATE_SP, 3, now);
 }
 
-void Cyclotron_AF_FE::rampToFiring(uint16_t ramp_time, bool init) // Return true when animation is done
+void Cyclotron_AF_FE::rampToFiring(uint16_t ramp_time, bool init, unsigned long now) // Return true when animation is done
 {
-    _ramp(ramp_time, init, AFFE_FIRE_UPDATE_SP, 3);
+    _ramp(ramp_time, init, AFFE_FIRE_UPDATE_SP, 3, now);
 }
 
 void Cyclotron_AF_FE::setDirection(bool direction)
@@ -611,11 +533,22 @@ void Cyclotron_AF_FE::setDirection(bool direction)
     _direction = direction;
 }
 
-void Cyclotron_AF_FE::_idle(uint16_t updateSp, uint8_t tracker_increment) // Return true when animation is done
+// Cyclotron pixels span in the WS2812 chain
+uint8_t Cyclotron_AF_FE::getFirstLed()
+{
+    return _start;
+}
+
+uint8_t Cyclotron_AF_FE::getLastLed()
+{
+    return _end;
+}
+
+void Cyclotron_AF_FE::_idle(uint16_t updateSp, uint8_t tracker_increment, unsigned long now) // Return true when animation is done
 {
     _cycUpdateSp = updateSp;
     // Update cyclotron
-    if (millis() - _prevTime >= _cycUpdateSp)
+    for (uint8_t n = _step.steps(now, _cycUpdateSp); n > 0; n--)
     {
         /*
          Serial.print("_cycUpdateSp "), Serial.print(_cycUpdateSp);
@@ -626,9 +559,6 @@ void Cyclotron_AF_FE::_idle(uint16_t updateSp, uint8_t tracker_increment) // Ret
          Serial.print("  _cycPosOffset "), Serial.println(_cycPosOffset);
         */
 
-        //_prevTime += _cycUpdateSp; //This cause problem at powerup MCU ????
-        _prevTime = millis();
-
         _rotation();
         _cycPosTracker += tracker_increment;
         if (_cycPosTracker > _numLeds - 1)
@@ -638,7 +568,7 @@ void Cyclotron_AF_FE::_idle(uint16_t updateSp, uint8_t tracker_increment) // Ret
     }
 }
 
-void Cyclotron_AF_FE::_ramp(uint16_t rampTime, bool init, int16_t tg_updateSp, uint8_t track_inc)
+void Cyclotron_AF_FE::_ramp(uint16_t rampTime, bool init, int16_t tg_updateSp, uint8_t track_inc, unsigned long now)
 {
 
     static int16_t iniUpSp;
@@ -660,12 +590,12 @@ void Cyclotron_AF_FE::_ramp(uint16_t rampTime, bool init, int16_t tg_updateSp, u
         // Serial.println("cyclotron ramp initialisation !");
     }
 
-    _idle(_cycUpdateSp, track_inc);
+    _idle(_cycUpdateSp, track_inc, now);
 
     // Ramp cyclotron UPDATE SPEED
-    if (millis() - _prevUpdateSpTime >= int_updateSp)
+    if (now - _prevUpdateSpTime >= int_updateSp)
     {
-        _prevUpdateSpTime = millis();
+        _prevUpdateSpTime = now;
         _cycUpdateSp = _ramp_parameter(_cycUpdateSp, iniUpSp, tg_updateSp, incr_updateSp);
     }
 }
@@ -735,51 +665,47 @@ void Cyclotron_AF_FE::_rotation()
         if (i < _cycPosTracker)
         {
             uint8_t redTail = min(255, (_cycBrightness / 3) * ((_cycTrail + 1) - (_cycPosTracker - i)) / (_cycTrail + 1));
-            _setColor(j, redTail, redTail / 25, 0);
+            _setLevel(j, redTail);
         }
         // Flash pixels
         else if (i < _cycPosTracker + _cycFlash)
         {
-            uint8_t flashBlue = 0;
+            _flashBlue = 0;
             if (_cycUpdateSp < 10)
             {
-                flashBlue = 1;
+                _flashBlue = 1;
             }
             else if (_cycUpdateSp < 20)
             {
-                flashBlue = 1;
+                _flashBlue = 1;
             }
-            _setColor(j, _cycBrightness, _cycBrightness / 5, flashBlue);
+            _setLevel(j, AFFE_FLASH_LEVEL);
         }
         // Head pixels
         else if (i < _cycPosTracker + _cycFlash + _cycHead)
         {
             uint8_t redHead = min(255, (_cycBrightness / 5) * ((_cycHead + 1) - (i - (_cycPosTracker + _cycFlash))) / (_cycHead + 1));
-            _setColor(j, redHead, redHead / 25, 0);
+            _setLevel(j, redHead);
         }
         // All others pixel are OFF
         else
         {
-            _setColor(j, 0, 0, 0);
+            _setLevel(j, 0);
         }
     }
 
     // Serial.println("After for loop");
 }
 
-void Cyclotron_AF_FE::_setColorAll(uint8_t red, uint8_t green, uint8_t blue)
+void Cyclotron_AF_FE::_setLevelAll(uint8_t level)
 {
     for (uint16_t i = 0; i < _numLeds; i++)
     {
-        _ledState[i][0] = red;
-        _ledState[i][1] = green;
-        _ledState[i][2] = blue;
+        _ledLevel[i] = level;
     }
 }
 
-void Cyclotron_AF_FE::_setColor(uint16_t pixel, uint8_t red, uint8_t green, uint8_t blue)
+void Cyclotron_AF_FE::_setLevel(uint16_t pixel, uint8_t level)
 {
-    _ledState[pixel][0] = red;
-    _ledState[pixel][1] = green;
-    _ledState[pixel][2] = blue;
+    _ledLevel[pixel] = level;
 }
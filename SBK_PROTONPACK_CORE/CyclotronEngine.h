@@ -21,61 +21,73 @@
 
 #include <Arduino.h>
 #include <Adafruit_NeoPixel.h>
+#include "TimestepEngine.h"
+
+/*  Interface of both cyclotron styles, for the sketch switching between them at runtime. The styles */
+/*  don't derive from it : a sketch with one style calls it directly, without vtable in RAM (AVR), */
+/*  and only CyclotronSwitchable<> styles pay for the virtual calls. */
+/*  The pixels levels and cells states live in a buffer given to begin() : styles switched at */
+/*  runtime share one buffer of the bigger bufferSize(), begin() without buffer allocates one. */
+class Cyclotron
+{
+public:
+    virtual ~Cyclotron() {}
+    virtual uint16_t bufferSize() = 0;
+    virtual void begin(uint8_t *buffer = nullptr) = 0;
+    virtual void clear() = 0;
+    virtual void update() = 0;
+    virtual void rampToPoweredDown(uint16_t ramp_time, bool init, unsigned long now) = 0;
+    virtual void rampToIdleOne(uint16_t ramp_time, bool init, unsigned long now) = 0;
+    virtual void rampToIdleTwo(uint16_t ramp_time, bool init, unsigned long now) = 0;
+    virtual void rampToFiring(uint16_t ramp_time, bool init, unsigned long now) = 0;
+    virtual void setDirection(bool direction) = 0;
+    virtual uint8_t getFirstLed() = 0;
+    virtual uint8_t getLastLed() = 0;
+};
 
 class Cyclotron_GB1_GB2
 {
 public:
-    Cyclotron_GB1_GB2(Adafruit_NeoPixel &strip, bool direction, uint8_t start1, uint8_t end1, uint8_t start2, uint8_t end2, uint8_t start3, uint8_t end3, uint8_t start4, uint8_t end4);
-    ~Cyclotron_GB1_GB2();
-    void begin();
+    Cyclotron_GB1_GB2(Adafruit_NeoPixel &strip, bool direction, const uint8_t cells[][2], uint8_t numCells);
+    uint16_t bufferSize();
+    void begin(uint8_t *buffer = nullptr);
     void clear();
     void update();
-    void rampToPoweredDown(uint16_t ramp_time, bool init);
-    void rampToIdleOne(uint16_t ramp_time, bool init);
-    void rampToIdleTwo(uint16_t ramp_time, bool init);
-    void rampToFiring(uint16_t ramp_time, bool init);
+    void rampToPoweredDown(uint16_t ramp_time, bool init, unsigned long now);
+    void rampToIdleOne(uint16_t ramp_time, bool init, unsigned long now);
+    void rampToIdleTwo(uint16_t ramp_time, bool init, unsigned long now);
+    void rampToFiring(uint16_t ramp_time, bool init, unsigned long now);
     void setDirection(bool direction);
+    uint8_t getFirstLed();
+    uint8_t getLastLed();
 
 private:
-    void _setColorAll(uint8_t red, uint8_t green, uint8_t blue);
-    void _setColor(uint16_t pixel, uint8_t red, uint8_t green, uint8_t blue);
-    void _cell1();
-    void _cell2();
-    void _cell3();
-    void _cell4();
-    void _rotation();
-    uint8_t _cellIntensity(bool state, int16_t tracker, uint8_t start, uint8_t end);
-    void _cellClear(uint8_t start, uint8_t end);
-    void _rampCyc(int16_t rampTime, bool init, int16_t tg_updateSp, int16_t tg_fadeSp, int16_t tg_maxBri, int16_t tg_flashDur, int16_t tg_offset);
-    void _idleCyc(int16_t updateSp, int16_t fadeSp, int16_t maxBri, int16_t flashDur, int16_t offset);
+    void _setLevelAll(uint8_t level);
+    void _setLevel(uint16_t pixel, uint8_t level);
+    void _cell(uint8_t cell);
+    void _rotation(unsigned long now);
+    uint8_t _cellIntensity(int16_t tracker);
+    void _cellFill(uint8_t cell, uint8_t level);
+    void _rampCyc(int16_t rampTime, bool init, int16_t tg_updateSp, int16_t tg_fadeSp, int16_t tg_maxBri, int16_t tg_flashDur, int16_t tg_offset, unsigned long now);
+    void _idleCyc(int16_t updateSp, int16_t fadeSp, int16_t maxBri, int16_t flashDur, int16_t offset, unsigned long now);
     uint16_t _ramp_parameter(int16_t param, int16_t ini, int16_t tg, int16_t incr);
     Adafruit_NeoPixel &_strip;
     bool _direction;
-    unsigned long _prevTime;
-    uint8_t _start1;
-    uint8_t _end1;
-    uint8_t _start2;
-    uint8_t _end2;
-    uint8_t _start3;
-    uint8_t _end3;
-    uint8_t _start4;
-    uint8_t _end4;
+    Timestep _step;
+    const uint8_t (*_cells)[2]; // {1ST LED,LAST LED} of each position in flash memory
+    uint8_t _numCells;
+    uint8_t _start;
+    uint8_t _end;
     uint8_t _numLeds;
-    uint8_t **_ledState;
+    uint8_t *_ledLevel;
     int16_t _cycUpdateSp;
     int16_t _cycFadeSp;
     int16_t _cycBrightness;
     int16_t _cycFlashDuration;
     int16_t _cycPosOffset;
     int16_t _cycPosDuration;
-    uint16_t _cell1Tracker;
-    uint16_t _cell2Tracker;
-    uint16_t _cell3Tracker;
-    uint16_t _cell4Tracker;
-    bool _cell1State;
-    bool _cell2State;
-    bool _cell3State;
-    bool _cell4State;
+    uint16_t *_cellTracker;
+    bool *_cellState;
     unsigned long _prevUpdateSpTime;
     unsigned long _prevFadeTime;
     unsigned long _prevBrightnessTime;
@@ -87,37 +99,40 @@ class Cyclotron_AF_FE
 {
 public:
     Cyclotron_AF_FE(Adafruit_NeoPixel &strip, bool direction, uint8_t start, uint8_t end);
-    ~Cyclotron_AF_FE();
-    void begin();
+    uint16_t bufferSize();
+    void begin(uint8_t *buffer = nullptr);
     void clear();
     void update();
-    void rampToPoweredDown(uint16_t ramp_time, bool init);
-    void rampToIdleOne(uint16_t ramp_time, bool init);
-    void rampToIdleTwo(uint16_t ramp_time, bool init);
-    void rampToFiring(uint16_t ramp_time, bool init);
+    void rampToPoweredDown(uint16_t ramp_time, bool init, unsigned long now);
+    void rampToIdleOne(uint16_t ramp_time, bool init, unsigned long now);
+    void rampToIdleTwo(uint16_t ramp_time, bool init, unsigned long now);
+    void rampToFiring(uint16_t ramp_time, bool init, unsigned long now);
     void setDirection(bool direction);
+    uint8_t getFirstLed();
+    uint8_t getLastLed();
 
 private:
-    void _setColorAll(uint8_t red, uint8_t green, uint8_t blue);
-    void _setColor(uint16_t pixel, uint8_t red, uint8_t green, uint8_t blue);
+    void _setLevelAll(uint8_t level);
+    void _setLevel(uint16_t pixel, uint8_t level);
     void _rotation();
-    void _ramp(uint16_t rampTime, bool init, int16_t tg_updateSp, uint8_t track_inc);
+    void _ramp(uint16_t rampTime, bool init, int16_t tg_updateSp, uint8_t track_inc, unsigned long now);
     int16_t _ramp_parameter(int16_t param, int16_t ini, int16_t tg, int16_t incr);
-    void _idle(uint16_t updateSp, uint8_t tracker_increment);
+    void _idle(uint16_t updateSp, uint8_t tracker_increment, unsigned long now);
 
     Adafruit_NeoPixel &_strip;
     bool _direction;
-    unsigned long _prevTime;
+    Timestep _step;
     uint8_t _start;
     uint8_t _end;
     uint8_t _numLeds;
-    uint8_t **_ledState;
+    uint8_t *_ledLevel;
     uint16_t _cycUpdateSp;
     int16_t _cycBrightness;
     int16_t _cycTrail;
     int16_t _cycFlash;
     int16_t _cycHead;
     int8_t _cycPosTracker;
+    uint8_t _flashBlue;
     unsigned long _prevUpdateSpTime;
     unsigned long _prevFadeTime;
     unsigned long _prevBrightnessTime;
@@ -125,4 +140,23 @@ private:
     unsigned long _prevOffsetTime;
 };
 
+// A style behind the Cyclotron interface
+template <class Style>
+class CyclotronSwitchable : public Style, public Cyclotron
+{
+public:
+    using Style::Style;
+    uint16_t bufferSize() { return Style::bufferSize(); }
+    void begin(uint8_t *buffer = nullptr) { Style::begin(buffer); }
+    void clear() { Style::clear(); }
+    void update() { Style::update(); }
+    void rampToPoweredDown(uint16_t ramp_time, bool init, unsigned long now) { Style::rampToPoweredDown(ramp_time, init, now); }
+    void rampToIdleOne(uint16_t ramp_time, bool init, unsigned long now) { Style::rampToIdleOne(ramp_time, init, now); }
+    void rampToIdleTwo(uint16_t ramp_time, bool init, unsigned long now) { Style::rampToIdleTwo(ramp_time, init, now); }
+    void rampToFiring(uint16_t ramp_time, bool init, unsigned long now) { Style::rampToFiring(ramp_time, init, now); }
+    void setDirection(bool direction) { Style::setDirection(direction); }
+    uint8_t getFirstLed() { return Style::getFirstLed(); }
+    uint8_t getLastLed() { return Style::getLastLed(); }
+};
+
 #endif
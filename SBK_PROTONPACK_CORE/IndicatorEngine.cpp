@@ -18,215 +18,142 @@
 
 #include "IndicatorEngine.h"
 
+static const uint8_t INDICATOR_COLORS[][3] PROGMEM = {
+    {255, 0, 0},     // red
+    {255, 200, 0},   // yellow
+    {150, 150, 150}, // white
+    {12, 189, 24},   // green
+    {255, 100, 0}};  // orange
+
 Indicator::Indicator(Adafruit_NeoPixel &strip, uint8_t pixel)
     : _strip(strip), _pixel(pixel)
 {
-    _prevTime = 0;
-    _flashingState = false;
-    _pulse = false;
+    _patterns = NULL;
+    _tick = 1;
+    _redLevel = 0;
+    _greenLevel = 0;
+    _blueLevel = 0;
+    _color = INDICATOR_OFF;
+    _pattern = INDICATOR_OFF;
+    _bits = 0;
+    _mask = 0;
+    _ticks = 1;
+    _countdown = 1;
+    _step = 0;
 }
 
-void Indicator::begin() { clear(); }
-
-void Indicator::setColor(uint8_t red, uint8_t green, uint8_t blue)
-{
-   // _strip.setPixelColor(_pixel, _strip.gamma8(red), _strip.gamma8(green), _strip.gamma8(blue));
-   _strip.setPixelColor(_pixel, red, green, blue);
-}
-
-void Indicator::show()
+void Indicator::begin(const uint16_t patterns[][3], uint8_t tick)
 {
-    _strip.show();
+    _patterns = patterns;
+    _tick = tick;
+    clear();
 }
 
-void Indicator::clear()
+// Color of the ON steps, written to the chain by update(), gamma is applied by the output color stage
+void Indicator::setColor(uint8_t red, uint8_t green, uint8_t blue)
 {
-    setColor(0, 0, 0);
+    _redLevel = red;
+    _greenLevel = green;
+    _blueLevel = blue;
 }
 
-void Indicator::white(uint16_t updateSp) // flashing
+void Indicator::update()
 {
-    if (updateSp > 0)
+    if (_pattern != INDICATOR_OFF && ((_bits >> _step) & 1))
     {
-        if (!_flashingState)
-        {
-            _pulse = false;
-            _flashingState = true;
-        }
-        if ((millis() - _prevTime) >= updateSp)
-        {
-            _prevTime = millis();
-            if (_pulse == true)
-            {
-                _white();
-                _pulse = false;
-            }
-            else
-            {
-                clear();
-                _pulse = true;
-            }
-        }
+        _strip.setPixelColor(_pixel, _redLevel, _greenLevel, _blueLevel);
     }
     else
     {
-        _white();
-        _flashingState = 0;
+        _strip.setPixelColor(_pixel, 0, 0, 0);
     }
 }
 
-void Indicator::red(uint16_t updateSp) // flashing
+void Indicator::show()
 {
-    if (updateSp > 0)
-    {
-        if (!_flashingState)
-        {
-            _pulse = false;
-            _flashingState = true;
-        }
-        if ((millis() - _prevTime) >= updateSp)
-        {
-            _prevTime = millis();
-            if (_pulse == true)
-            {
-                _red();
-                _pulse = false;
-            }
-            else
-            {
-                clear();
-                _pulse = true;
-            }
-        }
-    }
-    else
-    {
-        _red();
-        _flashingState = 0;
-    }
+    _strip.show();
 }
 
-void Indicator::yellow(uint16_t updateSp) // flashing
+void Indicator::clear()
 {
-    if (updateSp > 0)
-    {
-        if (!_flashingState)
-        {
-            _pulse = false;
-            _flashingState = true;
-        }
-        if ((millis() - _prevTime) >= updateSp)
-        {
-            _prevTime = millis();
-            if (_pulse == true)
-            {
-                _yellow();
-                _pulse = false;
-            }
-            else
-            {
-                clear();
-                _pulse = true;
-            }
-        }
-    }
-    else
-    {
-        _yellow();
-        _flashingState = 0;
-    }
+    _color = INDICATOR_OFF;
+    _pattern = INDICATOR_OFF;
 }
 
-void Indicator::green(uint16_t updateSp) // flashing
+void Indicator::set(uint8_t color, uint8_t pattern)
 {
-    if (updateSp > 0)
+    if (color == _color && pattern == _pattern)
     {
-        if (!_flashingState)
-        {
-            _pulse = false;
-            _flashingState = true;
-        }
-        if ((millis() - _prevTime) >= updateSp)
-        {
-            _prevTime = millis();
-            if (_pulse == true)
-            {
-                _green();
-                _pulse = false;
-            }
-            else
-            {
-                clear();
-                _pulse = true;
-            }
-        }
-    }
-    else
-    {
-        _green();
-        _flashingState = 0;
+        return;
     }
+    _color = color;
+    _pattern = pattern;
+    setColor(pgm_read_byte(&INDICATOR_COLORS[color][0]), pgm_read_byte(&INDICATOR_COLORS[color][1]), pgm_read_byte(&INDICATOR_COLORS[color][2]));
+    _bits = pgm_read_word(&_patterns[pattern][0]);
+    _mask = pgm_read_word(&_patterns[pattern][1]) - 1;
+    uint16_t ticks = pgm_read_word(&_patterns[pattern][2]) / _tick;
+    _ticks = constrain(ticks, 1, 255);
+    _countdown = _ticks;
+    _step = 0;
 }
 
-void Indicator::orange(uint16_t updateSp) // flashing
+void Indicator::advance(uint8_t ticks)
 {
-    if (updateSp > 0)
+    for (; ticks > 0; ticks--)
     {
-        if (!_flashingState)
+        if (--_countdown == 0)
         {
-            _pulse = false;
-            _flashingState = true;
-        }
-        if ((millis() - _prevTime) >= updateSp)
-        {
-            _prevTime = millis();
-            if (_pulse == true)
-            {
-                _orange();
-                _pulse = false;
-            }
-            else
-            {
-                clear();
-                _pulse = true;
-            }
+            _countdown = _ticks;
+            _step = (_step + 1) & _mask;
         }
     }
-    else
-    {
-        _orange();
-        _flashingState = 0;
-    }
 }
 
-void Indicator::_white()
+/*************************************************************************************************************/
+/*************************************************************************************************************/
+/*************************************************************************************************************/
+
+IndicatorBank::IndicatorBank(Indicator *const indicators[], uint8_t count, const uint16_t patterns[][3], uint8_t tick)
+    : _indicators(indicators), _count(count), _patterns(patterns), _tick(tick)
 {
-    setColor(150, 150, 150);
 }
 
-void Indicator::_red()
+void IndicatorBank::begin()
 {
-    // setColor( _strip.gamma8(201),  _strip.gamma8(0),  _strip.gamma8(0));
-    setColor(255, 0, 0);
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        _indicators[i]->begin(_patterns, _tick);
+    }
 }
 
-void Indicator::_yellow()
+// The only timer check of all the indicators
+void IndicatorBank::tick(unsigned long now)
 {
-    // setColor( _strip.gamma8(255),  _strip.gamma8(255),  _strip.gamma8(90));
-    setColor(255, 200, 0);
+    uint8_t ticks = _step.steps(now, _tick);
+    if (ticks == 0)
+    {
+        return;
+    }
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        _indicators[i]->advance(ticks);
+    }
 }
 
-void Indicator::_green()
+void IndicatorBank::update()
 {
-
-    // setColor( _strip.gamma8(173),  _strip.gamma8(255),  _strip.gamma8(90));
-    setColor(12, 189, 24);
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        _indicators[i]->update();
+    }
 }
 
-void Indicator::_orange()
+void IndicatorBank::clear()
 {
-    // setColor( _strip.gamma8(253),  _strip.gamma8(166),  _strip.gamma8(0));
-    setColor(255, 100, 0);
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        _indicators[i]->clear();
+    }
 }
 
 
@@ -235,16 +162,56 @@ void Indicator::_orange()
 SingleColorIndicator::SingleColorIndicator(uint8_t indicator_pin, bool state)
     : _indicator_pin(indicator_pin), _state(state)
 {
-    _prevTime = 0;
     _flashingState = false;
     _pulse = false;
+    _pwm = NULL;
+    _channel = SOFTPWM_NONE;
+    _phase = 0;
 }
 
 void SingleColorIndicator::begin() { 
   pinMode(_indicator_pin,OUTPUT);
   _write(_state); }
 
+// Pin given to a soft PWM channel, left on/off if all channels are used
+void SingleColorIndicator::beginPwm(SoftPwm &pwm)
+{
+    _channel = pwm.attach(_indicator_pin);
+    if (_channel == SOFTPWM_NONE)
+    {
+        begin();
+        return;
+    }
+    _pwm = &pwm;
+    _pwm->setLevel(_channel, _state ? 255 : 0);
+}
+
+void SingleColorIndicator::setLevel(uint8_t level)
+{
+    if (!_pwm)
+    {
+        _write(level & 0x80);
+        return;
+    }
+    _pwm->setLevel(_channel, Adafruit_NeoPixel::gamma8(level));
+    _state = level > 0;
+}
+
+// Triangle fade, 64 steps by period
+void SingleColorIndicator::pulse(uint16_t period, unsigned long now)
+{
+    uint16_t interval = period >> 6;
+    _phase += _step.steps(now, interval ? interval : 1) << 2;
+    setLevel((_phase & 0x80) ? (uint8_t)((255 - _phase) << 1) : (uint8_t)(_phase << 1));
+}
+
 void SingleColorIndicator::_write(bool state){
+    if (_pwm)
+    {
+        _pwm->setLevel(_channel, state ? 255 : 0);
+        _state = state;
+        return;
+    }
     if(state !=_state){
     digitalWrite(_indicator_pin,state);
     _state = state;}
@@ -265,7 +232,7 @@ void SingleColorIndicator::clear()
     _write(false);
 }
 
-void SingleColorIndicator::flash(uint16_t updateSp) // flashing
+void SingleColorIndicator::flash(uint16_t updateSp, unsigned long now) // flashing
 {
     if (updateSp > 0)
     {
@@ -274,9 +241,8 @@ void SingleColorIndicator::flash(uint16_t updateSp) // flashing
             _pulse = false;
             _flashingState = true;
         }
-        if ((millis() - _prevTime) >= updateSp)
+        if (_step.steps(now, updateSp) & 1) // an even number of steps leaves the flash as it is
         {
-            _prevTime = millis();
             if (_pulse == true)
             {
                 on();
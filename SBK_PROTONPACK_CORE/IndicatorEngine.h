@@ -21,32 +21,65 @@
 
 #include "Arduino.h"
 #include <Adafruit_NeoPixel.h>
+#include "TimestepEngine.h"
+#include "SoftPwmEngine.h"
 
+/*  Wand indicators colors, ON steps color of the blink patterns */
+#define INDICATOR_RED 0
+#define INDICATOR_YELLOW 1
+#define INDICATOR_WHITE 2
+#define INDICATOR_GREEN 3
+#define INDICATOR_ORANGE 4
+#define INDICATOR_OFF 0xFF // pattern of a cleared indicator
+
+/*  Blink patterns table (ACONFIG.h INDICATOR_PATTERNS, in flash memory) : one line by pattern, */
+/*  {steps bits (bit 0 first, 1 = ON), steps number (8 or 16), step time (ms)}. */
+/*  Each indicator is given a color and a pattern, then IndicatorBank advances all of them from one */
+/*  shared tick in a single pass : one timer check per loop for all the wand indicators. */
 class Indicator
 {
 public:
     Indicator(Adafruit_NeoPixel &strip, uint8_t pixel);
     void setColor(uint8_t red, uint8_t green, uint8_t blue);
-    void begin();
+    void begin(const uint16_t patterns[][3], uint8_t tick);
+    void update();
     void show();
     void clear();
-    void red(uint16_t updateSp);    // flashing
-    void yellow(uint16_t updateSp); // flashing
-    void white(uint16_t updateSp);  // flashing
-    void green(uint16_t updateSp);  // flashing
-    void orange(uint16_t updateSp); // flashing
+    void set(uint8_t color, uint8_t pattern); // pattern restarted only when color or pattern change
+    void advance(uint8_t ticks);
 
 private:
-    void _red();
-    void _yellow();
-    void _white();
-    void _green();
-    void _orange();
     Adafruit_NeoPixel &_strip;
-    unsigned long _prevTime;
+    const uint16_t (*_patterns)[3]; // in flash memory (PROGMEM), not copied
+    uint8_t _tick;
     uint8_t _pixel;
-    bool _flashingState;
-    bool _pulse;
+    uint8_t _redLevel;
+    uint8_t _greenLevel;
+    uint8_t _blueLevel;
+    uint8_t _color;
+    uint8_t _pattern;
+    uint16_t _bits;
+    uint8_t _mask;      // steps number - 1
+    uint8_t _ticks;     // ticks by step
+    uint8_t _countdown; // ticks left in this step
+    uint8_t _step;
+};
+
+class IndicatorBank
+{
+public:
+    IndicatorBank(Indicator *const indicators[], uint8_t count, const uint16_t patterns[][3], uint8_t tick);
+    void begin();
+    void tick(unsigned long now);
+    void update();
+    void clear();
+
+private:
+    Indicator *const *_indicators;
+    uint8_t _count;
+    const uint16_t (*_patterns)[3];
+    uint8_t _tick;
+    Timestep _step;
 };
 
 class SingleColorIndicator
@@ -57,12 +90,18 @@ public:
     void clear();
     void on();    
     void off();   
-    void flash(uint16_t updateSp); // flashing
+    void flash(uint16_t updateSp, unsigned long now); // flashing
+    void beginPwm(SoftPwm &pwm);                      // dimmed by the soft PWM instead of on/off
+    void setLevel(uint8_t level);                     // 0-255, gamma corrected
+    void pulse(uint16_t period, unsigned long now);   // fading in and out
 
 private:
     void _write(bool state);
     uint8_t _indicator_pin;
-    unsigned long _prevTime;
+    Timestep _step;
+    SoftPwm *_pwm;
+    uint8_t _channel;
+    uint8_t _phase;
     bool _state;
     bool _flashingState;
     bool _pulse;
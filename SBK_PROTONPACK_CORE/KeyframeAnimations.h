@@ -0,0 +1,30 @@
+/*
+ *  KeyframeAnimations.h is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+
+#ifndef KEYFRAMEANIMATIONS_H
+#define KEYFRAMEANIMATIONS_H
+
+#include <Arduino.h>
+
+/*  Keyframe animations played by KeyframeEngine. Each one is a header generated by Tools/SBK_KEYFRAME_ENCODER */
+/*  (-o), run the encoder again to change it. Arrays printed by the encoder can also be pasted here. */
+
+#include "KeyframeVentBoot.h"
+
+#endif
@@ -0,0 +1,151 @@
+/*
+ *  KeyframeEngine.cpp is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+
+#include "KeyframeEngine.h"
+
+Keyframes::Keyframes(Adafruit_NeoPixel &strip, uint8_t start, uint8_t end)
+    : _strip(strip), _start(start), _end(end)
+{
+    _numLeds = (_end - _start + 1);
+    _animation = NULL;
+    _read = NULL;
+    _frameStart = 0;
+    _hold = 0;
+    _frame = 0;
+    _frames = 0;
+    _period = 0;
+    _pixels = 0;
+    _playing = false;
+    _done = false;
+}
+
+void Keyframes::begin()
+{
+    clear();
+}
+
+void Keyframes::update()
+{
+    // Only write the segment while the animation is played, the other engines have it otherwise
+    if (!_playing)
+    {
+        return;
+    }
+    for (uint8_t i = 0; i < _numLeds; i++)
+    {
+        if (i < _pixels && i < KF_MAX_PIXELS)
+        {
+            _strip.setPixelColor(i + _start, _rgb[i][0], _rgb[i][1], _rgb[i][2]);
+        }
+        else
+        {
+            _strip.setPixelColor(i + _start, 0, 0, 0);
+        }
+    }
+    _playing = false;
+}
+
+void Keyframes::clear()
+{
+    _animation = NULL;
+    _playing = false;
+    _done = false;
+    memset(_rgb, 0, sizeof(_rgb));
+}
+
+bool Keyframes::play(const uint8_t *animation, bool loop, bool init, unsigned long now)
+{
+    if (init || animation != _animation)
+    {
+        _animation = animation;
+        _pixels = pgm_read_byte(&animation[0]);
+        _period = pgm_read_byte(&animation[1]);
+        _frames = pgm_read_byte(&animation[2]) | (pgm_read_byte(&animation[3]) << 8);
+        _done = false;
+        _restart(now);
+    }
+    _playing = true;
+
+    if (!_done && now - _frameStart >= _hold)
+    {
+        _frameStart += _hold;
+        if (_frame < _frames)
+        {
+            _decodeFrame();
+        }
+        else if (loop)
+        {
+            _restart(_frameStart);
+        }
+        else
+        {
+            _done = true;
+        }
+        // Too late for this keyframe already : the loop was stalled, drop the lag instead of rushing
+        if (now - _frameStart >= _hold)
+        {
+            _frameStart = now;
+        }
+    }
+    return _done;
+}
+
+void Keyframes::_restart(unsigned long now)
+{
+    // First keyframe is decoded on all pixels OFF
+    memset(_rgb, 0, sizeof(_rgb));
+    _read = _animation + KF_HEADER_SIZE;
+    _frame = 0;
+    _frameStart = now;
+    _decodeFrame();
+}
+
+void Keyframes::_decodeFrame()
+{
+    _hold = (uint16_t)pgm_read_byte(_read++) * _period;
+    uint16_t p = 0;
+    while (p < _pixels)
+    {
+        uint8_t op = pgm_read_byte(_read++);
+        if (op < KF_OP_COPY)
+        {
+            p += op + 1; // skip, pixels unchanged
+            continue;
+        }
+        bool fill = op >= KF_OP_FILL;
+        for (uint8_t n = (op & 0x3F) + 1; n > 0 && p < _pixels; n--, p++)
+        {
+            if (p < KF_MAX_PIXELS)
+            {
+                _rgb[p][0] = pgm_read_byte(_read);
+                _rgb[p][1] = pgm_read_byte(_read + 1);
+                _rgb[p][2] = pgm_read_byte(_read + 2);
+            }
+            if (!fill)
+            {
+                _read += 3;
+            }
+        }
+        if (fill)
+        {
+            _read += 3;
+        }
+    }
+    _frame++;
+}
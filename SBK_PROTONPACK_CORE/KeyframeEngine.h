@@ -0,0 +1,68 @@
+/*
+ *  KeyframeEngine.h is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+
+#ifndef KEYFRAMEENGINE_H
+#define KEYFRAMEENGINE_H
+
+#include <Arduino.h>
+#include <Adafruit_NeoPixel.h>
+
+/*  Keyframe animations are byte streams in flash memory (PROGMEM), made by Tools/SBK_KEYFRAME_ENCODER : */
+/*    header   : pixels, period (ms), frames (uint16_t, low byte first)                                  */
+/*    keyframe : hold (periods), then ops until all the pixels are covered                               */
+/*    ops      : 0x00-0x7F skip (op & 0x7F) + 1 pixels, 0x80-0xBF copy (op & 0x3F) + 1 R,G,B pixels,     */
+/*               0xC0-0xFF fill (op & 0x3F) + 1 pixels with one R,G,B                                    */
+/*  Each keyframe is a delta on the previous one, the first one on all pixels OFF. One keyframe at most  */
+/*  is decoded by play() call, so the decode cost is bounded by the segment size.                        */
+#define KF_HEADER_SIZE 4
+#define KF_MAX_PIXELS 16 // pixels kept in RAM, animation pixels over this are decoded but not shown
+#define KF_OP_COPY 0x80
+#define KF_OP_FILL 0xC0
+
+class Keyframes
+{
+public:
+    Keyframes(Adafruit_NeoPixel &strip, uint8_t start, uint8_t end);
+    void begin();
+    void update();
+    void clear();
+    // Pixels are shown while play() is called, return true when a not looping animation is done
+    bool play(const uint8_t *animation, bool loop, bool init, unsigned long now);
+
+private:
+    void _restart(unsigned long now);
+    void _decodeFrame();
+    Adafruit_NeoPixel &_strip;
+    const uint8_t *_animation;
+    const uint8_t *_read; // next keyframe in flash memory
+    unsigned long _frameStart;
+    uint16_t _hold; // current keyframe time (ms)
+    uint16_t _frame;
+    uint16_t _frames;
+    uint8_t _period;
+    uint8_t _pixels;
+    uint8_t _start;
+    uint8_t _end;
+    uint8_t _numLeds;
+    bool _playing;
+    bool _done;
+    uint8_t _rgb[KF_MAX_PIXELS][3];
+};
+
+#endif
@@ -0,0 +1,33 @@
+// Generated by Tools/SBK_KEYFRAME_ENCODER, do not edit : run the encoder again
+#ifndef KEYFRAMEVENTBOOT_H
+#define KEYFRAMEVENTBOOT_H
+
+#include <Arduino.h>
+
+// KF_VENT_BOOT : 7 pixels, 55 keyframes, 3040 ms, 322 bytes (1214 raw)
+// Generated by Tools/SBK_KEYFRAME_ENCODER from vent_boot.csv
+const uint8_t KF_VENT_BOOT[] PROGMEM = {
+    0x07, 0x14, 0x37, 0x00, 0x03, 0x80, 0x50, 0x78, 0xFF, 0x05, 0x03, 0x81, 0x14, 0x1E, 0x3C, 0x50,
+    0x78, 0xFF, 0x04, 0x03, 0x82, 0x00, 0x00, 0x00, 0x14, 0x1E, 0x3C, 0x50, 0x78, 0xFF, 0x03, 0x03,
+    0x00, 0x82, 0x00, 0x00, 0x00, 0x14, 0x1E, 0x3C, 0x50, 0x78, 0xFF, 0x02, 0x03, 0x01, 0x82, 0x00,
+    0x00, 0x00, 0x14, 0x1E, 0x3C, 0x50, 0x78, 0xFF, 0x01, 0x03, 0x02, 0x82, 0x00, 0x00, 0x00, 0x14,
+    0x1E, 0x3C, 0x50, 0x78, 0xFF, 0x00, 0x03, 0x03, 0x82, 0x00, 0x00, 0x00, 0x14, 0x1E, 0x3C, 0x50,
+    0x78, 0xFF, 0x02, 0xC6, 0x0F, 0x00, 0x00, 0x02, 0xC6, 0x1F, 0x00, 0x00, 0x02, 0xC6, 0x2F, 0x00,
+    0x00, 0x02, 0xC6, 0x3F, 0x00, 0x00, 0x02, 0xC6, 0x4F, 0x00, 0x00, 0x02, 0xC6, 0x5F, 0x00, 0x00,
+    0x02, 0xC6, 0x6F, 0x00, 0x00, 0x02, 0xC6, 0x7F, 0x00, 0x00, 0x02, 0xC6, 0x8F, 0x00, 0x00, 0x02,
+    0xC6, 0x9F, 0x00, 0x00, 0x02, 0xC6, 0xAF, 0x00, 0x00, 0x02, 0xC6, 0xBF, 0x00, 0x00, 0x02, 0xC6,
+    0xCF, 0x00, 0x00, 0x02, 0xC6, 0xDF, 0x00, 0x00, 0x02, 0xC6, 0xEF, 0x00, 0x00, 0x16, 0xC6, 0xFF,
+    0x00, 0x00, 0x02, 0xC6, 0xF0, 0x03, 0x0F, 0x02, 0xC6, 0xE0, 0x07, 0x1F, 0x02, 0xC6, 0xD0, 0x0B,
+    0x2F, 0x02, 0xC6, 0xC0, 0x0F, 0x3F, 0x02, 0xC6, 0xB0, 0x12, 0x4F, 0x02, 0xC6, 0xA0, 0x16, 0x5F,
+    0x02, 0xC6, 0x90, 0x1A, 0x6F, 0x02, 0xC6, 0x80, 0x1E, 0x7F, 0x02, 0xC6, 0x70, 0x21, 0x8F, 0x02,
+    0xC6, 0x60, 0x25, 0x9F, 0x02, 0xC6, 0x50, 0x29, 0xAF, 0x02, 0xC6, 0x40, 0x2D, 0xBF, 0x02, 0xC6,
+    0x30, 0x30, 0xCF, 0x02, 0xC6, 0x20, 0x34, 0xDF, 0x02, 0xC6, 0x10, 0x38, 0xEF, 0x11, 0xC6, 0x00,
+    0x3C, 0xFF, 0x02, 0xC6, 0x00, 0x38, 0xEF, 0x02, 0xC6, 0x00, 0x34, 0xDF, 0x02, 0xC6, 0x00, 0x30,
+    0xCF, 0x02, 0xC6, 0x00, 0x2D, 0xBF, 0x02, 0xC6, 0x00, 0x29, 0xAF, 0x02, 0xC6, 0x00, 0x25, 0x9F,
+    0x02, 0xC6, 0x00, 0x21, 0x8F, 0x02, 0xC6, 0x00, 0x1E, 0x7F, 0x02, 0xC6, 0x00, 0x1A, 0x6F, 0x02,
+    0xC6, 0x00, 0x16, 0x5F, 0x02, 0xC6, 0x00, 0x12, 0x4F, 0x02, 0xC6, 0x00, 0x0F, 0x3F, 0x02, 0xC6,
+    0x00, 0x0B, 0x2F, 0x02, 0xC6, 0x00, 0x07, 0x1F, 0x02, 0xC6, 0x00, 0x03, 0x0F, 0x02, 0xC6, 0x00,
+    0x00, 0x00,
+};
+
+#endif
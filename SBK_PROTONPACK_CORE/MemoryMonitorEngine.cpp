@@ -0,0 +1,180 @@
+/*
+ *  MemoryMonitorEngine.cpp is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+#include "MemoryMonitorEngine.h"
+
+#if defined(__AVR__)
+#define MEMMON_AVR
+#include <stdlib.h>
+
+extern uint8_t __data_start; // start of static variables
+extern uint8_t _end;         // end of static variables, heap start
+extern uint8_t __stack;      // RAMEND, stack start
+extern char *__brkval;       // heap end, 0 until the first malloc()
+struct __freelist            // avr-libc malloc free list entry
+{
+    size_t sz;
+    struct __freelist *nx;
+};
+extern struct __freelist *__flp;
+
+static inline uint8_t *heapEnd()
+{
+    return __brkval ? (uint8_t *)__brkval : &_end;
+}
+#endif
+
+MemoryMonitor::MemoryMonitor()
+{
+    _active = false;
+    _guardMargin = 0;
+    _lowest = 0;
+    _freeListBytes = 0;
+    _largestFreeBlock = 0;
+    _freeListBlocks = 0;
+    _prevCheck = 0;
+}
+
+void MemoryMonitor::begin(uint16_t guardMargin)
+{
+    _guardMargin = guardMargin;
+#ifdef MEMMON_AVR
+    // Paint the free RAM from the heap end to just under this stack frame. Done here, not at boot,
+    // so nothing runs when the monitor is not used : the stack used before begin() is counted as used.
+    uint8_t *top = (uint8_t *)SP - MEMMON_PAINT_MARGIN;
+    for (uint8_t *p = heapEnd(); p < top; p++)
+    {
+        *p = MEMMON_CANARY;
+    }
+    _lowest = top;
+    _active = true;
+    _check();
+#endif
+}
+
+// Return false when the guard margin has been crossed
+bool MemoryMonitor::update()
+{
+    if (!_active)
+    {
+        return true;
+    }
+    if (millis() - _prevCheck >= MEMMON_CHECK_DELAY)
+    {
+        _prevCheck = millis();
+        _check();
+    }
+    return getMinFreeGap() >= _guardMargin;
+}
+
+uint16_t MemoryMonitor::getStackHighWater()
+{
+#ifdef MEMMON_AVR
+    if (_active)
+    {
+        return &__stack - _lowest;
+    }
+#endif
+    return 0;
+}
+
+uint16_t MemoryMonitor::getMinFreeGap()
+{
+#ifdef MEMMON_AVR
+    if (_active && _lowest > heapEnd())
+    {
+        return _lowest - heapEnd();
+    }
+#endif
+    return 0;
+}
+
+uint16_t MemoryMonitor::getFreeListBytes()
+{
+    return _freeListBytes;
+}
+
+uint16_t MemoryMonitor::getLargestFreeBlock()
+{
+    return _largestFreeBlock;
+}
+
+uint8_t MemoryMonitor::getFreeListBlocks()
+{
+    return _freeListBlocks;
+}
+
+void MemoryMonitor::printReport(Print &out)
+{
+    if (!_active)
+    {
+        out.println(F("Memory monitor not available"));
+        return;
+    }
+#ifdef MEMMON_AVR
+    _check();
+    out.print(F("RAM static / heap / stack max : "));
+    out.print((uint16_t)(&_end - &__data_start)), out.print(F(" / "));
+    out.print((uint16_t)(heapEnd() - &_end)), out.print(F(" / "));
+    out.println(getStackHighWater());
+    out.print(F("Min free RAM (guard margin) : "));
+    out.print(getMinFreeGap()), out.print(F(" ("));
+    out.print(_guardMargin), out.println(F(")"));
+    out.print(F("Heap free list blocks / bytes / largest : "));
+    out.print(_freeListBlocks), out.print(F(" / "));
+    out.print(_freeListBytes), out.print(F(" / "));
+    out.println(_largestFreeBlock);
+#endif
+}
+
+void MemoryMonitor::_check()
+{
+#ifdef MEMMON_AVR
+    // Bytes above _lowest are already known as used : only scan from the heap end to _lowest
+    uint8_t *p = heapEnd();
+    while (p < _lowest && *p == MEMMON_CANARY)
+    {
+        p++;
+    }
+    _lowest = p;
+    _walkFreeList();
+#endif
+}
+
+void MemoryMonitor::_walkFreeList()
+{
+#ifdef MEMMON_AVR
+    uint16_t bytes = 0;
+    uint16_t largest = 0;
+    uint8_t blocks = 0;
+    noInterrupts(); // free list must not change while it is walked
+    for (struct __freelist *fp = __flp; fp; fp = fp->nx)
+    {
+        bytes += fp->sz;
+        if (fp->sz > largest)
+        {
+            largest = fp->sz;
+        }
+        blocks++;
+    }
+    interrupts();
+    _freeListBytes = bytes;
+    _largestFreeBlock = largest;
+    _freeListBlocks = blocks;
+#endif
+}
@@ -0,0 +1,61 @@
+/*
+ *  MemoryMonitorEngine.h is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+#ifndef MEMORYMONITORENGINE_H
+#define MEMORYMONITORENGINE_H
+
+#include <Arduino.h>
+
+/*  Runtime RAM check for AVR boards : */
+/*  begin() paints the free RAM between the heap end and its own stack frame with MEMMON_CANARY, nothing */
+/*  is painted at boot when the monitor is not used. The deepest stack point is then found by looking for */
+/*  the first unpainted byte above the heap, and the malloc() free list is walked to find the heap */
+/*  fragmentation. Call begin() at the end of setup(), once the heap is allocated : stack depth is */
+/*  measured from there. */
+/*  update() returns false when the free RAM between heap and stack ever went under the guard margin. */
+/*  On other MCU, nothing is measured and update() always returns true. */
+#define MEMMON_CANARY 0xC5
+#define MEMMON_CHECK_DELAY 50 // ms between stack checks
+#define MEMMON_PAINT_MARGIN 16 // bytes left unpainted under begin() stack frame
+
+class MemoryMonitor
+{
+public:
+    MemoryMonitor();
+    void begin(uint16_t guardMargin);
+    bool update();
+    uint16_t getStackHighWater();    // max stack size reached, bytes
+    uint16_t getMinFreeGap();        // min free RAM reached between heap and stack, bytes
+    uint16_t getFreeListBytes();     // freed heap bytes that can only be reused by malloc()
+    uint16_t getLargestFreeBlock();  // largest freed heap block
+    uint8_t getFreeListBlocks();     // number of freed heap blocks
+    void printReport(Print &out);
+
+private:
+    void _check();
+    void _walkFreeList();
+    bool _active;
+    uint16_t _guardMargin;
+    uint8_t *_lowest; // deepest stack byte used
+    uint16_t _freeListBytes;
+    uint16_t _largestFreeBlock;
+    uint8_t _freeListBlocks;
+    unsigned long _prevCheck;
+};
+
+#endif
@@ -0,0 +1,82 @@
+/*
+ *  NoiseEngine.cpp is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+
+#include "NoiseEngine.h"
+
+Xorshift16::Xorshift16(uint16_t seed)
+{
+    this->seed(seed);
+}
+
+void Xorshift16::seed(uint16_t seed)
+{
+    _state = seed ? seed : 1; // a zero state would stay zero
+}
+
+uint16_t Xorshift16::next()
+{
+    _state ^= _state << 7;
+    _state ^= _state >> 9;
+    _state ^= _state << 8;
+    return _state;
+}
+
+uint8_t Xorshift16::next8()
+{
+    return next() >> 8;
+}
+
+/*************************************************************************************************************/
+/*************************************************************************************************************/
+/*************************************************************************************************************/
+
+ValueNoise::ValueNoise(uint8_t seed) : _seed(seed)
+{
+}
+
+uint8_t ValueNoise::at(uint16_t x)
+{
+    uint8_t i = x >> 8;
+    uint8_t f = x & 0xFF;
+    uint8_t a = _lattice(i);
+    uint8_t b = _lattice(i + 1);
+    // Smoothstep 3f² - 2f³ in 8 bits fixed point, 0 to 256
+    uint16_t ff = ((uint16_t)f * f) >> 8;
+    uint16_t s = 3 * ff - ((ff * f) >> 7);
+    if (b >= a)
+    {
+        return a + (((uint16_t)(b - a) * s) >> 8);
+    }
+    return a - (((uint16_t)(a - b) * s) >> 8);
+}
+
+uint8_t ValueNoise::scale(uint8_t value, uint8_t range)
+{
+    return ((uint16_t)value * range) >> 8;
+}
+
+// Random value of a lattice point : odd multiplies and xorshifts, one to one on the 256 points
+uint8_t ValueNoise::_lattice(uint8_t i)
+{
+    uint8_t h = i * 167 + _seed;
+    h ^= h >> 3;
+    h *= 29;
+    h ^= h >> 4;
+    return h;
+}
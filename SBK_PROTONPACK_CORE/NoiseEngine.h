@@ -0,0 +1,54 @@
+/*
+ *  NoiseEngine.h is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+
+#ifndef NOISEENGINE_H
+#define NOISEENGINE_H
+
+#include <Arduino.h>
+
+/*  Pseudo random numbers and noise for the animations, with 8 and 16 bits math only. */
+/*  Xorshift16 is a 16 bits xorshift generator (7, 9, 8 shifts, period 65535) : a few shifts and XORs */
+/*  where Arduino random() runs a 32 bits LCG and a 32 bits modulo division. */
+/*  ValueNoise is a smooth 1D noise : one random value every 256 positions (x is 8.8 fixed point), */
+/*  smoothstep interpolated between them. Moving x along the time gives a smooth random animation. */
+class Xorshift16
+{
+public:
+    Xorshift16(uint16_t seed);
+    void seed(uint16_t seed);
+    uint16_t next();
+    uint8_t next8();
+
+private:
+    uint16_t _state;
+};
+
+class ValueNoise
+{
+public:
+    ValueNoise(uint8_t seed);
+    uint8_t at(uint16_t x);
+    static uint8_t scale(uint8_t value, uint8_t range); // value * range / 256
+
+private:
+    uint8_t _lattice(uint8_t i);
+    uint8_t _seed;
+};
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ *  PlayerBackend_DFPlayerMini.h is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+#ifndef PLAYERBACKEND_DFPLAYERMINI_H
+#define PLAYERBACKEND_DFPLAYERMINI_H
+
+#include <Arduino.h>
+#include <DFRobotDFPlayerMini.h>
+
+/////////////////////////////////////////////////////
+/*                                                 */
+/************* DFPlayer Mini section ***************/
+/*             (with DFRobot library)              */
+/////////////////////////////////////////////////////
+/*  Backend for Player<> in PlayerEngine.h */
+class PlayerBackend_DFPlayerMini
+{
+public:
+    PlayerBackend_DFPlayerMini(uint8_t RX_pin, uint8_t TX_pin) {}
+
+    bool begin(Stream &s, uint8_t commandDelay)
+    {
+        if (_player.begin(s, false, true))
+        {
+            delay(commandDelay);
+            _player.outputDevice(DFPLAYER_DEVICE_SD);
+            delay(commandDelay);
+            _player.EQ(DFPLAYER_EQ_POP);
+            delay(commandDelay);
+            _player.setTimeOut(50);
+            delay(commandDelay);
+            _player.enableDAC();
+            delay(commandDelay);
+            _player.disableLoop();
+            delay(commandDelay);
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    void play(int16_t track_num) { _player.play(track_num); }
+    void loop(int16_t track_num) { _player.loop(track_num); }
+    void advert(int16_t track_num) { _player.advertise(track_num); }
+    void stopAdvert() { _player.stopAdvertise(); }
+    void stop() { _player.stop(); }
+    void pause() { _player.pause(); }
+    void next() { _player.next(); }
+    void previous() { _player.previous(); }
+    void volume(uint8_t volume) { _player.volume(volume); }
+    void themesMode() { _player.loopFolder(1); }
+    void singleMode() { _player.disableLoop(); }
+    void cyclingMode() { _player.enableLoop(); }
+
+private:
+    DFRobotDFPlayerMini _player;
+};
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ *  PlayerBackend_DFPlayerMini_Fast.h is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+#ifndef PLAYERBACKEND_DFPLAYERMINI_FAST_H
+#define PLAYERBACKEND_DFPLAYERMINI_FAST_H
+
+#include <Arduino.h>
+#include <DFPlayerMini_Fast.h>
+
+/////////////////////////////////////////////////////
+/*                                                 */
+/************* DFPlayer Mini section ***************/
+/*       (with DFPlayerMini_Fast.h library)       */
+/////////////////////////////////////////////////////
+/*  Backend for Player<> in PlayerEngine.h */
+class PlayerBackend_DFPlayerMini_Fast
+{
+public:
+    PlayerBackend_DFPlayerMini_Fast(uint8_t RX_pin, uint8_t TX_pin) : _RX_pin(RX_pin) {}
+
+    bool begin(Stream &s, uint8_t commandDelay)
+    {
+        if (_player.begin(s, false, 50))
+        {
+            delay(commandDelay);
+            _player.volumeAdjustSet(_GAIN);
+            delay(commandDelay);
+            _player.playbackSource(2);
+            delay(commandDelay);
+            _player.EQSelect(1);
+            delay(commandDelay);
+            _player.stop();
+            delay(commandDelay);
+            _player.startDAC();
+            delay(commandDelay);
+            _player.stopRepeat();
+            delay(commandDelay);
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    // RX pin is only driven while a command is sent
+    void play(int16_t track_num)
+    {
+        pinMode(_RX_pin, OUTPUT);
+        _player.play(track_num);
+        pinMode(_RX_pin, INPUT_PULLUP);
+    }
+
+    void loop(int16_t track_num)
+    {
+        pinMode(_RX_pin, OUTPUT);
+        _player.loop(track_num);
+        pinMode(_RX_pin, INPUT_PULLUP);
+    }
+
+    void advert(int16_t track_num)
+    {
+        pinMode(_RX_pin, OUTPUT);
+        _player.playAdvertisement(track_num);
+        pinMode(_RX_pin, INPUT_PULLUP);
+    }
+
+    void stopAdvert()
+    {
+        pinMode(_RX_pin, OUTPUT);
+        _player.stopAdvertisement();
+        pinMode(_RX_pin, INPUT_PULLUP);
+    }
+
+    void stop()
+    {
+        pinMode(_RX_pin, OUTPUT);
+        _player.stop();
+        pinMode(_RX_pin, INPUT_PULLUP);
+    }
+
+    void pause()
+    {
+        pinMode(_RX_pin, OUTPUT);
+        _player.pause();
+        pinMode(_RX_pin, INPUT_PULLUP);
+    }
+
+    void next()
+    {
+        pinMode(_RX_pin, OUTPUT);
+        _player.playNext();
+        pinMode(_RX_pin, INPUT_PULLUP);
+    }
+
+    void previous()
+    {
+        pinMode(_RX_pin, OUTPUT);
+        _player.playPrevious();
+        pinMode(_RX_pin, INPUT_PULLUP);
+    }
+
+    void volume(uint8_t volume)
+    {
+        pinMode(_RX_pin, OUTPUT);
+        _player.volume(volume);
+        pinMode(_RX_pin, INPUT_PULLUP);
+    }
+
+    void themesMode()
+    {
+        pinMode(_RX_pin, OUTPUT);
+        _player.repeatFolder(1);
+        pinMode(_RX_pin, INPUT_PULLUP);
+    }
+
+    // No single/cycling play mode functions available for this in the library
+    void singleMode() {}
+    void cyclingMode() {}
+
+private:
+    static const uint8_t _GAIN = 5;
+    DFPlayerMini_Fast _player;
+    uint8_t _RX_pin;
+};
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ *  PlayerBackend_Mock.h is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+#ifndef PLAYERBACKEND_MOCK_H
+#define PLAYERBACKEND_MOCK_H
+
+#include <Arduino.h>
+
+/////////////////////////////////////////////////////
+/*                                                 */
+/*************** Mock player section ***************/
+/*               (no audio board)                  */
+/////////////////////////////////////////////////////
+/*  Backend for Player<> in PlayerEngine.h */
+/*  Nothing is sent on the serial line, commands are only counted : use it to run and time */
+/*  the pack sequences without audio board, or to measure the player cost in a benchmark. */
+class PlayerBackend_Mock
+{
+public:
+    PlayerBackend_Mock(uint8_t RX_pin, uint8_t TX_pin)
+    {
+        commands = 0;
+        lastTrack = 0;
+        lastVolume = 0;
+    }
+
+    bool begin(Stream &s, uint8_t commandDelay) { return true; }
+    void play(int16_t track_num) { commands++, lastTrack = track_num; }
+    void loop(int16_t track_num) { commands++, lastTrack = track_num; }
+    void advert(int16_t track_num) { commands++, lastTrack = track_num; }
+    void stopAdvert() { commands++; }
+    void stop() { commands++; }
+    void pause() { commands++; }
+    void next() { commands++; }
+    void previous() { commands++; }
+    void volume(uint8_t volume) { commands++, lastVolume = volume; }
+    void themesMode() { commands++; }
+    void singleMode() { commands++; }
+    void cyclingMode() { commands++; }
+
+    uint16_t commands;
+    int16_t lastTrack;
+    uint8_t lastVolume;
+};
+
+#endif
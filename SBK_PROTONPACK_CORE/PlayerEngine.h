@@ -20,85 +20,498 @@
 #define PLAYERENGINE_H
 
 #include <Arduino.h>
-#include <DFRobot_DF1201S.h> //for the DFPlayer Pro
-#include <DFRobotDFPlayerMini.h>
-#include <DFPlayerMini_Fast.h>
+#include "VolumePotEngine.h"
 
-class Player_DFPlayerMini_Fast
+/////////////////////////////////////////////////////
+/*                                                 */
+/*************** Player front-end ******************/
+/*                                                 */
+/////////////////////////////////////////////////////
+/*  Common player logic : tracks timing, volume and volume potentiometer.  */
+/*  The audio board itself is driven by the Backend class, see the PlayerBackend_xxx.h files. */
+/*  Only the selected backend header is included in the main sketch, so only its library is compiled. */
+/*  A backend must provide : */
+/*    Backend(uint8_t RX_pin, uint8_t TX_pin); */
+/*    bool begin(Stream &s, uint8_t commandDelay); */
+/*    void play(int16_t track_num);  void loop(int16_t track_num); */
+/*    void advert(int16_t track_num);  void stopAdvert(); */
+/*    void stop();  void pause();  void next();  void previous();  void volume(uint8_t volume); */
+/*    void themesMode();  void singleMode();  void cyclingMode(); */
+/*  PlayerVoice<> is one audio board without volume potentiometer, as used by the DualPlayer voices. */
+/*  Player<> adds the volume potentiometer. */
+/*  The player refuses a track inserted while another inserted one is heard : the last one is stopped */
+/*  first and the new one is sent by update() after the command delay. */
+#define PLAYER_INSERT_MARGIN 250 // ms an inserted track may still be heard after its length (player latency)
+
+template <class Backend>
+class PlayerVoice
 {
 public:
-    Player_DFPlayerMini_Fast(const uint8_t max, uint8_t volume, uint8_t RX_pin, uint8_t TX_pin, uint8_t pot_pin, bool vol_pot_exist, const uint8_t commandDelay);
-    bool begin(Stream &s);
-    bool isPlaying();
-    void setThemesPlaymode();
-    void setSinglePlaymode();
-    void setCyclingTrackPlaymode();
-    void loopFileNum(int16_t track_num);
-    void playFileNum(int16_t track_num);
-    void playFileNum(int16_t track_num, uint16_t track_length);
-    void stop();
-    void pause();
-    void next();
-    void previous();
-    void setVol(uint8_t volume);
-    void defineVolumePot(uint8_t pin, bool active);
-        uint8_t setVolWithPotatStart();
-    uint8_t setVolWithPot();
+    PlayerVoice(const uint8_t max, uint8_t volume, uint8_t RX_pin, uint8_t TX_pin, const uint8_t commandDelay)
+        : _backend(RX_pin, TX_pin), _VOLUME_MAX(min(30, max)), _COMMAND_DELAY(commandDelay), _volume(volume)
+    {
+        _startTime = 0;
+        _TrackDuration = 0;
+        _inserted = false;
+        _pendingInsert = 0;
+        _pendingTime = 0;
+        playing = false;
+    }
+
+    bool begin(Stream &s)
+    {
+        if (_backend.begin(s, _COMMAND_DELAY))
+        {
+            setVol(_volume);
+            delay(_COMMAND_DELAY);
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    // Other commands are sent right away with a single player
+    void update()
+    {
+        if (_pendingInsert != 0 && millis() - _pendingTime >= _COMMAND_DELAY)
+        {
+            _backend.advert(_pendingInsert);
+            _pendingInsert = 0;
+        }
+    }
+
+    bool isPlaying()
+    {
+        if ((millis() - _startTime) < _TrackDuration)
+        {
+            if (!playing)
+            {
+                playing = true;
+            }
+        }
+        else
+        {
+            if (playing)
+            {
+                playing = false;
+            }
+        }
+        return playing;
+    }
+
+    void setThemesPlaymode()
+    {
+        _backend.themesMode();
+        _TrackDuration = 0;
+        _inserted = false;
+    }
+
+    void setSinglePlaymode()
+    {
+        _backend.singleMode();
+    }
+
+    void setCyclingTrackPlaymode()
+    {
+        _backend.cyclingMode();
+    }
+
+    void loopFileNum(int16_t track_num)
+    {
+        _backend.loop(track_num);
+        _TrackDuration = 0;
+        _inserted = false;
+    }
+
+    void playFileNum(int16_t track_num, uint16_t track_length)
+    {
+        _backend.play(track_num);
+        _startTime = millis();
+        _TrackDuration = track_length;
+        _inserted = false;
+    }
+
+    // Play the track over the looping one, with the player advertisement feature
+    void insertFileNum(int16_t track_num, uint16_t track_length)
+    {
+        if (_inserted && millis() - _startTime < _TrackDuration + PLAYER_INSERT_MARGIN)
+        {
+            _backend.stopAdvert();
+            _pendingInsert = track_num;
+            _pendingTime = millis();
+            track_length += _COMMAND_DELAY;
+        }
+        else
+        {
+            _backend.advert(track_num);
+            _pendingInsert = 0;
+        }
+        _inserted = true;
+        _startTime = millis();
+        _TrackDuration = track_length;
+    }
+
+    void stopInsert()
+    {
+        _backend.stopAdvert();
+        _TrackDuration = 0;
+        _inserted = false;
+        _pendingInsert = 0;
+    }
+
+    void stop()
+    {
+        _backend.stop();
+        _inserted = false;
+        _pendingInsert = 0;
+    }
+
+    void pause()
+    {
+        _backend.pause();
+    }
+
+    void next()
+    {
+        _backend.next();
+    }
+
+    void previous()
+    {
+        _backend.previous();
+    }
+
+    void setVol(uint8_t volume)
+    {
+        _volume = min(volume, _VOLUME_MAX);
+        _backend.volume(_volume);
+    }
+
     bool playing;
 
-private:
-    DFPlayerMini_Fast _player;
-    unsigned long _startTime;
-    unsigned long _startTimePrev;
+protected:
+    void _setVolume(uint8_t newVolume)
+    {
+        if (newVolume != _volume)
+        {
+            _volume = newVolume;
+            _backend.volume(newVolume);
+        }
+    }
+    Backend _backend;
     const uint8_t _VOLUME_MAX;
     const uint8_t _COMMAND_DELAY;
     uint8_t _volume;
-    uint8_t _prevVolume;
-    uint8_t _RX_pin;
-    uint8_t _TX_pin;
-    uint8_t _pot_pin;
-    bool _volPotActive;
+    unsigned long _startTime;
     unsigned long _TrackDuration;
-    uint8_t _AUDIO_ADVANCE;
-    uint8_t _gain;
+    bool _inserted;         // last track was inserted, it may still be heard
+    int16_t _pendingInsert; // track inserted once the last one is stopped, 0 = none
+    unsigned long _pendingTime;
 };
 
-class Player_DFPlayerMini
+template <class Backend>
+class Player : public PlayerVoice<Backend>
 {
 public:
-    Player_DFPlayerMini(const uint8_t max, uint8_t volume, uint8_t RX_pin, uint8_t TX_pin, uint8_t pot_pin, bool vol_pot_exist, const uint8_t commandDelay);
-    bool begin(Stream &s);
-    bool isPlaying();
-    void setThemesPlaymode();
-    void setSinglePlaymode();
-    void setCyclingTrackPlaymode();
-    void loopFileNum(int16_t track_num);
-    void playFileNum(int16_t track_num);
-    void playFileNum(int16_t track_num, uint16_t track_length);
-    void stop();
-    void pause();
-    void next();
-    void previous();
-    void setVol(uint8_t volume);
-    void defineVolumePot(uint8_t pin, bool active);
-        uint8_t setVolWithPotatStart();
-    uint8_t setVolWithPot();
-    bool playing;
+    Player(const uint8_t max, uint8_t volume, uint8_t RX_pin, uint8_t TX_pin, uint8_t pot_pin, bool vol_pot_exist, const uint8_t commandDelay)
+        : PlayerVoice<Backend>(max, volume, RX_pin, TX_pin, commandDelay)
+    {
+    }
+
+    void defineVolumePot(uint8_t pin, bool active)
+    {
+        if (active)
+        {
+            _pot.begin(pin, this->_VOLUME_MAX);
+        }
+    }
+
+    uint8_t setVolWithPotatStart()
+    {
+        if (_pot.isActive())
+        {
+            this->_setVolume(_pot.getLevel());
+        }
+        return this->_volume;
+    }
+
+    // Volume command is only sent when the filtered pot level changed
+    uint8_t setVolWithPot()
+    {
+        if (_pot.update())
+        {
+            this->_setVolume(_pot.getLevel());
+        }
+        return this->_volume;
+    }
 
 private:
-    DFRobotDFPlayerMini _player;
-    unsigned long _startTime;
-    unsigned long _startTimePrev;
+    VolumePot _pot;
+};
+
+/////////////////////////////////////////////////////
+/*                                                 */
+/************ Dual player front-end ****************/
+/*                                                 */
+/////////////////////////////////////////////////////
+/*  Two players of the same type used as voices : the loop voice holds the looping tracks (idle hum, themes), */
+/*  the sound FX voice plays the one-shot and inserted tracks over it. Same interface as Player<>, plus update(). */
+/*  Each voice has its own small command queue, drained in update() respecting the command delay of that player, */
+/*  so commands to both voices can be given at the same time. Volume is balanced with a gain for each voice. */
+#define VOICE_LOOP 0
+#define VOICE_SFX 1
+#define VOICE_QUEUE_SIZE 4
+
+template <class Backend>
+class DualPlayer
+{
+public:
+    DualPlayer(const uint8_t max, uint8_t volume, uint8_t RX_pin, uint8_t TX_pin, uint8_t sfx_RX_pin, uint8_t sfx_TX_pin, uint8_t pot_pin, bool vol_pot_exist, const uint8_t commandDelay, uint8_t loopGain, uint8_t sfxGain)
+        : _loopVoice(max, (uint16_t)volume * loopGain / 100, RX_pin, TX_pin, commandDelay),
+          _sfxVoice(max, (uint16_t)volume * sfxGain / 100, sfx_RX_pin, sfx_TX_pin, commandDelay),
+          _VOLUME_MAX(min(30, max)), _COMMAND_DELAY(commandDelay), _volume(volume)
+    {
+        _gain[VOICE_LOOP] = min(100, loopGain);
+        _gain[VOICE_SFX] = min(100, sfxGain);
+        for (uint8_t v = 0; v < 2; v++)
+        {
+            _head[v] = 0;
+            _count[v] = 0;
+            _lastCommand[v] = 0;
+        }
+    }
+
+    bool begin(Stream &loopStream, Stream &sfxStream)
+    {
+        bool loopReady = _loopVoice.begin(loopStream);
+        bool sfxReady = _sfxVoice.begin(sfxStream);
+        return loopReady && sfxReady;
+    }
+
+    void update()
+    {
+        _drain(VOICE_LOOP);
+        _drain(VOICE_SFX);
+    }
+
+    // One-shot tracks are on the sound FX voice, a queued track is already playing for the pack states
+    bool isPlaying()
+    {
+        return _sfxVoice.isPlaying() || _count[VOICE_SFX] > 0;
+    }
+
+    void setThemesPlaymode()
+    {
+        _push(VOICE_SFX, _STOP, 0, 0);
+        _push(VOICE_LOOP, _THEMES, 0, 0);
+    }
+
+    void setSinglePlaymode()
+    {
+        _push(VOICE_LOOP, _SINGLE, 0, 0);
+    }
+
+    void setCyclingTrackPlaymode()
+    {
+        _push(VOICE_LOOP, _CYCLING, 0, 0);
+    }
+
+    void loopFileNum(int16_t track_num)
+    {
+        _push(VOICE_LOOP, _LOOP, track_num, 0);
+    }
+
+    // Track replacing the looping one
+    void playFileNum(int16_t track_num, uint16_t track_length)
+    {
+        _push(VOICE_LOOP, _STOP, 0, 0);
+        _push(VOICE_SFX, _PLAY, track_num, track_length);
+    }
+
+    // Track layered over the looping one
+    void insertFileNum(int16_t track_num, uint16_t track_length)
+    {
+        _push(VOICE_SFX, _PLAY, track_num, track_length);
+    }
+
+    void stopInsert()
+    {
+        _push(VOICE_SFX, _STOP, 0, 0);
+    }
+
+    void stop()
+    {
+        _push(VOICE_LOOP, _STOP, 0, 0);
+        _push(VOICE_SFX, _STOP, 0, 0);
+    }
+
+    void pause()
+    {
+        _push(VOICE_LOOP, _PAUSE, 0, 0);
+        _push(VOICE_SFX, _PAUSE, 0, 0);
+    }
+
+    void next()
+    {
+        _push(VOICE_LOOP, _NEXT, 0, 0);
+    }
+
+    void previous()
+    {
+        _push(VOICE_LOOP, _PREVIOUS, 0, 0);
+    }
+
+    void setVol(uint8_t volume)
+    {
+        _volume = min(volume, _VOLUME_MAX);
+        _push(VOICE_LOOP, _VOLUME, (uint16_t)_volume * _gain[VOICE_LOOP] / 100, 0);
+        _push(VOICE_SFX, _VOLUME, (uint16_t)_volume * _gain[VOICE_SFX] / 100, 0);
+    }
+
+    void defineVolumePot(uint8_t pin, bool active)
+    {
+        if (active)
+        {
+            _pot.begin(pin, _VOLUME_MAX);
+        }
+    }
+
+    uint8_t setVolWithPotatStart()
+    {
+        if (_pot.isActive())
+        {
+            _setVolume(_pot.getLevel());
+        }
+        return _volume;
+    }
+
+    // Volume command is only sent when the filtered pot level changed
+    uint8_t setVolWithPot()
+    {
+        if (_pot.update())
+        {
+            _setVolume(_pot.getLevel());
+        }
+        return _volume;
+    }
+
+private:
+    enum
+    {
+        _PLAY,
+        _LOOP,
+        _STOP,
+        _PAUSE,
+        _NEXT,
+        _PREVIOUS,
+        _VOLUME,
+        _THEMES,
+        _SINGLE,
+        _CYCLING
+    };
+    struct _Command
+    {
+        uint8_t cmd;
+        int16_t value; // track number or volume
+        uint16_t length;
+    };
+
+    void _setVolume(uint8_t newVolume)
+    {
+        if (newVolume != _volume)
+        {
+            setVol(newVolume);
+        }
+    }
+
+    static bool _isPlayback(uint8_t cmd)
+    {
+        return cmd == _PLAY || cmd == _LOOP || cmd == _STOP || cmd == _THEMES;
+    }
+
+    void _push(uint8_t v, uint8_t cmd, int16_t value, uint16_t length)
+    {
+        _Command command = {cmd, value, length};
+        if (_count[v] > 0)
+        {
+            // A newer playback or volume command supersedes the same kind of command still waiting
+            _Command &last = _queue[v][(_head[v] + _count[v] - 1) % VOICE_QUEUE_SIZE];
+            if ((_isPlayback(cmd) && _isPlayback(last.cmd)) || (cmd == _VOLUME && last.cmd == _VOLUME))
+            {
+                last = command;
+                return;
+            }
+        }
+        if (_count[v] >= VOICE_QUEUE_SIZE) // Queue full : oldest command is dropped
+        {
+            _head[v] = (_head[v] + 1) % VOICE_QUEUE_SIZE;
+            _count[v]--;
+        }
+        _queue[v][(_head[v] + _count[v]) % VOICE_QUEUE_SIZE] = command;
+        _count[v]++;
+        _drain(v); // send it right away if this voice is ready
+    }
+
+    void _drain(uint8_t v)
+    {
+        if (_count[v] == 0 || millis() - _lastCommand[v] < _COMMAND_DELAY)
+        {
+            return;
+        }
+        _Command command = _queue[v][_head[v]];
+        _head[v] = (_head[v] + 1) % VOICE_QUEUE_SIZE;
+        _count[v]--;
+        _lastCommand[v] = millis();
+
+        PlayerVoice<Backend> &voice = (v == VOICE_LOOP) ? _loopVoice : _sfxVoice;
+        switch (command.cmd)
+        {
+        case _PLAY:
+            voice.playFileNum(command.value, command.length);
+            break;
+        case _LOOP:
+            voice.loopFileNum(command.value);
+            break;
+        case _STOP:
+            voice.stop();
+            break;
+        case _PAUSE:
+            voice.pause();
+            break;
+        case _NEXT:
+            voice.next();
+            break;
+        case _PREVIOUS:
+            voice.previous();
+            break;
+        case _VOLUME:
+            voice.setVol(command.value);
+            break;
+        case _THEMES:
+            voice.setThemesPlaymode();
+            break;
+        case _SINGLE:
+            voice.setSinglePlaymode();
+            break;
+        case _CYCLING:
+            voice.setCyclingTrackPlaymode();
+            break;
+        }
+    }
+
+    PlayerVoice<Backend> _loopVoice;
+    PlayerVoice<Backend> _sfxVoice;
     const uint8_t _VOLUME_MAX;
     const uint8_t _COMMAND_DELAY;
     uint8_t _volume;
-    uint8_t _prevVolume;
-    uint8_t _RX_pin;
-    uint8_t _TX_pin;
-    uint8_t _pot_pin;
-    bool _volPotActive;
-    unsigned long _TrackDuration;
-    uint8_t _AUDIO_ADVANCE;
+    VolumePot _pot;
+    uint8_t _gain[2];
+    _Command _queue[2][VOICE_QUEUE_SIZE];
+    uint8_t _head[2];
+    uint8_t _count[2];
+    unsigned long _lastCommand[2];
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -36,11 +36,7 @@ Powercell::Powercell(Adafruit_NeoPixel &strip, bool direction, uint8_t start, ui
 {
     _prevTime = 0;
     _numLeds = (_end - _start + 1);
-    _ledState = new uint8_t *[_numLeds];
-    for (int i = 0; i < _numLeds; i++)
-    {
-        _ledState[i] = new uint8_t[3];
-    }
+    _ledLevel = new uint8_t[_numLeds]; // 1 byte per pixel, expanded to RGB by update()
     bootState = false;
     _levelTracker = 0;
     _shutdownTracker = _numLeds - 1;
@@ -48,11 +44,7 @@ Powercell::Powercell(Adafruit_NeoPixel &strip, bool direction, uint8_t start, ui
 
 Powercell::~Powercell()
 {
-    for (int i = 0; i < _numLeds; ++i)
-    {
-        delete[] _ledState[i]; // Free memory for each row
-    }
-    delete[] _ledState;
+    delete[] _ledLevel;
 }
 
 void Powercell::begin() { clear(); }
@@ -76,34 +68,34 @@ void Powercell::update()
         {
             j = _end - i;
         }
-        // set segments according to mapping define in setting
-        _strip.setPixelColor((j), _ledState[i][0], _ledState[i][1], _ledState[i][2]);
+        // set segments according to mapping define in setting, powercell is blue only
+        _strip.setPixelColor((j), 0, 0, _ledLevel[i]);
     }
 }
 
 void Powercell::clear()
 {
-    _setColorAll(0, 0, 0);
+    _setLevelAll(0);
     bootState = false;
     _levelTracker = 0;
     _shutdownTracker = _numLeds - 1;
 }
 
-void Powercell::poweredDown()
+void Powercell::poweredDown(unsigned long now)
 // All bar graph pixels are OFF execpt pixels one blinking
 {
     // Powercell 1st pixel blinking
     static bool flash = false;
     if (PC_PWD_FLASH) // Blinking is enable
     {
-        if (!flash && (millis() - _prevTime > PC_PWD_FLASH_OFF))
+        if (!flash && (now - _prevTime > PC_PWD_FLASH_OFF))
         {
-            _prevTime = millis();
+            _prevTime = now;
             flash = true;
         }
-        if (flash && (millis() - _prevTime > PC_PWD_FLASH_ON))
+        if (flash && (now - _prevTime > PC_PWD_FLASH_ON))
         {
-            _prevTime = millis();
+            _prevTime = now;
             flash = false;
         }
     }
@@ -116,18 +108,18 @@ void Powercell::poweredDown()
     {
         if (i == 0 && flash)
         {
-            _setColor(i, 0, 0, PC_BRIGHTNESS);
+            _setLevel(i, PC_BRIGHTNESS);
         }
         else
         {
-            _setColor(i, 0, 0, 0);
+            _setLevel(i, 0);
         }
     }
     _levelTracker = 0;
     _shutdownTracker = _numLeds - 1;
 }
 
-void Powercell::boot(int16_t bootTime, bool init)
+void Powercell::boot(int16_t bootTime, bool init, unsigned long now)
 { // Pixels drop down powercell and pile up!
 
     // trackers
@@ -149,12 +141,12 @@ void Powercell::boot(int16_t bootTime, bool init)
 
     if (!bootState)
     {
-        if (millis() - _prevTime >= _updateSp)
+        if (now - _prevTime >= _updateSp)
         {
             // Boot sequence not done
             {
                 //_prevTime += bootSp;
-                _prevTime = millis();
+                _prevTime = now;
 
                 if (_levelTracker < _numLeds)
                 {
@@ -162,11 +154,11 @@ void Powercell::boot(int16_t bootTime, bool init)
                     {
                         if (i < _levelTracker || i == bootTracker)
                         {
-                            _setColor(i, 0, 0, PC_BRIGHTNESS);
+                            _setLevel(i, PC_BRIGHTNESS);
                         }
                         else
                         {
-                            _setColor(i, 0, 0, 0);
+                            _setLevel(i, 0);
                         }
                     }
                     bootTracker--;
@@ -178,7 +170,7 @@ void Powercell::boot(int16_t bootTime, bool init)
                 }
                 else
                 {
-                    _setColorAll(0, 0, PC_BRIGHTNESS);
+                    _setLevelAll(PC_BRIGHTNESS);
                     _levelTracker = 0;
                     bootTracker = _numLeds;
                     bootState = true;
@@ -190,29 +182,29 @@ void Powercell::boot(int16_t bootTime, bool init)
     // Sequence done,
     {
         _updateSp = PC_IDLE1_UPDATE_SP;
-        _idleOne(_updateSp);
+        _idleOne(_updateSp, now);
     }
 }
 
-void Powercell::rampToIdleOne(uint16_t ramp_time, bool init)
+void Powercell::rampToIdleOne(uint16_t ramp_time, bool init, unsigned long now)
 {
-    _rampPowercell(ramp_time, init, PC_IDLE1_UPDATE_SP);
-    _idleOne(_updateSp);
+    _rampPowercell(ramp_time, init, PC_IDLE1_UPDATE_SP, now);
+    _idleOne(_updateSp, now);
 }
 
-void Powercell::rampToIdleTwo(uint16_t ramp_time, bool init)
+void Powercell::rampToIdleTwo(uint16_t ramp_time, bool init, unsigned long now)
 {
-    _rampPowercell(ramp_time, init, PC_IDLE2_UPDATE_SP);
-    _idleTwo(_updateSp);
+    _rampPowercell(ramp_time, init, PC_IDLE2_UPDATE_SP, now);
+    _idleTwo(_updateSp, now);
 }
 
-void Powercell::rampToFiring(uint16_t ramp_time, bool init)
+void Powercell::rampToFiring(uint16_t ramp_time, bool init, unsigned long now)
 {
-    _rampPowercell(ramp_time, init, PC_FIRE_UPDATE_SP);
-    _idleOne(_updateSp);
+    _rampPowercell(ramp_time, init, PC_FIRE_UPDATE_SP, now);
+    _idleOne(_updateSp, now);
 }
 
-void Powercell::shuttingDown(int16_t shutdownTime, bool init)
+void Powercell::shuttingDown(int16_t shutdownTime, bool init, unsigned long now)
 {
 
     // trackers
@@ -234,11 +226,11 @@ void Powercell::shuttingDown(int16_t shutdownTime, bool init)
 
     if (bootState)
     {
-        if (millis() - _prevTime >= _updateSp)
+        if (now - _prevTime >= _updateSp)
         {
             {
                 //_prevTime += _updateSp;
-                _prevTime = millis();
+                _prevTime = now;
 
                 if (_levelTracker >= 0)
                 {
@@ -246,11 +238,11 @@ void Powercell::shuttingDown(int16_t shutdownTime, bool init)
                     {
                         if (i < _levelTracker || i == shutdownTracker)
                         {
-                            _setColor(i, 0, 0, PC_BRIGHTNESS);
+                            _setLevel(i, PC_BRIGHTNESS);
                         }
                         else
                         {
-                            _setColor(i, 0, 0, 0);
+                            _setLevel(i, 0);
                         }
                     }
                     shutdownTracker++;
@@ -262,7 +254,7 @@ void Powercell::shuttingDown(int16_t shutdownTime, bool init)
                 }
                 else
                 {
-                    _setColorAll(0, 0, 0);
+                    _setLevelAll(0);
                     _levelTracker = 0;
                     shutdownTracker = 0;
                     bootState = false;
@@ -273,25 +265,25 @@ void Powercell::shuttingDown(int16_t shutdownTime, bool init)
     else
     // Sequence done,
     {
-        poweredDown();
+        poweredDown(now);
     }
 }
 
-void Powercell::_idleOne(int16_t idle1Sp)
+void Powercell::_idleOne(int16_t idle1Sp, unsigned long now)
 { // bar graph ramp up
-    if (millis() - _prevTime >= idle1Sp)
+    if (now - _prevTime >= idle1Sp)
     {
-        _prevTime = millis();
+        _prevTime = now;
 
         for (int8_t i = 0; i < _numLeds; i++)
         {
             if (i < _levelTracker)
             {
-                _setColor(i, 0, 0, PC_BRIGHTNESS);
+                _setLevel(i, PC_BRIGHTNESS);
             }
             else
             {
-                _setColor(i, 0, 0, 0);
+                _setLevel(i, 0);
             }
         }
         if (_levelTracker < _numLeds)
@@ -305,17 +297,17 @@ void Powercell::_idleOne(int16_t idle1Sp)
     }
 }
 
-void Powercell::_idleTwo(int16_t idle2Sp)
+void Powercell::_idleTwo(int16_t idle2Sp, unsigned long now)
 {
-    _idleOne(idle2Sp);
+    _idleOne(idle2Sp, now);
 }
 
-void Powercell::_firing(int16_t firingSp)
+void Powercell::_firing(int16_t firingSp, unsigned long now)
 {
-    _idleOne(firingSp);
+    _idleOne(firingSp, now);
 }
 
-void Powercell::_rampPowercell(int16_t rampTime, bool init, int16_t tg_speed)
+void Powercell::_rampPowercell(int16_t rampTime, bool init, int16_t tg_speed, unsigned long now)
 {
     // trackers
     static int16_t iniUpSp;
@@ -335,9 +327,9 @@ void Powercell::_rampPowercell(int16_t rampTime, bool init, int16_t tg_speed)
     }
 
     // Ramp UPDATE SPEED
-    if (millis() - prevRampUpdate >= int_updateSp)
+    if (now - prevRampUpdate >= int_updateSp)
     {
-        prevRampUpdate = millis();
+        prevRampUpdate = now;
         _updateSp = _ramp_parameter(_updateSp, iniUpSp, tg_speed, incr_updateSp);
     }
 }
@@ -373,19 +365,15 @@ int16_t Powercell::_ramp_parameter(int16_t param, int16_t ini, int16_t tg, int16
     return param;
 }
 
-void Powercell::_setColorAll(uint8_t red, uint8_t green, uint8_t blue)
+void Powercell::_setLevelAll(uint8_t level)
 {
     for (uint16_t i = 0; i < _numLeds; i++)
     {
-        _ledState[i][0] = red;
-        _ledState[i][1] = green;
-        _ledState[i][2] = blue;
+        _ledLevel[i] = level;
     }
 }
 
-void Powercell::_setColor(uint16_t pixel, uint8_t red, uint8_t green, uint8_t blue)
+void Powercell::_setLevel(uint16_t pixel, uint8_t level)
 {
-    _ledState[pixel][0] = red;
-    _ledState[pixel][1] = green;
-    _ledState[pixel][2] = blue;
+    _ledLevel[pixel] = level;
 }
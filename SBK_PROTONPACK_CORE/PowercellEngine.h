@@ -31,30 +31,30 @@ public:
     void setDirection(bool direction);
     void update();
     void clear();
-    void poweredDown();
-    void boot(int16_t bootTime, bool init);
-    void rampToIdleOne(uint16_t ramp_time, bool init);
-    void rampToIdleTwo(uint16_t ramp_time, bool init);
-    void rampToFiring(uint16_t ramp_time, bool init);
-    void shuttingDown(int16_t shutdownTime, bool init);
+    void poweredDown(unsigned long now);
+    void boot(int16_t bootTime, bool init, unsigned long now);
+    void rampToIdleOne(uint16_t ramp_time, bool init, unsigned long now);
+    void rampToIdleTwo(uint16_t ramp_time, bool init, unsigned long now);
+    void rampToFiring(uint16_t ramp_time, bool init, unsigned long now);
+    void shuttingDown(int16_t shutdownTime, bool init, unsigned long now);
     bool bootState;
 
 private:
-    void _idleOne(int16_t updateSp);
-    void _idleTwo(int16_t updateSp);
-    void _firing(int16_t updateSp);
-    void _rampPowercell(int16_t rampTime, bool init, int16_t tg_speed);
+    void _idleOne(int16_t updateSp, unsigned long now);
+    void _idleTwo(int16_t updateSp, unsigned long now);
+    void _firing(int16_t updateSp, unsigned long now);
+    void _rampPowercell(int16_t rampTime, bool init, int16_t tg_speed, unsigned long now);
     int16_t _ramp_parameter(int16_t param, int16_t ini, int16_t tg, int16_t incr);
     void _idlePowercell(int16_t updateSp);
-    void _setColorAll(uint8_t red, uint8_t green, uint8_t blue);
-    void _setColor(uint16_t pixel, uint8_t red, uint8_t green, uint8_t blue);
+    void _setLevelAll(uint8_t level);
+    void _setLevel(uint16_t pixel, uint8_t level);
     Adafruit_NeoPixel &_strip;
     bool _direction;
     uint8_t _start;
     uint8_t _end;
     unsigned long _prevTime;
     uint8_t _numLeds;
-    uint8_t** _ledState;
+    uint8_t* _ledLevel;
     int8_t _levelTracker;
     int8_t _shutdownTracker;
     int16_t _updateSp;
@@ -19,23 +19,15 @@
 #include "RodEngine.h"
 
 FiringRod::FiringRod(Adafruit_NeoPixel &strip, uint8_t start, uint8_t end)
-    : _strip(strip), _start(start), _end(end)
+    : _strip(strip), _start(start), _end(end), _random(0xACE1), _redNoise(0x35), _blueNoise(0xB7)
 {
     _numLeds = end - start + 1;
-    _ledState = new uint8_t *[_numLeds];
-    for (int i = 0; i < _numLeds; i++)
-    {
-        _ledState[i] = new uint8_t[3];
-    }
-    _prevUpdate = 0;
+    _ledState = new uint8_t[_numLeds * 3]; // RGB, one allocation for all pixels
+    _noisePhase = 0;
 }
 
 FiringRod::~FiringRod()
 {
-    for (int i = 0; i < _numLeds; i++)
-    {
-        delete[] _ledState[i];
-    }
     delete[] _ledState;
 }
 
@@ -48,7 +40,7 @@ void FiringRod::update()
 {
     for (uint8_t i = 0; i < _numLeds; i++)
     {
-        _strip.setPixelColor(_start + i, _ledState[i][0], _ledState[i][1], _ledState[i][2]);
+        _strip.setPixelColor(_start + i, _ledState[i * 3], _ledState[i * 3 + 1], _ledState[i * 3 + 2]);
     }
 }
 
@@ -57,81 +49,64 @@ void FiringRod::clear()
     _setColorAll(0, 0, 0);
 }
 
-void FiringRod::fireStrobe(uint8_t updateInterval)
+void FiringRod::fireStrobe(uint8_t updateInterval, unsigned long now)
 {
-    if (millis() - _prevUpdate > updateInterval)
+    uint8_t steps = _step.steps(now, updateInterval);
+    if (steps > 0)
     {
-        _prevUpdate += updateInterval;
-        /* for (uint8_t i = 0; i <= _numLeds; i++)
+        // All pixels each update : red and blue noise fields drifting in opposite directions along the tip,
+        // green where both are high, for a plasma look. Late steps only move the fields, drawn once.
+        _noisePhase += ROD_NOISE_SPEED * steps;
+        uint16_t x = 0;
+        for (uint8_t i = 0; i < _numLeds; i++, x += ROD_NOISE_SPACING)
         {
-            _ledState[i][0] = random(50, 255);
-            _ledState[i][1] = random(0, 50);
-            _ledState[i][2] = random(50, 255);
-        } */
-        uint8_t i = random(0, _numLeds);
-        _ledState[i][0] = random(50, 255);
-        _ledState[i][1] = random(0, 50);
-        _ledState[i][2] = random(50, 255);
+            uint8_t red = _redNoise.at(x + _noisePhase);
+            uint8_t blue = _blueNoise.at(x - _noisePhase);
+            _setColor(i, 50 + ValueNoise::scale(red, 205), ValueNoise::scale(ValueNoise::scale(red, blue), 50), 50 + ValueNoise::scale(blue, 205));
+        }
+        // Lightning : sometimes one random pixel flashes
+        if (_random.next8() < ROD_LIGHTNING_CHANCE)
+        {
+            _setColor(ValueNoise::scale(_random.next8(), _numLeds), 255, 200, 255);
+        }
     }
 }
 
 void FiringRod::_setColorAll(uint8_t red, uint8_t green, uint8_t blue)
 {
-    for (uint16_t i = 0; i <= _numLeds; i++)
+    for (uint16_t i = 0; i < _numLeds; i++)
     {
-        _ledState[i][0] = red;
-        _ledState[i][1] = green;
-        _ledState[i][2] = blue;
+        _setColor(i, red, green, blue);
     }
 }
 
 void FiringRod::_setColor(uint16_t pixel, uint8_t red, uint8_t green, uint8_t blue)
 {
-    _ledState[pixel][0] = red;
-    _ledState[pixel][1] = green;
-    _ledState[pixel][2] = blue;
+    uint8_t *p = &_ledState[pixel * 3];
+    p[0] = red;
+    p[1] = green;
+    p[2] = blue;
 }
 
-void FiringRod::tail(uint16_t fadeOutTime)
+void FiringRod::tail(uint16_t fadeOutTime, unsigned long now)
 {
-    static unsigned long prev = 0;
     uint8_t increment = 3;
     uint16_t interval = (int32_t)fadeOutTime * (int32_t)increment / 255;
-    if (millis() - prev > interval)
+    uint8_t steps = _step.steps(now, interval);
+    if (steps > 0)
     {
-        prev += interval;
-        for (uint8_t i = 0; i < _numLeds; i++)
+        increment *= steps; // late steps faded in the same pass, at most TIMESTEP_MAX_CATCHUP * 3
+        // Contiguous RGB buffer : fade all colors of all pixels in one pass
+        for (uint16_t i = 0; i < _numLeds * 3; i++)
         {
-            uint8_t red = _ledState[i][0];
-            uint8_t green = _ledState[i][1];
-            uint8_t blue = _ledState[i][2];
-            if (red > increment)
-            {
-                red -= increment;
-            }
-            else
-            {
-                red = 0;
-            }
-            if (green > increment)
-            {
-                green -= increment;
-            }
-            else
-            {
-                green = 0;
-            }
-            if (blue > increment)
+            if (_ledState[i] > increment)
             {
-                blue -= increment;
+                _ledState[i] -= increment;
             }
             else
             {
-                blue = 0;
+                _ledState[i] = 0;
             }
-            _ledState[i][0] = red;
-            _ledState[i][1] = green;
-            _ledState[i][2] = blue;
         }
     }
 }
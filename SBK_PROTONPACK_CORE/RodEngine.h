@@ -21,6 +21,13 @@
 
 #include "Arduino.h"
 #include <Adafruit_NeoPixel.h>
+#include "NoiseEngine.h"
+#include "TimestepEngine.h"
+
+// Firing strobe noise fields, in 8.8 fixed point positions : one random value every 256
+#define ROD_NOISE_SPEED 56      // fields move by each strobe update
+#define ROD_NOISE_SPACING 90    // between two tip pixels
+#define ROD_LIGHTNING_CHANCE 24 // out of 256 each strobe update, one pixel flashes
 
 class FiringRod
 {
@@ -30,8 +37,8 @@ public:
     void begin();
     void update();
     void clear();
-    void fireStrobe(uint8_t updateInterval);
-    void tail(uint16_t fadeOutTime);
+    void fireStrobe(uint8_t updateInterval, unsigned long now);
+    void tail(uint16_t fadeOutTime, unsigned long now);
 
 private:
     void _setColorAll(uint8_t red, uint8_t green, uint8_t blue);
@@ -40,8 +47,12 @@ private:
     uint8_t _start;
     uint8_t _end;
     uint8_t _numLeds;
-    uint8_t** _ledState;
-    unsigned long _prevUpdate;
+    uint8_t* _ledState;
+    Timestep _step;
+    Xorshift16 _random;
+    ValueNoise _redNoise;
+    ValueNoise _blueNoise;
+    uint16_t _noisePhase;
 };
 
 #endif
\ No newline at end of file
@@ -36,7 +36,7 @@ void Rumbler::begin()
     if (_exist)
     {
         pinMode(_pin, OUTPUT);
-        rumbleOFF();
+        rumbleOFF(millis());
     }
     else
     {
@@ -44,60 +44,60 @@ void Rumbler::begin()
     }
 }
 
-void Rumbler::update()
+void Rumbler::update(unsigned long now)
 {
     if (_exist)
     {
         if (_state)
         {
-            if ((_burstDuration > 0) && ((millis() - _prevStart) >= _burstDuration))
+            if ((_burstDuration > 0) && ((now - _prevStart) >= _burstDuration))
             {
                 _burstDuration = 0;
-                rumbleOFF();
+                rumbleOFF(now);
             }
 
-            if (millis() - _prevStart >= *_ptr_MAX_ON_TIME)
+            if (now - _prevStart >= *_ptr_MAX_ON_TIME)
             {
                 _burstDuration = 0;
-                rumbleOFF();
+                rumbleOFF(now);
             }
         }
     }
 }
 
-void Rumbler::startBurst(uint16_t duration)
+void Rumbler::startBurst(uint16_t duration, unsigned long now)
 {
     if (_exist)
     {
         if (!_state)
         {
             _burstDuration = duration;
-            rumbleON();
+            rumbleON(now);
         }
     }
 }
 
-void Rumbler::rumbleON()
+void Rumbler::rumbleON(unsigned long now)
 {
     if (_exist)
     {
-        if (!_state && ((millis() - _prevStop) >= *_ptr_MIN_OFF_TIME))
+        if (!_state && ((now - _prevStop) >= *_ptr_MIN_OFF_TIME))
         {
             digitalWrite(_pin, HIGH);
-            _prevStart = millis();
+            _prevStart = now;
             _state = true;
         }
     }
 }
 
-void Rumbler::rumbleOFF()
+void Rumbler::rumbleOFF(unsigned long now)
 {
     if (_exist)
     {
         if (_state)
         {
             digitalWrite(_pin, LOW);
-            _prevStop = millis();
+            _prevStop = now;
             _state = false;
         }
     }
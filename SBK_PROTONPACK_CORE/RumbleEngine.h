@@ -29,11 +29,11 @@ public:
             const uint32_t *minOffTime,
             bool exist);
     void begin();
-    void update();
-    void startBurst(uint16_t duration);
+    void update(unsigned long now);
+    void startBurst(uint16_t duration, unsigned long now);
     bool getState();
-    void rumbleON();
-    void rumbleOFF();
+    void rumbleON(unsigned long now);
+    void rumbleOFF(unsigned long now);
 
 private:
     bool _exist;
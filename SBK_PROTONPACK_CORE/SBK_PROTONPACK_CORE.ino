@@ -69,7 +69,7 @@
  *    file is the main file containing the setup and main code loops.
  *
  *    In your sketch folder, you should place SBK_PROTONPACK_CORE.ino file and all *.h files, and *.ccp files :
- *    ACONFIG.h, PlayerEngine.h, PlayerEngine.cpp, BarGraphEngine.h, BarGraphEngine.cpp, etc.
+ *    ACONFIG.h, PlayerEngine.h, PlayerBackend_DFPlayerMini_Fast.h, BarGraphEngine.h, BarGraphEngine.cpp, etc.
  *
  *    The ACONFIG.h file contains all the definitions and options : pins, player module, LEDs index,
  *    audio tracks, etc. This is the file you want to customize to adjust your pins setting, LEDs chain and index,
@@ -120,6 +120,7 @@ uint8_t prevPackState = 0;                                      // State trackin
 uint8_t stageFlag = 0;                                          // stage flag to implement different state stages in main loop
 uint8_t prevStageFlag = 0;                                      // stage flag tracking
 unsigned long stateStartTime = 0;                               // general time tracker for functions timers and delays
+unsigned long frameTime = 0;                                    // millis() read once at each loop start, passed to all engines
 void clearAllLights();                                          // SHUTOFF all leds for wand and pack and resets some trackers
 bool checkIfTrackDoneExit(uint8_t track, uint8_t next_state);   // check if a state track is done playing and go to next stage
 bool checkIfSwitchExit(bool switch_state, uint8_t next_state);  // check if a switch action and go to next stage
@@ -127,6 +128,9 @@ bool checkIfTimerExit(uint16_t time, uint8_t next_state);       // check if a ti
 void getLEDsSchemeForThisState(uint8_t state);                  // to help manage the animations
 void playThisStateTrack(uint8_t track, bool looping);           // play state track if themes switch is OFF
 void checkPlayModeForThisState(bool looping);                   // check if play mode is correct for this state (looping / not looping)
+uint16_t trackLength(uint8_t track);                            // track length, read from TRACK_LENGTH[] in flash
+bool trackLooping(uint8_t track);                               // track looping bit from TRACK_LOOPING
+uint8_t trackMode(uint8_t track);                               // track mode, read from TRACK_MODE[] in flash
 const bool NOLOOP = false;                                      // helper for audio track looping
 const bool LOOP = true;                                         // helper for audio track looping
 unsigned long prevLedsUpdate = 0;                               // helper to limit leds update rating (slowing MCU and make Player misses some commands)
@@ -150,6 +154,7 @@ MAX72xxDriver bargraph(BARGRAPH_TOTAL_LEDS, BG_DIRECTION, BG_DIN, BG_CLK, BG_LOA
 #include "SBK_HT16K33.h"
 HT16K33Driver bargraph(BARGRAPH_TOTAL_LEDS, BG_DIRECTION, BG_DIN, BG_CLK, BG_ADDRESS);
 #endif
+static_assert(BARGRAPH_TOTAL_LEDS <= BG_MASK_BITS, "Too many bar graph segments for BarGraphMask, see BarGraphEngine.h");
 
 /***********************************************/
 /*                WS2812 LEDs                  */
@@ -166,6 +171,11 @@ Adafruit_NeoPixel packLeds = Adafruit_NeoPixel(PACK_TOTAL_LEDS_NUMBER, PK_LEDS,
 /***********************************************/
 #include "VentEngine.h"
 Vent packVent(packLeds, VENT_1ST_LED, VENT_LAST_LED);
+#ifdef VENT_KEYFRAMES
+#include "KeyframeEngine.h"
+#include "KeyframeAnimations.h"
+Keyframes packVentKeyframes(packLeds, VENT_1ST_LED, VENT_LAST_LED);
+#endif
 /***********************************************/
 /*               POWERCELL LEDs                */
 /***********************************************/
@@ -175,27 +185,54 @@ Powercell powercell(packLeds, POWERCELL_DIRECTION, POWERCELL_1ST_LED, POWERCELL_
 /*               CYCLOTRON LEDs                */
 /***********************************************/
 #include "CyclotronEngine.h"
+#ifdef CYC_STYLE_SWITCH
+#define CYC_STYLE(style) CyclotronSwitchable<style>  // both styles behind the Cyclotron interface
+typedef Cyclotron CyclotronStyle;
+#elif defined(GB12)
+#define CYC_STYLE(style) style  // one style, direct calls
+typedef Cyclotron_GB1_GB2 CyclotronStyle;
+#else
+#define CYC_STYLE(style) style
+typedef Cyclotron_AF_FE CyclotronStyle;
+#endif
 /*****************************/
 /* >>>>> GB1/GB2 style <<<<< */
 /*****************************/
-#ifdef GB12
-Cyclotron_GB1_GB2 cyclotron(packLeds, CYCLOTRON_DIRECTION,
-                            CYC_POS1_1ST_LED, CYC_POS1_LAST_LED,
-                            CYC_POS2_1ST_LED, CYC_POS2_LAST_LED,
-                            CYC_POS3_1ST_LED, CYC_POS3_LAST_LED,
-                            CYC_POS4_1ST_LED, CYC_POS4_LAST_LED);
+#if defined(GB12) || defined(CYC_STYLE_SWITCH)
+CYC_STYLE(Cyclotron_GB1_GB2) cyclotronGB12(packLeds, CYCLOTRON_DIRECTION, CYC_POSITIONS, sizeof(CYC_POSITIONS) / sizeof(CYC_POSITIONS[0]));
 #endif
 /***************************/
 /* >>>>> AF/FE style <<<<< */
 /***************************/
-#ifdef AFFE
-Cyclotron_AF_FE cyclotron(packLeds, CYCLOTRON_DIRECTION, CYC_RING_1ST_LED, CYC_RING_LAST_LED);
+#if defined(AFFE) || defined(CYC_STYLE_SWITCH)
+CYC_STYLE(Cyclotron_AF_FE) cyclotronAFFE(packLeds, CYCLOTRON_DIRECTION, CYC_RING_1ST_LED, CYC_RING_LAST_LED);
+#endif
+/*****************************/
+/* >>>>> Active style <<<<<< */
+/*****************************/
+#ifdef GB12
+CyclotronStyle *cyclotron = &cyclotronGB12;  // default style
+#else
+CyclotronStyle *cyclotron = &cyclotronAFFE;  // default style
+#endif
+#ifdef CYC_STYLE_SWITCH
+#include <EEPROM.h>
+#define CYC_STYLE_GB12 0xA0          // EEPROM values, anything else (erased EEPROM) is the default style
+#define CYC_STYLE_AFFE 0xA1
+uint8_t *cyclotronBuffer = nullptr;  // one buffer for both styles, the bigger bufferSize()
+void beginCyclotronStyle();          // read the style saved in EEPROM and begin it in the shared buffer
+void checkCyclotronStyleSwitch();    // switch and save the style with the fire and rod buttons held
 #endif
 
 /*********************************************/
 /*          WAND WS2812 leds chain           */
 /*********************************************/
 Adafruit_NeoPixel wandLeds = Adafruit_NeoPixel(WAND_TOTAL_LEDS_NUMBER, WD_LEDS, NEO_GRB + NEO_KHZ800);
+/*********************************************/
+/*    PACK & WAND chains output in one pass   */
+/*********************************************/
+#include "WS2812OutputEngine.h"
+WS2812Output ledsOutput(packLeds, wandLeds);  // both chains at once if their pins are on the same port
 /***********************************************/
 /*             WAND LEDS INDEX                 */
 /***********************************************/
@@ -209,6 +246,14 @@ Indicator topYellowIndicator(wandLeds, WAND_LED_TOP_YELLOW);
 Indicator topWhiteIndicator(wandLeds, WAND_LED_TOP_WHITE);
 Indicator frontOrangeIndicator(wandLeds, WAND_LED_FRONT_ORANGE);
 Indicator firingRodIndicator(wandLeds, WAND_LED_FIRINGROD_YEL);
+Indicator *const wandIndicators[] = {&slowBlowIndicator, &topYellowIndicator, &topWhiteIndicator, &frontOrangeIndicator, &firingRodIndicator};
+IndicatorBank indicators(wandIndicators, sizeof(wandIndicators) / sizeof(wandIndicators[0]), INDICATOR_PATTERNS, INDICATOR_TICK);
+#ifdef GPIO_INDICATOR_PIN
+// Plain LED indicator dimmed by the soft PWM, its timer interrupt is only in this build
+SoftPwm softPwm;
+SOFTPWM_TIMER_ISR
+SingleColorIndicator gpioIndicator(GPIO_INDICATOR_PIN, false);
+#endif
 
 /*********************************************/
 /*    AUDIO PLAYER definition and helpers    */
@@ -216,6 +261,7 @@ Indicator firingRodIndicator(wandLeds, WAND_LED_FIRINGROD_YEL);
 #include "PlayerEngine.h"
 bool playing = false;            // variable for playin status
 bool cycling = false;            // cylcing single track mode tracker
+uint8_t loopingTrack = 0;        // looping track actually playing, kept under overlay tracks
 bool checkPlayerCommandDelay();  // function to check if audio command delay is paste since last play command
 unsigned long lastCommand = 0;   // tracker for the last command sent to audio player
 /****************************/
@@ -228,14 +274,26 @@ const bool VOL_POT = true;  // (0=false, 1 = true) activate the volume potentiom
 const bool VOL_POT = false;
 #define VOL_POT_PIN 0
 #endif
+#if (defined(DFP_MINI) + defined(DFP_MINI_FAST) + defined(PLAYER_MOCK)) > 1
+#error "Define only one player backend in ACONFIG.h : DFP_MINI, DFP_MINI_FAST or PLAYER_MOCK"
+#endif
 #ifdef DFP_MINI
-#include <DFRobotDFPlayerMini.h>
-Player_DFPlayerMini player(VOLUME_MAX, VOLUME_START, HW_RX, HW_TX, VOL_POT_PIN, VOL_POT, PLAYER_COMMAND_DELAY);  // define player with (min, max ,volume, MCU RX pin, MCU TX pin)
-const uint16_t PLAYER_BAUDRATE = 9600;                                                                           // Native baudrate is 9600 for this player.
+#include "PlayerBackend_DFPlayerMini.h"
+typedef PlayerBackend_DFPlayerMini PlayerBackend;
+const uint16_t PLAYER_BAUDRATE = 9600;  // Native baudrate is 9600 for this player.
 #elif defined(DFP_MINI_FAST)
-#include <DFPlayerMini_Fast.h>
-Player_DFPlayerMini_Fast player(VOLUME_MAX, VOLUME_START, HW_RX, HW_TX, VOL_POT_PIN, VOL_POT, PLAYER_COMMAND_DELAY);  // define player with (min, max ,volume, MCU RX pin, MCU TX pin)
-const uint16_t PLAYER_BAUDRATE = 9600;                                                                                // Native baudrate is 9600 for this player.
+#include "PlayerBackend_DFPlayerMini_Fast.h"
+typedef PlayerBackend_DFPlayerMini_Fast PlayerBackend;
+const uint16_t PLAYER_BAUDRATE = 9600;  // Native baudrate is 9600 for this player.
+#elif defined(PLAYER_MOCK)
+#include "PlayerBackend_Mock.h"
+typedef PlayerBackend_Mock PlayerBackend;  // no audio board, tracks are only timed
+const uint16_t PLAYER_BAUDRATE = 9600;
+#endif
+#ifdef DUAL_PLAYER
+DualPlayer<PlayerBackend> player(VOLUME_MAX, VOLUME_START, HW_RX, HW_TX, SFX_RX, SFX_TX, VOL_POT_PIN, VOL_POT, PLAYER_COMMAND_DELAY, LOOP_VOICE_GAIN, SFX_VOICE_GAIN);  // looping tracks voice and sound FX voice
+#else
+Player<PlayerBackend> player(VOLUME_MAX, VOLUME_START, HW_RX, HW_TX, VOL_POT_PIN, VOL_POT, PLAYER_COMMAND_DELAY);  // define player with (min, max ,volume, MCU RX pin, MCU TX pin)
 #endif
 /************************************/
 /* Audio board SERIAL COMMUNICATION */
@@ -248,6 +306,16 @@ const uint16_t PLAYER_BAUDRATE = 9600;
 SoftwareSerial SoftSerial(SW_RX, SW_TX);
 #define PLAYER_SOFTSERIAL
 #endif
+#ifdef DUAL_PLAYER
+#ifdef PLAYER_SOFTSERIAL
+#error "DUAL_PLAYER needs the first player on a hardware UART (Nano Every Serial1) : only one Software Serial can receive"
+#endif
+#ifdef WS2812_USART
+#error "WS2812_USART can't be used with DUAL_PLAYER : Software Serial turns interrupts off for a whole byte and would cut the pack LEDs frame"
+#endif
+#include <SoftwareSerial.h>
+SoftwareSerial SfxSerial(SFX_RX, SFX_TX);  // second player, sound FX voice
+#endif
 /*****************/
 /* THEMES TRACKS */
 /*****************/
@@ -291,6 +359,21 @@ Rumbler rumbler(RUMBLE_RELAY_PIN, &RUMBLER_MAX_ON_TIME, &RUMBLER_MIN_OFF_TIME, t
 #ifndef RUMBLE_RELAY_PIN
 Rumbler rumbler(0, &RUMBLER_MAX_ON_TIME, &RUMBLER_MIN_OFF_TIME, false);
 #endif
+/* BENCHMARK MODE */
+#ifdef BENCHMARK_MODE
+#include "BenchmarkEngine.h"
+Benchmark bench;
+void runBenchmark();  // measure the engines hot functions and print the results table
+#endif
+/* MEMORY MONITOR OPTION */
+#ifdef MEMORY_MONITOR
+#include "MemoryMonitorEngine.h"
+MemoryMonitor memoryMonitor;
+void checkMemory();  // memory guard margin check
+#endif
+#if defined(MEMORY_MONITOR) || defined(WS2812_BLACKOUT_STATS) || defined(GPIO_INDICATOR_PIN)
+void checkSerialCommands();  // reports on Serial monitor commands : 'm' memory, 'w' LEDs output interrupts, 'p' soft PWM interrupt
+#endif
 
 //////////////////////////////////////////////////////////////////////////
 //////////////////////  ***  SETUP LOOP  ***  ////////////////////////////
@@ -300,22 +383,39 @@ void setup(void) {
   if (DEBUG) {
     Serial.begin(DEBUG_BAUDRATE);
   }
+#if defined(MEMORY_MONITOR) || defined(BENCHMARK_MODE) || defined(WS2812_BLACKOUT_STATS)
+  if (!DEBUG) {
+    Serial.begin(DEBUG_BAUDRATE);
+  }
+#endif
 
 // Audio player setup
 // For Arduino Nano Every, uses Serial1 on D0/D1
 // For others, uses Software Serial, pins should be define according to your board
 // Baudrate should be set according to your audio player native baudrate.
 // Or you could change the player native baudrate to fit your serial communication (see player's doc).
+#ifdef DUAL_PLAYER
+  SfxSerial.begin(PLAYER_BAUDRATE);
+  SfxSerial.listen();  // the only Software Serial, replies from the sound FX player are received
+#endif
 #ifdef PLAYER_SERIAL1
   Serial1.begin(PLAYER_BAUDRATE);
+#ifdef DUAL_PLAYER
+  if (!player.begin(Serial1, SfxSerial)) {
+#else
   if (!player.begin(Serial1)) {
+#endif
     if (DEBUG) {
       Serial.println("Init failed, please check the wire connection!");
     }
   }
 #elif defined(PLAYER_SOFTSERIAL)
   SoftSerial.begin(PLAYER_BAUDRATE);
+#ifdef DUAL_PLAYER
+  if (!player.begin(SoftSerial, SfxSerial)) {
+#else
   if (!player.begin(SoftSerial)) {
+#endif
     if (DEBUG) {
       Serial.println("Init failed, please check the wire connection!");
     }
@@ -331,21 +431,54 @@ void setup(void) {
   packLeds.setBrightness(255);
   packLeds.clear();
   packLeds.show();
-  cyclotron.begin();
+#ifdef CYC_STYLE_SWITCH
+  beginCyclotronStyle();
+#else
+  cyclotron->begin();
+#endif
   powercell.begin();
   packVent.begin();
+#ifdef VENT_KEYFRAMES
+  packVentKeyframes.begin();
+#endif
 
   // setup wand's LEDs chain
   wandLeds.begin();
   wandLeds.setBrightness(255);
   wandLeds.clear();
   wandLeds.show();
+#ifdef WS2812_USART
+  ledsOutput.begin(true);  // pack chain sent by USART if its pin allows it
+#else
+  ledsOutput.begin();
+#endif
+#ifdef WS2812_PARALLEL
+  ledsOutput.beginParallel();  // both chains in one pass if their pins are on the same port
+#endif
+#ifdef WS2812_BLACKOUT_STATS
+#ifdef PLAYER_SOFTSERIAL
+  ledsOutput.watchUart(PLAYER_BAUDRATE, true);
+#else
+  ledsOutput.watchUart(PLAYER_BAUDRATE, false);
+#endif
+#endif
+#ifdef WS2812_COLOR_STAGE
+  ledsOutput.beginColorStage(WS2812_CHAIN_A, PACK_LEDS_BRIGHTNESS, PACK_LEDS_BALANCE);
+  ledsOutput.beginColorStage(WS2812_CHAIN_B, WAND_LEDS_BRIGHTNESS, WAND_LEDS_BALANCE);
+#ifdef WS2812_DITHER
+  ledsOutput.beginDither(WS2812_CHAIN_A);
+  ledsOutput.beginDither(WS2812_CHAIN_B);
+#endif
+#endif
+#ifdef LEDS_COMPOSITOR
+  ledsOutput.beginCompositor(WS2812_CHAIN_A);
+  ledsOutput.beginCompositor(WS2812_CHAIN_B);
+#endif
   wandVent.begin();
-  slowBlowIndicator.begin();
-  topWhiteIndicator.begin();
-  topYellowIndicator.begin();
-  frontOrangeIndicator.begin();
-  firingRodIndicator.begin();
+  indicators.begin();
+#ifdef GPIO_INDICATOR_PIN
+  gpioIndicator.beginPwm(softPwm);
+#endif
 
   // setup bar graph
   bargraph.begin(BG_SEG_MAP, 28, 2);
@@ -373,6 +506,17 @@ void setup(void) {
 
   // Sumbler setup
   rumbler.begin();
+
+#ifdef BENCHMARK_MODE
+  runBenchmark();
+#endif
+#ifdef GPIO_INDICATOR_PIN
+  softPwm.begin();  // after the benchmark, both use Timer 1 on Nano
+#endif
+
+#ifdef MEMORY_MONITOR
+  memoryMonitor.begin(MEMORY_GUARD_MARGIN);
+#endif
 }
 /******************** END SETUP LOOP ********************/
 
@@ -380,6 +524,9 @@ void setup(void) {
 //////////////////////  ***  MAIN LOOP  ***  /////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 void loop() {
+  // One clock reading for the whole loop : every engine advances on the same tick
+  frameTime = millis();
+
   // Troubleshooting info on pack states and stages
   if (DEBUG) {
     if (packState != prevPackState || stageFlag != prevStageFlag) {
@@ -394,52 +541,93 @@ void loop() {
     }
   }
 
+#if defined(MEMORY_MONITOR) || defined(WS2812_BLACKOUT_STATS) || defined(GPIO_INDICATOR_PIN)
+  checkSerialCommands();
+#endif
+#ifdef MEMORY_MONITOR
+  checkMemory();
+#endif
+
+  // Wand indicators blink patterns, all from one shared tick
+  indicators.tick(frameTime);
+#ifdef GPIO_INDICATOR_PIN
+  // GPIO indicator breathing while powered down, ON otherwise
+  if (packState == STATE_PWD_DOWN) {
+    gpioIndicator.pulse(GPIO_INDICATOR_PULSE, frameTime);
+  } else {
+    gpioIndicator.setLevel(255);
+  }
+#endif
+
   // LEDS UPDATE
   // Update some LEDS each 5 ms, toggling each time between wand and pack leds chains
   // This limit the update rates and help with the MCU load and code flow, and helps giving time to
   // the sound FX player the digest all the commands...
-  if (millis() - prevLedsUpdate > 5) {
-    prevLedsUpdate = millis();
-    if (ledsUpdateToggle) {
+  // When both chains are sent in one pass (same MCU port), both are updated each time.
+  if (frameTime - prevLedsUpdate > 5) {
+    prevLedsUpdate = frameTime;
+    if (ledsOutput.isParallel() || ledsUpdateToggle) {
       // Update LEDs color setting to last color schemes.
       bargraph.update();
       wandVent.update();
       firingRod.update();
-      // Update LEDs chains with last color schemes.
-      wandLeds.show();
-      ledsUpdateToggle = false;
-    } else {
+      indicators.update();
+#ifdef LEDS_COMPOSITOR
+      ledsOutput.compose(WS2812_CHAIN_B, frameTime);
+#endif
+    }
+    if (ledsOutput.isParallel() || !ledsUpdateToggle) {
       // Update LEDs color setting to last color schemes.
-      cyclotron.update();
+      cyclotron->update();
       powercell.update();
       packVent.update();
-      // Update LEDs chains with last color schemes.
-      packLeds.show();
-      ledsUpdateToggle = true;
+#ifdef VENT_KEYFRAMES
+      packVentKeyframes.update();  // over the vent while its keyframes are played
+#endif
+#ifdef LEDS_COMPOSITOR
+      ledsOutput.compose(WS2812_CHAIN_A, frameTime);
+#endif
+    }
+    // Update LEDs chains with last color schemes.
+    if (ledsOutput.isParallel()) {
+      ledsOutput.show();
+    } else if (ledsUpdateToggle) {
+      ledsOutput.showB();  // wand chain
+#ifdef WS2812_DITHER
+      ledsOutput.refresh(WS2812_CHAIN_A);  // pack chain sent again while it has dithered levels
+#endif
+    } else {
+      ledsOutput.showA();  // pack chain
+#ifdef WS2812_DITHER
+      ledsOutput.refresh(WS2812_CHAIN_B);
+#endif
     }
+    ledsUpdateToggle = !ledsUpdateToggle;
   }
 
   // Check buttons and switches readings and states
-  SWthemes.getState();
-  SWcharge.getState();
-  PBfire.getState();
-  PBrod.getState();
-  SWbootWand.getState();
+  SWthemes.getState(frameTime);
+  SWcharge.getState(frameTime);
+  PBfire.getState(frameTime);
+  PBrod.getState(frameTime);
+  SWbootWand.getState(frameTime);
   // To determine the output of the wand boot switch, or the dual wand and pack boot switches mode
   // (see OPTION : DUAL BOOT SWITCHES in ACONFIG.h)
 #ifdef PACK_BOOT_SWITCH_PIN
-  SWbootPack.getState();
+  SWbootPack.getState(frameTime);
   bootSwitchesOutput = getDualBootSwitchesOutput(bootSwitchesOutput);
 #else
   bootSwitchesOutput = SWbootWand.isON();
 #endif
 
   // Update smoker and rumbler
-  smoker.update();
-  rumbler.update();
+  smoker.update(frameTime);
+  rumbler.update(frameTime);
 
   // Set audio volume with potentiometer
   player.setVolWithPot();
+  // Send the player commands waiting for their voice (dual player)
+  player.update();
 
   ///////////////////////////////////////////////////////////////
   // Actions for different packs states
@@ -455,19 +643,22 @@ void loop() {
           if (DEBUG) {
             Serial.println("STATE_PWD_DOWN");
           }
-          playThisStateTrack(packState, TRACK_LOOPING[packState]);  //  Stop sound effects :
+          playThisStateTrack(packState, trackLooping(packState));   //  Stop sound effects :
           getLEDsSchemeForThisState(packState);                     // Inititate state LEDs animations
-          rumbler.rumbleOFF();
-          smoker.smokeOFF();
-          stateStartTime = millis();  // Register state start time
+          rumbler.rumbleOFF(frameTime);
+          smoker.smokeOFF(frameTime);
+          stateStartTime = frameTime;  // Register state start time
           stageFlag = 1;              // End state initialization
           break;
 
         // This pack state loop :
         case 1:
-          checkPlayModeForThisState(TRACK_LOOPING[packState]);   // Set playmode for this stage : this pack state is transient, so no looping...
+          checkPlayModeForThisState(trackLooping(packState));    // Set playmode for this stage : this pack state is transient, so no looping...
           getLEDsSchemeForThisState(packState);                  // Pack state LEDs animations
           checkPlayThemesMode();                                 // Cut off sound effects if themes switch is ON
+#ifdef CYC_STYLE_SWITCH
+          checkCyclotronStyleSwitch();                           // Switch cyclotron style if fire and rod buttons are held
+#endif
           checkIfSwitchExit(bootSwitchesOutput, STATE_BOOTING);  // Pack state exit : check if the pack is booting
           break;
       }
@@ -484,17 +675,17 @@ void loop() {
           if (DEBUG) {
             Serial.println("STATE_BOOTING");
           }
-          playThisStateTrack(packState, TRACK_LOOPING[packState]);  // Play sound FX track only if themes switch is OFF
+          playThisStateTrack(packState, trackLooping(packState));   // Play sound FX track only if themes switch is OFF
           getLEDsSchemeForThisState(packState);                     // Inititate state LEDs animations
-          rumbler.rumbleOFF();
-          smoker.smokeOFF();
-          stateStartTime = millis();  // Register state start time
+          rumbler.rumbleOFF(frameTime);
+          smoker.smokeOFF(frameTime);
+          stateStartTime = frameTime;  // Register state start time
           stageFlag = 1;              // End state initialization
           break;
 
         // This pack state loop :
         case 1:
-          checkPlayModeForThisState(TRACK_LOOPING[packState]);               // Set playmode for this stage : this pack state is transient, so no cyling...
+          checkPlayModeForThisState(trackLooping(packState));                // Set playmode for this stage : this pack state is transient, so no cyling...
           getLEDsSchemeForThisState(packState);                              // Pack state LEDs animations
           checkPlayThemesMode();                                             // Cut off sound effects if themes switch is ON
           if (!checkIfSwitchExit(!bootSwitchesOutput, STATE_SHUTTING_DOWN))  // Pack state exits : check if the pack is shutting down
@@ -517,17 +708,17 @@ void loop() {
           if (DEBUG) {
             Serial.println("STATE_IDLING_UNLOADED");
           }
-          playThisStateTrack(packState, TRACK_LOOPING[packState]);  // Play sound FX track only if themes switch is OFF
+          playThisStateTrack(packState, trackLooping(packState));   // Play sound FX track only if themes switch is OFF
           getLEDsSchemeForThisState(packState);                     // Inititate state LEDs animations
-          rumbler.rumbleOFF();
-          smoker.smokeOFF();
-          stateStartTime = millis();  // Register state start time
+          rumbler.rumbleOFF(frameTime);
+          smoker.smokeOFF(frameTime);
+          stateStartTime = frameTime;  // Register state start time
           stageFlag = 1;              // End state initialization
           break;
 
         // This pack state loop :
         case 1:
-          checkPlayModeForThisState(TRACK_LOOPING[packState]);               // Set Playmode for this state : this state needs a looping track
+          checkPlayModeForThisState(trackLooping(packState));                // Set Playmode for this state : this state needs a looping track
           getLEDsSchemeForThisState(packState);                              // Pack state LEDs animations
           checkPlayThemesMode();                                             // Cut off sound effects if themes switch is ON
           if (!checkIfSwitchExit(!bootSwitchesOutput, STATE_SHUTTING_DOWN))  // Pack state exits : check if the pack is shutting down
@@ -549,17 +740,17 @@ void loop() {
           if (DEBUG) {
             Serial.println("STATE_IDLING_CHARGED");
           }
-          playThisStateTrack(packState, TRACK_LOOPING[packState]);  // Play sound FX track only if themes switch is OFF
+          playThisStateTrack(packState, trackLooping(packState));   // Play sound FX track only if themes switch is OFF
           getLEDsSchemeForThisState(packState);                     // Inititate state LEDs animations
-          rumbler.rumbleOFF();
-          smoker.smokeOFF();
-          stateStartTime = millis();  // Register state start time
+          rumbler.rumbleOFF(frameTime);
+          smoker.smokeOFF(frameTime);
+          stateStartTime = frameTime;  // Register state start time
           stageFlag = 1;              // End state initialization
           break;
 
         // This pack state loop :
         case 1:
-          checkPlayModeForThisState(TRACK_LOOPING[packState]);               // Set Playmode for this state : this state is not transient, so cylcing is ON
+          checkPlayModeForThisState(trackLooping(packState));                // Set Playmode for this state : this state is not transient, so cylcing is ON
           getLEDsSchemeForThisState(packState);                              // Pack state LEDs animations
           checkPlayThemesMode();                                             // Cut off sound effects if themes switch is ON
           if (!checkIfSwitchExit(!bootSwitchesOutput, STATE_SHUTTING_DOWN))  // Pack state exits : check if the pack is shutting down
@@ -584,17 +775,17 @@ void loop() {
           if (DEBUG) {
             Serial.println("STATE_CHARGING");
           }
-          playThisStateTrack(packState, TRACK_LOOPING[packState]);  // Play sound FX track only if themes switch is OFF
+          playThisStateTrack(packState, trackLooping(packState));   // Play sound FX track only if themes switch is OFF
           getLEDsSchemeForThisState(packState);                     // Inititate state LEDs animations
-          rumbler.rumbleOFF();
-          smoker.smokeOFF();
-          stateStartTime = millis();  // Register state start time
+          rumbler.rumbleOFF(frameTime);
+          smoker.smokeOFF(frameTime);
+          stateStartTime = frameTime;  // Register state start time
           stageFlag = 1;              // End state initialization
           break;
 
         // This pack state loop :
         case 1:
-          checkPlayModeForThisState(TRACK_LOOPING[packState]);               // Set Playmode for this state : this is a transient stage, turn off cycling mode
+          checkPlayModeForThisState(trackLooping(packState));                // Set Playmode for this state : this is a transient stage, turn off cycling mode
           getLEDsSchemeForThisState(packState);                              // Pack state LEDs animations
           checkPlayThemesMode();                                             // Cut off sound effects if themes switch is ON
           if (!checkIfSwitchExit(!bootSwitchesOutput, STATE_SHUTTING_DOWN))  // Pack state exits : check if the pack is shutting down
@@ -619,17 +810,17 @@ void loop() {
           if (DEBUG) {
             Serial.println("STATE_UNLOADING");
           }
-          playThisStateTrack(packState, TRACK_LOOPING[packState]);  // Play sound FX track only if themes switch is OFF
+          playThisStateTrack(packState, trackLooping(packState));   // Play sound FX track only if themes switch is OFF
           getLEDsSchemeForThisState(packState);                     // Inititate state LEDs animations
-          rumbler.rumbleOFF();
-          smoker.smokeOFF();
-          stateStartTime = millis();  // Register state start time
+          rumbler.rumbleOFF(frameTime);
+          smoker.smokeOFF(frameTime);
+          stateStartTime = frameTime;  // Register state start time
           stageFlag = 1;              // End state initialization
           break;
 
         // This pack state loop :
         case 1:
-          checkPlayModeForThisState(TRACK_LOOPING[packState]);               // Set Playmode for this state : this is a transient stage, turn off cycling mode
+          checkPlayModeForThisState(trackLooping(packState));                // Set Playmode for this state : this is a transient stage, turn off cycling mode
           getLEDsSchemeForThisState(packState);                              // Pack state LEDs animations
           checkPlayThemesMode();                                             // Cut off sound effects if themes switch is ON
           if (!checkIfSwitchExit(!bootSwitchesOutput, STATE_SHUTTING_DOWN))  // Pack state exits : check if the pack is shutting down
@@ -654,19 +845,19 @@ void loop() {
           if (DEBUG) {
             Serial.println("STATE_FIRING_RAMP");
           }
-          playThisStateTrack(packState, TRACK_LOOPING[packState]);  // Play sound FX track only if themes switch is OFF
+          playThisStateTrack(packState, trackLooping(packState));   // Play sound FX track only if themes switch is OFF
           getLEDsSchemeForThisState(packState);                     // Inititate state LEDs animations
-          rumbler.rumbleON();                                       // Start rumbler motor if not already start AND minimum off time delay respected
-          smoker.smokeOFF();
-          stateStartTime = millis();  // Register state start time
+          rumbler.rumbleON(frameTime);                              // Start rumbler motor if not already start AND minimum off time delay respected
+          smoker.smokeOFF(frameTime);
+          stateStartTime = frameTime;  // Register state start time
           stageFlag = 1;              // End state initialization
           break;
 
         // This pack state loop :
         case 1:
-          checkPlayModeForThisState(TRACK_LOOPING[packState]);               // Set Playmode for this state : this is a transient stage, turn off cycling mode
+          checkPlayModeForThisState(trackLooping(packState));                // Set Playmode for this state : this is a transient stage, turn off cycling mode
           getLEDsSchemeForThisState(packState);                              // Pack state LEDs animations
-          rumbler.rumbleON();                                                // Start rumbler motor if not already start AND minimum off time delay respected
+          rumbler.rumbleON(frameTime);                                       // Start rumbler motor if not already start AND minimum off time delay respected
           checkPlayThemesMode();                                             // Cut off sound effects if themes switch is ON
           if (!checkIfSwitchExit(!bootSwitchesOutput, STATE_SHUTTING_DOWN))  // Pack state exits : check if the pack is shutting down
           {
@@ -693,19 +884,19 @@ void loop() {
           if (DEBUG) {
             Serial.println("STATE_FIRING_MAX");
           }
-          playThisStateTrack(packState, TRACK_LOOPING[packState]);  // Play sound FX track only if themes switch is OFF
+          playThisStateTrack(packState, trackLooping(packState));   // Play sound FX track only if themes switch is OFF
           getLEDsSchemeForThisState(packState);                     // Inititate state LEDs animations
-          rumbler.rumbleON();                                       // Start rumbler motor if not already start AND minimum off time delay respected
-          smoker.smokeOFF();
-          stateStartTime = millis();  // Register state start time
+          rumbler.rumbleON(frameTime);                              // Start rumbler motor if not already start AND minimum off time delay respected
+          smoker.smokeOFF(frameTime);
+          stateStartTime = frameTime;  // Register state start time
           stageFlag = 1;              // End state initialization
           break;
 
         // This pack state loop :
         case 1:
-          checkPlayModeForThisState(TRACK_LOOPING[packState]);               // Set Playmode for this state : this is a transient stage, turn off cycling mode
+          checkPlayModeForThisState(trackLooping(packState));                // Set Playmode for this state : this is a transient stage, turn off cycling mode
           getLEDsSchemeForThisState(packState);                              // Pack state LEDs animations
-          rumbler.rumbleON();                                                // Start rumbler motor if not already start AND minimum off time delay respected
+          rumbler.rumbleON(frameTime);                                       // Start rumbler motor if not already start AND minimum off time delay respected
           checkPlayThemesMode();                                             // Cut off sound effects if themes switch is ON
           if (!checkIfSwitchExit(!bootSwitchesOutput, STATE_SHUTTING_DOWN))  // Pack state exits : check if the pack is shutting down
           {
@@ -732,20 +923,20 @@ void loop() {
           if (DEBUG) {
             Serial.println("STATE_FIRING_OVERHEAT");
           }
-          playThisStateTrack(packState, TRACK_LOOPING[packState]);  // Play sound FX track only if themes switch is OFF
+          playThisStateTrack(packState, trackLooping(packState));   // Play sound FX track only if themes switch is OFF
           getLEDsSchemeForThisState(packState);                     // Inititate state LEDs animations
-          rumbler.rumbleON();                                       // Start rumbler motor if not already start AND minimum off time delay respected
-          smoker.smokeON();                                         // Start smoke module if not already start AND minimum off time delay respected
-          stateStartTime = millis();                                // Register state start time
+          rumbler.rumbleON(frameTime);                              // Start rumbler motor if not already start AND minimum off time delay respected
+          smoker.smokeON(frameTime);                                // Start smoke module if not already start AND minimum off time delay respected
+          stateStartTime = frameTime;                               // Register state start time
           stageFlag = 1;                                            // End state initialization
           break;
 
         // This pack state loop :
         case 1:
-          checkPlayModeForThisState(TRACK_LOOPING[packState]);               // Set Playmode for this state : this is a transient stage, turn off cycling mode
+          checkPlayModeForThisState(trackLooping(packState));                // Set Playmode for this state : this is a transient stage, turn off cycling mode
           getLEDsSchemeForThisState(packState);                              // Pack state LEDs animations
-          rumbler.rumbleON();                                                // Start rumbler motor if not already start AND minimum off time delay respected
-          smoker.smokeON();                                                  // Start smoke module if not already start AND minimum off time delay respected
+          rumbler.rumbleON(frameTime);                                       // Start rumbler motor if not already start AND minimum off time delay respected
+          smoker.smokeON(frameTime);                                         // Start smoke module if not already start AND minimum off time delay respected
           checkPlayThemesMode();                                             // Cut off sound effects if themes switch is ON
           if (!checkIfSwitchExit(!bootSwitchesOutput, STATE_SHUTTING_DOWN))  // Pack state exits : check if the pack is shutting down
           {
@@ -769,17 +960,17 @@ void loop() {
           if (DEBUG) {
             Serial.println("STATE_TAIL");
           }
-          playThisStateTrack(packState, TRACK_LOOPING[packState]);  // Play sound FX track only if themes switch is OFF
+          playThisStateTrack(packState, trackLooping(packState));   // Play sound FX track only if themes switch is OFF
           getLEDsSchemeForThisState(packState);                     // Inititate state LEDs animations
-          rumbler.rumbleOFF();
-          smoker.smokeOFF();
-          stateStartTime = millis();  // Register state start time
+          rumbler.rumbleOFF(frameTime);
+          smoker.smokeOFF(frameTime);
+          stateStartTime = frameTime;  // Register state start time
           stageFlag = 1;              // End state initialization
           break;
 
         // This pack state loop :
         case 1:
-          checkPlayModeForThisState(TRACK_LOOPING[packState]);               // Set Playmode for this state : this is a transient stage, turn off cycling mode
+          checkPlayModeForThisState(trackLooping(packState));                // Set Playmode for this state : this is a transient stage, turn off cycling mode
           getLEDsSchemeForThisState(packState);                              // Pack state LEDs animations
           checkPlayThemesMode();                                             // Cut off sound effects if themes switch is ON
           if (!checkIfSwitchExit(!bootSwitchesOutput, STATE_SHUTTING_DOWN))  // Pack state exits : check if the pack is shutting down
@@ -803,18 +994,18 @@ void loop() {
           if (DEBUG) {
             Serial.println("STATE_OVERHEATED");
           }
-          playThisStateTrack(packState, TRACK_LOOPING[packState]);  // Play sound FX track only if themes switch is OFF
+          playThisStateTrack(packState, trackLooping(packState));   // Play sound FX track only if themes switch is OFF
           getLEDsSchemeForThisState(packState);                     // Inititate state LEDs animations
-          smoker.smokeON();                                         // Start smoke module if not already start AND minimum off time delay respected
-          stateStartTime = millis();                                // Register state start time
+          smoker.smokeON(frameTime);                                // Start smoke module if not already start AND minimum off time delay respected
+          stateStartTime = frameTime;                               // Register state start time
           stageFlag = 1;                                            // End state initialization
           break;
 
         // This pack state loop :
         case 1:
-          checkPlayModeForThisState(TRACK_LOOPING[packState]);               // Set Playmode for this state : this is a transient stage, turn off cycling mode
+          checkPlayModeForThisState(trackLooping(packState));                // Set Playmode for this state : this is a transient stage, turn off cycling mode
           getLEDsSchemeForThisState(packState);                              // Pack state LEDs animations
-          smoker.smokeON();                                                  // Start smoke module if not already start AND minimum off time delay respected
+          smoker.smokeON(frameTime);                                         // Start smoke module if not already start AND minimum off time delay respected
           checkPlayThemesMode();                                             // Cut off sound effects if themes switch is ON
           if (!checkIfSwitchExit(!bootSwitchesOutput, STATE_SHUTTING_DOWN))  // Pack state exits : check if the pack is shutting down
           {
@@ -835,17 +1026,17 @@ void loop() {
           if (DEBUG) {
             Serial.println("STATE_SHUTTING_DOWN");
           }
-          playThisStateTrack(packState, TRACK_LOOPING[packState]);  // Play sound FX track only if themes switch is OFF
+          playThisStateTrack(packState, trackLooping(packState));   // Play sound FX track only if themes switch is OFF
           getLEDsSchemeForThisState(packState);                     // Inititate state LEDs animations
-          rumbler.rumbleOFF();
-          smoker.smokeOFF();
-          stateStartTime = millis();  // Register state start time
+          rumbler.rumbleOFF(frameTime);
+          smoker.smokeOFF(frameTime);
+          stateStartTime = frameTime;  // Register state start time
           stageFlag = 1;              // End state initialization
           break;
 
         // This pack state loop :
         case 1:
-          checkPlayModeForThisState(TRACK_LOOPING[packState]);        // Set Playmode for this state : this is a transient stage, turn off cycling mode
+          checkPlayModeForThisState(trackLooping(packState));         // Set Playmode for this state : this is a transient stage, turn off cycling mode
           getLEDsSchemeForThisState(packState);                       // Pack state LEDs animations
           checkPlayThemesMode();                                      // Cut off sound effects if themes switch is ON
           if (!checkIfSwitchExit(bootSwitchesOutput, STATE_BOOTING))  // Pack state exits : check if the pack is booting up
@@ -877,6 +1068,15 @@ void getLEDsSchemeForThisState(uint8_t state) {
   else  // Pack state already initialized
     init = false;
 
+#ifdef LEDS_COMPOSITOR
+  if (init) {
+    // New animations fade in over the last frame, overlays belong to their state
+    ledsOutput.crossfade(WS2812_CHAIN_A, LEDS_CROSSFADE_TIME, frameTime);
+    ledsOutput.crossfade(WS2812_CHAIN_B, LEDS_CROSSFADE_TIME, frameTime);
+    ledsOutput.clearOverlays(WS2812_CHAIN_A);
+  }
+#endif
+
   switch (state) {
     case STATE_PWD_DOWN:
       if (init) {
@@ -884,8 +1084,8 @@ void getLEDsSchemeForThisState(uint8_t state) {
       }
       // To show that power is still on on the pack, show some minimum ligths
       if (POWERDOWN_BLINKING) {
-        topWhiteIndicator.green(INDICATOR_SLOW_FLASH);  // set WAND_LED_TOP_WHITE led green flashing
-        powercell.poweredDown();                        // first led blinking slowly
+        topWhiteIndicator.set(INDICATOR_GREEN, INDICATOR_SLOW);  // set WAND_LED_TOP_WHITE led green flashing
+        powercell.poweredDown(frameTime);                        // first led blinking slowly
       }
       break;
 
@@ -896,12 +1096,19 @@ void getLEDsSchemeForThisState(uint8_t state) {
         firingRodIndicator.clear();
         topYellowIndicator.clear();
         wandVent.clear();
+#ifdef VENT_KEYFRAMES
+        packVent.clear();  // the keyframes start from all pixels OFF
+#endif
       }
-      slowBlowIndicator.red(INDICATOR_FAST_FLASH);
-      cyclotron.rampToIdleOne(3000, init);
-      powercell.boot(3000, init);
-      bargraph.boot(50, 50, init);
-      packVent.fadeOut(1000, false);  // to finish shutdown sequence if boot switch was turned ON when venting are not done
+      slowBlowIndicator.set(INDICATOR_RED, INDICATOR_FAST);
+      cyclotron->rampToIdleOne(3000, init, frameTime);
+      powercell.boot(3000, init, frameTime);
+      bargraph.boot(50, 50, init, frameTime);
+#ifdef VENT_KEYFRAMES
+      packVentKeyframes.play(KF_VENT_BOOT, false, init, frameTime);
+#else
+      packVent.boot(3000, init, frameTime);  // to fade out what is left of shutdown sequence if boot switch was turned ON when venting are not done
+#endif
       break;
 
     case STATE_IDLING_UNLOADED:
@@ -913,10 +1120,10 @@ void getLEDsSchemeForThisState(uint8_t state) {
         wandVent.clear();
         packVent.clear();
       }
-      slowBlowIndicator.red(0);
-      cyclotron.rampToIdleOne(0, false);  // just idling, no ramping
-      powercell.rampToIdleOne(0, false);  // just idling, no ramping
-      bargraph.idleOne(50);
+      slowBlowIndicator.set(INDICATOR_RED, INDICATOR_SOLID);
+      cyclotron->rampToIdleOne(0, false, frameTime);  // just idling, no ramping
+      powercell.rampToIdleOne(0, false, frameTime);  // just idling, no ramping
+      bargraph.idleOne(50, frameTime);
       break;
 
     case STATE_IDLING_CHARGED:
@@ -925,13 +1132,13 @@ void getLEDsSchemeForThisState(uint8_t state) {
         packVent.clear();
         wandVent.clear();
       }
-      firingRodIndicator.orange(0);
-      frontOrangeIndicator.orange(0);
-      topWhiteIndicator.white(0);
-      slowBlowIndicator.red(0);
-      cyclotron.rampToIdleTwo(0, false);  // just idling, no ramping
-      powercell.rampToIdleTwo(0, false);  // just idling, no ramping
-      bargraph.idleTwo(70);
+      firingRodIndicator.set(INDICATOR_ORANGE, INDICATOR_SOLID);
+      frontOrangeIndicator.set(INDICATOR_ORANGE, INDICATOR_SOLID);
+      topWhiteIndicator.set(INDICATOR_WHITE, INDICATOR_SOLID);
+      slowBlowIndicator.set(INDICATOR_RED, INDICATOR_SOLID);
+      cyclotron->rampToIdleTwo(0, false, frameTime);  // just idling, no ramping
+      powercell.rampToIdleTwo(0, false, frameTime);  // just idling, no ramping
+      bargraph.idleTwo(70, frameTime);
 
       break;
 
@@ -942,12 +1149,12 @@ void getLEDsSchemeForThisState(uint8_t state) {
         packVent.clear();
         wandVent.clear();
       }
-      firingRodIndicator.orange(INDICATOR_FAST_FLASH);
-      topWhiteIndicator.white(INDICATOR_FAST_FLASH);
-      slowBlowIndicator.red(0);
-      powercell.rampToIdleTwo(2500, init);
-      cyclotron.rampToIdleTwo(2500, init);
-      bargraph.idleOne(50);
+      firingRodIndicator.set(INDICATOR_ORANGE, INDICATOR_FAST);
+      topWhiteIndicator.set(INDICATOR_WHITE, INDICATOR_FAST);
+      slowBlowIndicator.set(INDICATOR_RED, INDICATOR_SOLID);
+      powercell.rampToIdleTwo(2500, init, frameTime);
+      cyclotron->rampToIdleTwo(2500, init, frameTime);
+      bargraph.idleOne(50, frameTime);
       break;
 
     case STATE_UNLOADING:
@@ -958,58 +1165,63 @@ void getLEDsSchemeForThisState(uint8_t state) {
         packVent.clear();
         wandVent.clear();
       }
-      topWhiteIndicator.white(INDICATOR_FAST_FLASH);
-      slowBlowIndicator.red(0);
-      powercell.rampToIdleOne(2500, init);
-      cyclotron.rampToIdleOne(2500, init);
-      bargraph.idleTwo(70);
-      firingRod.tail(1500);
+      topWhiteIndicator.set(INDICATOR_WHITE, INDICATOR_FAST);
+      slowBlowIndicator.set(INDICATOR_RED, INDICATOR_SOLID);
+      powercell.rampToIdleOne(2500, init, frameTime);
+      cyclotron->rampToIdleOne(2500, init, frameTime);
+      bargraph.idleTwo(70, frameTime);
+      firingRod.tail(1500, frameTime);
       break;
 
     case STATE_FIRING_RAMP:
       if (init) {
         topYellowIndicator.clear();
       }
-      topWhiteIndicator.white(0);
-      firingRodIndicator.orange(INDICATOR_SLOW_FLASH);
-      frontOrangeIndicator.orange(0);
-      slowBlowIndicator.red(0);
-      cyclotron.rampToFiring(5000, init);
-      powercell.rampToFiring(5000, init);
-      bargraph.firing(50);
-      packVent.rampToRed(16000, init);
-      wandVent.rampToCoolBlue(10000, init);
-      firingRod.fireStrobe(20);
+      topWhiteIndicator.set(INDICATOR_WHITE, INDICATOR_SOLID);
+      firingRodIndicator.set(INDICATOR_ORANGE, INDICATOR_SLOW);
+      frontOrangeIndicator.set(INDICATOR_ORANGE, INDICATOR_SOLID);
+      slowBlowIndicator.set(INDICATOR_RED, INDICATOR_SOLID);
+      cyclotron->rampToFiring(5000, init, frameTime);
+      powercell.rampToFiring(5000, init, frameTime);
+      bargraph.firing(50, frameTime);
+      packVent.warming(16000, init, frameTime);  // blue and green fade out, then red fades in
+      wandVent.rampToCoolBlue(10000, init, frameTime);
+      firingRod.fireStrobe(20, frameTime);
       break;
 
     case STATE_FIRING_MAX:
-      if ((millis() - stateStartTime) >= FIRING_WARNING_DELAY) {
-        topYellowIndicator.yellow(INDICATOR_MEDIUM_FLASH);
+      if ((frameTime - stateStartTime) >= FIRING_WARNING_DELAY) {
+        topYellowIndicator.set(INDICATOR_YELLOW, INDICATOR_MEDIUM);
       }
-      topWhiteIndicator.white(0);
-      firingRodIndicator.orange(INDICATOR_FAST_FLASH);
-      frontOrangeIndicator.orange(0);
-      slowBlowIndicator.red(0);
-      cyclotron.rampToFiring(5000, false);  // already initialized in STATE_FIRING_RAMP
-      powercell.rampToFiring(5000, false);  // already initialized in STATE_FIRING_RAMP
-      bargraph.firing(50);
-      packVent.rampToRed(16000, false);
-      wandVent.rampToCoolBlue(10000, false);
-      firingRod.fireStrobe(40);
+      topWhiteIndicator.set(INDICATOR_WHITE, INDICATOR_SOLID);
+      firingRodIndicator.set(INDICATOR_ORANGE, INDICATOR_FAST);
+      frontOrangeIndicator.set(INDICATOR_ORANGE, INDICATOR_SOLID);
+      slowBlowIndicator.set(INDICATOR_RED, INDICATOR_SOLID);
+      cyclotron->rampToFiring(5000, false, frameTime);  // already initialized in STATE_FIRING_RAMP
+      powercell.rampToFiring(5000, false, frameTime);  // already initialized in STATE_FIRING_RAMP
+      bargraph.firing(50, frameTime);
+      packVent.warming(16000, false, frameTime);  // sequence initialized in STATE_FIRING_RAMP
+      wandVent.rampToCoolBlue(10000, false, frameTime);
+      firingRod.fireStrobe(40, frameTime);
       break;
 
     case STATE_FIRING_OVERHEAT:
-      topYellowIndicator.red(INDICATOR_FAST_FLASH);  // keep flashing from same pace as previous stage
-      topWhiteIndicator.white(0);
-      firingRodIndicator.orange(INDICATOR_FAST_FLASH);
-      frontOrangeIndicator.orange(0);
-      slowBlowIndicator.red(0);
-      cyclotron.rampToFiring(5000, false);  // Sequence initialized in STATE_FIRING_RAMP
-      powercell.rampToFiring(5000, false);  // Sequence initialized in STATE_FIRING_RAMP
-      bargraph.firing(50);
-      packVent.rampToOrange(3000, init);
-      wandVent.rampToRed(2000, init);
-      firingRod.fireStrobe(40);
+      topYellowIndicator.set(INDICATOR_RED, INDICATOR_FAST);  // keep flashing from same pace as previous stage
+#ifdef LEDS_COMPOSITOR
+      // Cyclotron flashing red over its animation, at the top yellow indicator pace
+      ledsOutput.setOverlay(WS2812_CHAIN_A, 0, cyclotron->getFirstLed(), cyclotron->getLastLed(), 255, 0, 0, WS2812_BLEND_MAX,
+                            (((frameTime - stateStartTime) / INDICATOR_FAST_FLASH) & 1) ? 0 : LEDS_OVERHEAT_FLASH);
+#endif
+      topWhiteIndicator.set(INDICATOR_WHITE, INDICATOR_SOLID);
+      firingRodIndicator.set(INDICATOR_ORANGE, INDICATOR_FAST);
+      frontOrangeIndicator.set(INDICATOR_ORANGE, INDICATOR_SOLID);
+      slowBlowIndicator.set(INDICATOR_RED, INDICATOR_SOLID);
+      cyclotron->rampToFiring(5000, false, frameTime);  // Sequence initialized in STATE_FIRING_RAMP
+      powercell.rampToFiring(5000, false, frameTime);  // Sequence initialized in STATE_FIRING_RAMP
+      bargraph.firing(50, frameTime);
+      packVent.rampToOrange(3000, init, frameTime);
+      wandVent.rampToRed(2000, init, frameTime);
+      firingRod.fireStrobe(40, frameTime);
       break;
 
     case STATE_TAIL:
@@ -1017,30 +1229,30 @@ void getLEDsSchemeForThisState(uint8_t state) {
         topYellowIndicator.clear();
         firingRodIndicator.clear();
       }
-      topWhiteIndicator.white(0);
-      frontOrangeIndicator.orange(INDICATOR_MEDIUM_FLASH);
-      slowBlowIndicator.red(0);
-      firingRod.tail(1500);
-      powercell.rampToIdleTwo(2000, init);
-      cyclotron.rampToIdleTwo(2000, init);
-      bargraph.idleTwo(70);
-      wandVent.fadeOut(2500, init);
-      packVent.cooling(1000,1800,init); // Ramp to cool blue then fade out : (int ramp time, int fade out time, bool init)
+      topWhiteIndicator.set(INDICATOR_WHITE, INDICATOR_SOLID);
+      frontOrangeIndicator.set(INDICATOR_ORANGE, INDICATOR_MEDIUM);
+      slowBlowIndicator.set(INDICATOR_RED, INDICATOR_SOLID);
+      firingRod.tail(1500, frameTime);
+      powercell.rampToIdleTwo(2000, init, frameTime);
+      cyclotron->rampToIdleTwo(2000, init, frameTime);
+      bargraph.idleTwo(70, frameTime);
+      wandVent.fadeOut(2500, init, frameTime);
+      packVent.cooling(1000,1800,init, frameTime); // Ramp to cool blue then fade out : (int ramp time, int fade out time, bool init)
       break;
 
     case STATE_OVERHEATED:
       if (init) {
         firingRodIndicator.clear();
       }
-      frontOrangeIndicator.orange(INDICATOR_MEDIUM_FLASH);
-      topYellowIndicator.red(INDICATOR_FAST_FLASH);
-      slowBlowIndicator.red(0);
-      firingRod.tail(1500);
-      powercell.rampToIdleTwo(5000, init);
-      cyclotron.rampToIdleTwo(5000, init);
-      bargraph.idleTwo(70);
-      wandVent.fadeOut(4500, init);
-      packVent.cooling(3000,1800,init); // Ramp to cool blue then fade out : (int ramp_time, int fadeOut_time, bool init)
+      frontOrangeIndicator.set(INDICATOR_ORANGE, INDICATOR_MEDIUM);
+      topYellowIndicator.set(INDICATOR_RED, INDICATOR_FAST);
+      slowBlowIndicator.set(INDICATOR_RED, INDICATOR_SOLID);
+      firingRod.tail(1500, frameTime);
+      powercell.rampToIdleTwo(5000, init, frameTime);
+      cyclotron->rampToIdleTwo(5000, init, frameTime);
+      bargraph.idleTwo(70, frameTime);
+      wandVent.fadeOut(4500, init, frameTime);
+      packVent.cooling(3000,1800,init, frameTime); // Ramp to cool blue then fade out : (int ramp_time, int fadeOut_time, bool init)
       break;
 
     case STATE_SHUTTING_DOWN:
@@ -1051,12 +1263,12 @@ void getLEDsSchemeForThisState(uint8_t state) {
         frontOrangeIndicator.clear();
         wandVent.clear();
       }
-      slowBlowIndicator.red(INDICATOR_FAST_FLASH);
-      powercell.shuttingDown(3000, init);
-      cyclotron.rampToPoweredDown(3000, init);
-      bargraph.shuttingDown(50, init);
-      firingRod.tail(1500);
-      packVent.shutdown(1000,1000,800,init); // Ramp to red, then ramp to cool blue, then fade out : (int red_ramp_time, int blue_ramp_time, int fadeOut_time, bool init)
+      slowBlowIndicator.set(INDICATOR_RED, INDICATOR_FAST);
+      powercell.shuttingDown(3000, init, frameTime);
+      cyclotron->rampToPoweredDown(3000, init, frameTime);
+      bargraph.shuttingDown(50, init, frameTime);
+      firingRod.tail(1500, frameTime);
+      packVent.shutdown(1000,1000,800,init, frameTime); // Ramp to red, then ramp to cool blue, then fade out : (int red_ramp_time, int blue_ramp_time, int fadeOut_time, bool init)
       break;
   }
 }
@@ -1135,26 +1347,135 @@ if (init)
 
 void clearAllLights() {
   // Clear leds
-  cyclotron.clear();
+  cyclotron->clear();
   bargraph.clear();
   packVent.clear();
   wandVent.clear();
-  slowBlowIndicator.clear();
-  topWhiteIndicator.clear();
-  topYellowIndicator.clear();
-  frontOrangeIndicator.clear();
-  firingRodIndicator.clear();
+  indicators.clear();
   firingRod.clear();
 
   // Reset trackers
 }
 
+#ifdef BENCHMARK_MODE
+// Calls the function again and again for BENCHMARK_DURATION, engines timers decide when the real work is done.
+// ready is run before each call, out of the count.
+#define BENCHMARK_ROW_READY(name, ready, call) \
+  bench.reset(); \
+  for (unsigned long t = millis(); millis() - t < BENCHMARK_DURATION;) { \
+    frameTime = millis(); \
+    ready; \
+    bench.start(); \
+    call; \
+    bench.stop(); \
+  } \
+  bench.printRow(Serial, F(name));
+#define BENCHMARK_ROW(name, call) BENCHMARK_ROW_READY(name, , call)
+
+void runBenchmark() {
+  bench.begin();
+  bench.printHeader(Serial);
+  frameTime = millis();
+  // Animations in their firing state, the heaviest one
+  cyclotron->rampToFiring(0, true, frameTime);
+  powercell.rampToFiring(0, true, frameTime);
+  packVent.warming(16000, true, frameTime);
+  BENCHMARK_ROW("cyclotron->update()", cyclotron->update());
+  BENCHMARK_ROW("cyclotron->rampToFiring() (_rotation)", cyclotron->rampToFiring(0, false, frameTime));
+  BENCHMARK_ROW("powercell.update()", powercell.update());
+  BENCHMARK_ROW("powercell.rampToFiring()", powercell.rampToFiring(0, false, frameTime));
+  BENCHMARK_ROW("bargraph.idleOne()", bargraph.idleOne(50, frameTime));
+  BENCHMARK_ROW("bargraph.idleTwo()", bargraph.idleTwo(70, frameTime));
+  BENCHMARK_ROW("bargraph.firing()", bargraph.firing(50, frameTime));
+  BENCHMARK_ROW("bargraph.update() (driver write)", bargraph.update());
+  BENCHMARK_ROW("firingRod.fireStrobe()", firingRod.fireStrobe(20, frameTime));
+  BENCHMARK_ROW("random() x4 (fireStrobe() before noise)", { volatile long r = random(0, 7) + random(50, 255) + random(0, 50) + random(50, 255); });
+  BENCHMARK_ROW("firingRod.update()", firingRod.update());
+  BENCHMARK_ROW("indicators.tick()", indicators.tick(frameTime));
+  BENCHMARK_ROW("indicators.update()", indicators.update());
+  BENCHMARK_ROW("packVent.warming()", packVent.warming(16000, false, frameTime));
+#ifdef GPIO_INDICATOR_PIN
+  BENCHMARK_ROW("SoftPwm::step() (timer interrupt body)", SoftPwm::step());
+#endif
+  // Chains outputs only, the latch time between two frames is waited out of the count
+  if (!ledsOutput.isUsart()) {  // USART output is interrupt driven, it can't be timed with interrupts off
+    BENCHMARK_ROW_READY("pack chain show (ledsOutput.showA())", ledsOutput.waitReady(), ledsOutput.showA());
+  }
+  BENCHMARK_ROW_READY("wand chain show (ledsOutput.showB())", ledsOutput.waitReady(), ledsOutput.showB());
+  if (!ledsOutput.isUsart()) {
+    BENCHMARK_ROW_READY("both chains show (ledsOutput.show())", ledsOutput.waitReady(), ledsOutput.show());
+  }
+  BENCHMARK_ROW("player.update()", player.update());
+  // Back to a dark pack before the normal start
+  clearAllLights();
+  powercell.clear();
+  cyclotron->update();
+  powercell.update();
+  packVent.update();
+  wandVent.update();
+  firingRod.update();
+  ledsOutput.show();
+  bargraph.update();
+}
+#endif
+
+#if defined(MEMORY_MONITOR) || defined(WS2812_BLACKOUT_STATS) || defined(GPIO_INDICATOR_PIN)
+void checkSerialCommands() {
+  if (!Serial.available()) {
+    return;
+  }
+  char command = Serial.read();
+#ifdef MEMORY_MONITOR
+  if (command == 'm') {
+    memoryMonitor.printReport(Serial);
+  }
+#endif
+#ifdef WS2812_BLACKOUT_STATS
+  if (command == 'w') {
+    ledsOutput.printStats(Serial);
+  }
+#endif
+#ifdef GPIO_INDICATOR_PIN
+  if (command == 'p') {
+    // Longest soft PWM interrupt since the last 'p', from the timer match to its end
+    Serial.print(F("Soft PWM interrupt max : ")), Serial.print(softPwm.getIsrCycles()), Serial.println(F(" CPU cycles"));
+  }
+#endif
+}
+#endif
+
+#ifdef MEMORY_MONITOR
+void checkMemory() {
+  static bool warned = false;
+  if (!memoryMonitor.update() && !warned) {
+    warned = true;
+    Serial.println(F("MEMORY GUARD MARGIN CROSSED"));
+    memoryMonitor.printReport(Serial);
+#ifdef MEMORY_GUARD_HALT
+    // Stop everything before the stack overwrites the heap
+    player.stop();
+    smoker.smokeOFF(frameTime);
+    rumbler.rumbleOFF(frameTime);
+    packLeds.clear();
+    wandLeds.clear();
+    ledsOutput.show();
+    bargraph.clear();
+    bargraph.update();
+    Serial.flush();
+    while (true) {
+    }
+#endif
+  }
+}
+#endif
+
 void checkPlayThemesMode() {
   static bool themes = false;
   // initiate themes playing
   if (!themes && SWthemes.isON() && checkPlayerCommandDelay()) {
-    lastCommand = millis();
+    lastCommand = frameTime;
     player.setThemesPlaymode();
+    loopingTrack = 0;
     themes = true;
   }
 
@@ -1162,34 +1483,87 @@ void checkPlayThemesMode() {
     // Check Fire button to play next theme, needs a press and release
     static unsigned long pbfirePrev = 0;
     if (PBfire.toggleON()) {
-      pbfirePrev = millis();
+      pbfirePrev = frameTime;
     }
-    if ((PBfire.toggleOFF()) && (millis() - pbfirePrev < 1000)) {
-      lastCommand = millis();
+    if ((PBfire.toggleOFF()) && (frameTime - pbfirePrev < 1000)) {
+      lastCommand = frameTime;
       player.next();
     }
 
     // Check rod button to play previous theme, needs a press and release
     static unsigned long pbrodPrev = 0;
     if (PBrod.toggleON()) {
-      pbrodPrev = millis();
+      pbrodPrev = frameTime;
     }
-    if ((PBrod.toggleOFF()) && (millis() - pbrodPrev < 1000)) {
-      lastCommand = millis();
+    if ((PBrod.toggleOFF()) && (frameTime - pbrodPrev < 1000)) {
+      lastCommand = frameTime;
       player.previous();
     }
 
     // Exit of themes playing, restart playing Pack State TRack
     if (!SWthemes.isON()) {
-      // playThisStateTrack(packState, TRACK_LOOPING[packState]);
+      // playThisStateTrack(packState, trackLooping(packState));
       stageFlag = 0;  // pack state reinitialization
       themes = false;
     }
   }
 }
 
+#ifdef CYC_STYLE_SWITCH
+void beginCyclotronStyle() {
+  uint16_t size = max(cyclotronGB12.bufferSize(), cyclotronAFFE.bufferSize());
+  cyclotronBuffer = new uint8_t[size];
+  uint8_t style = EEPROM.read(CYC_STYLE_EEPROM_ADDR);
+  if (style == CYC_STYLE_GB12) {
+    cyclotron = &cyclotronGB12;
+  } else if (style == CYC_STYLE_AFFE) {
+    cyclotron = &cyclotronAFFE;
+  }
+  cyclotron->begin(cyclotronBuffer);
+}
+
+void checkCyclotronStyleSwitch() {
+  // Both buttons held for CYC_STYLE_HOLD_TIME while the pack is down, themes switch OFF (buttons are for themes)
+  static unsigned long heldStart = 0;
+  static bool switched = false;
+  if (!PBfire.isON() || !PBrod.isON() || SWthemes.isON()) {
+    heldStart = frameTime;
+    switched = false;
+    return;
+  }
+  if (switched || frameTime - heldStart < CYC_STYLE_HOLD_TIME) {
+    return;
+  }
+  // Turn off the old style pixels before its buffer is reused
+  cyclotron->clear();
+  cyclotron->update();
+  bool toAFFE = (cyclotron == &cyclotronGB12);
+  cyclotron = toAFFE ? (Cyclotron *)&cyclotronAFFE : (Cyclotron *)&cyclotronGB12;
+  EEPROM.update(CYC_STYLE_EEPROM_ADDR, toAFFE ? CYC_STYLE_AFFE : CYC_STYLE_GB12);
+  cyclotron->begin(cyclotronBuffer);
+  if (DEBUG) {
+    Serial.println(toAFFE ? "Cyclotron style AF/FE" : "Cyclotron style GB1/GB2");
+  }
+  switched = true;  // one switch per hold
+}
+#endif
+
+uint16_t trackLength(uint8_t track) {
+  return pgm_read_word(&TRACK_LENGTH[track]);
+}
+
+bool trackLooping(uint8_t track) {
+  return (TRACK_LOOPING >> track) & 1;
+}
+
+uint8_t trackMode(uint8_t track) {
+  return pgm_read_byte(&TRACK_MODE[track]);
+}
+
 bool checkIfTrackDoneExit(uint8_t track, uint8_t next_state) {
-  if (!player.isPlaying() || ((millis() - stateStartTime) >= max(0, TRACK_LENGTH[track] - AUDIO_ADVANCE))) {
+  // No advance for overlay tracks : the next one could not be inserted before this one is done
+  uint16_t advance = (trackMode(track) == TRACK_OVERLAY) ? 0 : AUDIO_ADVANCE;
+  if (!player.isPlaying() || ((frameTime - stateStartTime) >= max(0, trackLength(track) - advance))) {
     packState = next_state;
     stageFlag = 0;
     return true;
@@ -1209,7 +1583,7 @@ bool checkIfSwitchExit(bool switch_state, uint8_t next_state) {
 }
 
 bool checkIfTimerExit(uint16_t time, uint8_t next_state) {
-  if (millis() - stateStartTime >= time) {
+  if (frameTime - stateStartTime >= time) {
     packState = next_state;
     stageFlag = 0;
     return true;
@@ -1219,7 +1593,7 @@ bool checkIfTimerExit(uint16_t time, uint8_t next_state) {
 }
 
 bool checkPlayerCommandDelay() {
-  if (millis() - lastCommand > PLAYER_COMMAND_DELAY) {
+  if (frameTime - lastCommand > PLAYER_COMMAND_DELAY) {
     return true;
   } else {
     return false;
@@ -1229,29 +1603,43 @@ bool checkPlayerCommandDelay() {
 void playThisStateTrack(uint8_t track, bool looping) {
 
   if (!SWthemes.isON()) {
-    lastCommand = millis();
-    if (track == STATE_PWD_DOWN)  // Pack is in powered down state
-      player.stop();              // no sound effect
-    else {
-      if (looping) {
+    lastCommand = frameTime;
+    if (track == STATE_PWD_DOWN) {  // Pack is in powered down state
+      player.stop();                // no sound effect
+      loopingTrack = 0;
+    } else if (trackMode(track) == TRACK_OVERLAY) {   // Inserted over the looping track, which keeps going
+      player.insertFileNum(track, trackLength(track));
+    } else if (looping) {
+      if (track != loopingTrack) {
         player.loopFileNum(track);
-      } else {
-        player.playFileNum(track, TRACK_LENGTH[track]);
+        loopingTrack = track;
+      } else if (player.isPlaying()) {  // Same looping track is still going under an overlay track : only stop the overlay
+        player.stopInsert();
       }
+    } else {
+      player.playFileNum(track, trackLength(track));
+      loopingTrack = 0;
     }
   }
 }
 
 void checkPlayModeForThisState(bool looping) {
+  if (trackMode(packState) == TRACK_OVERLAY) {   // Play mode belongs to the looping track under the overlay
+    if (looping && !SWthemes.isON() && !player.isPlaying() && checkPlayerCommandDelay()) {
+      lastCommand = frameTime;
+      player.insertFileNum(packState, trackLength(packState));   // Overlay tracks loop by being inserted again
+    }
+    return;
+  }
   if (looping) {
     if (!cycling && checkPlayerCommandDelay()) {  // Enable looping
-      lastCommand = millis();
+      lastCommand = frameTime;
       player.setCyclingTrackPlaymode();
       cycling = true;
     }
   } else {
     if (cycling && checkPlayerCommandDelay()) {  // Disable looping
-      lastCommand = millis();
+      lastCommand = frameTime;
       player.setSinglePlaymode();
       cycling = false;
     }
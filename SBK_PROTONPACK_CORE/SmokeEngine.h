@@ -29,11 +29,11 @@ public:
            const uint32_t *minOffTime,
            bool exist);
     void begin();
-    void update();
-    void startBurst(uint16_t duration);
+    void update(unsigned long now);
+    void startBurst(uint16_t duration, unsigned long now);
     bool getState();
-    void smokeON();
-    void smokeOFF();
+    void smokeON(unsigned long now);
+    void smokeOFF(unsigned long now);
 
 private:
     bool _exist;
@@ -0,0 +1,161 @@
+/*
+ *  SoftPwmEngine.cpp is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+
+#include "SoftPwmEngine.h"
+
+#if defined(__AVR_ATmega4809__)
+#define SOFTPWM_TIMER
+#define SOFTPWM_TICKS_US (F_CPU / 2000000L) // TCB1 on CLK_PER / 2
+#define SOFTPWM_CYCLES_PER_TICK 2
+#elif defined(__AVR_ATmega328P__)
+#define SOFTPWM_TIMER
+#define SOFTPWM_TICKS_US (F_CPU / 8000000L) // timer 1 prescaler 8
+#define SOFTPWM_CYCLES_PER_TICK 8
+#endif
+
+// Channels, shared with the timer interrupt
+static volatile uint8_t pwmLevel[SOFTPWM_CHANNELS];
+static volatile uint8_t *pwmPort[SOFTPWM_CHANNELS];
+static uint8_t pwmMask[SOFTPWM_CHANNELS];
+static volatile uint8_t pwmChannels = 0;
+static uint8_t pwmBit = 0;
+static volatile uint16_t pwmIsrTicks = 0;
+
+SoftPwm::SoftPwm()
+{
+    _running = false;
+}
+
+bool SoftPwm::begin()
+{
+#if defined(__AVR_ATmega4809__)
+    TCB1.CTRLA = 0;
+    TCB1.CTRLB = TCB_CNTMODE_INT_gc; // periodic interrupt, CNT back to 0 at CCMP
+    TCB1.CCMP = SOFTPWM_BASE_US * SOFTPWM_TICKS_US - 1;
+    TCB1.CNT = 0;
+    TCB1.INTFLAGS = TCB_CAPT_bm;
+    TCB1.INTCTRL = TCB_CAPT_bm;
+    TCB1.CTRLA = TCB_CLKSEL_CLKDIV2_gc | TCB_ENABLE_bm;
+    _running = true;
+#elif defined(__AVR_ATmega328P__)
+    noInterrupts();
+    TCCR1A = 0;
+    TCCR1B = _BV(WGM12) | _BV(CS11); // CTC on OCR1A, prescaler 8
+    OCR1A = SOFTPWM_BASE_US * SOFTPWM_TICKS_US - 1;
+    TCNT1 = 0;
+    TIFR1 = _BV(OCF1A);
+    TIMSK1 = _BV(OCIE1A);
+    interrupts();
+    _running = true;
+#endif
+    return _running;
+}
+
+uint8_t SoftPwm::attach(uint8_t pin)
+{
+    if (pwmChannels >= SOFTPWM_CHANNELS)
+    {
+        return SOFTPWM_NONE;
+    }
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, LOW);
+    uint8_t channel = pwmChannels;
+    pwmLevel[channel] = 0;
+    pwmPort[channel] = portOutputRegister(digitalPinToPort(pin));
+    pwmMask[channel] = digitalPinToBitMask(pin);
+    pwmChannels = channel + 1; // channel ready before the interrupt sees it
+    return channel;
+}
+
+void SoftPwm::setLevel(uint8_t channel, uint8_t level)
+{
+    if (channel >= pwmChannels)
+    {
+        return;
+    }
+    pwmLevel[channel] = level;
+    if (!_running)
+    {
+        // No timer : on/off only
+        if (level & 0x80)
+        {
+            *pwmPort[channel] |= pwmMask[channel];
+        }
+        else
+        {
+            *pwmPort[channel] &= ~pwmMask[channel];
+        }
+    }
+}
+
+uint8_t SoftPwm::getLevel(uint8_t channel)
+{
+    return (channel < pwmChannels) ? pwmLevel[channel] : 0;
+}
+
+bool SoftPwm::isRunning()
+{
+    return _running;
+}
+
+uint16_t SoftPwm::getIsrCycles()
+{
+    noInterrupts();
+    uint16_t ticks = pwmIsrTicks;
+    pwmIsrTicks = 0;
+    interrupts();
+#ifdef SOFTPWM_TIMER
+    return ticks * SOFTPWM_CYCLES_PER_TICK;
+#else
+    return ticks;
+#endif
+}
+
+void SoftPwm::step()
+{
+    uint8_t bit = 1 << pwmBit;
+    uint8_t channels = pwmChannels;
+    for (uint8_t i = 0; i < channels; i++)
+    {
+        if (pwmLevel[i] & bit)
+        {
+            *pwmPort[i] |= pwmMask[i];
+        }
+        else
+        {
+            *pwmPort[i] &= ~pwmMask[i];
+        }
+    }
+#ifdef SOFTPWM_TIMER
+    // The timer restarted from 0 at the match : this bit is shown for 2^bit base times
+    uint16_t top = ((uint16_t)(SOFTPWM_BASE_US * SOFTPWM_TICKS_US) << pwmBit) - 1;
+#if defined(__AVR_ATmega4809__)
+    TCB1.CCMP = top;
+    uint16_t ticks = TCB1.CNT;
+#else
+    OCR1A = top;
+    uint16_t ticks = TCNT1;
+#endif
+    if (ticks > pwmIsrTicks)
+    {
+        pwmIsrTicks = ticks;
+    }
+#endif
+    pwmBit = (pwmBit + 1) & 7;
+}
@@ -0,0 +1,75 @@
+/*
+ *  SoftPwmEngine.h is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+
+#ifndef SOFTPWMENGINE_H
+#define SOFTPWMENGINE_H
+
+#include <Arduino.h>
+
+/*  Dimming of plain LEDs on GPIO pins (up to SOFTPWM_CHANNELS) by bit angle modulation (BAM) : */
+/*  a timer interrupt writes one bit of each channel level to its pin, then waits 2^bit base times */
+/*  before the next bit. 8 interrupts per cycle, whatever the levels, each one a fixed loop on the */
+/*  channels with direct port writes. The animations only write the levels array (setLevel()), */
+/*  the main loop has no PWM work. */
+/*  Base time 16 us : 4.08 ms cycle (245 Hz), the shortest bit is 256 CPU cycles at 16 MHz, more than */
+/*  the interrupt with 8 channels. Timer 1 on ATmega328P (analogWrite() on D9/D10 lost, and BENCHMARK_MODE */
+/*  must run before begin()), TCB1 on ATmega4809 (analogWrite() on D3 lost). Other MCU : pins are on/off. */
+/*  The longest interrupt, from the timer match to its end, is kept in CPU cycles (getIsrCycles()). */
+/*  The interrupt handler is not in SoftPwmEngine.cpp : the sketch adds it with SOFTPWM_TIMER_ISR only */
+/*  when it uses the soft PWM, so other builds keep the timer and its vector. */
+/*  WS2812 outputs with interrupts off stretch the bit being shown : dimmed LEDs may glitch while the */
+/*  chains are sent, unless the pack chain is sent by USART. */
+#define SOFTPWM_CHANNELS 8
+#define SOFTPWM_NONE 0xFF // no channel
+#define SOFTPWM_BASE_US 16 // shortest bit time
+
+#if defined(__AVR_ATmega4809__)
+#define SOFTPWM_TIMER_ISR            \
+    ISR(TCB1_INT_vect)               \
+    {                                \
+        SoftPwm::step();             \
+        TCB1.INTFLAGS = TCB_CAPT_bm; \
+    }
+#elif defined(__AVR_ATmega328P__)
+#define SOFTPWM_TIMER_ISR      \
+    ISR(TIMER1_COMPA_vect) \
+    {                      \
+        SoftPwm::step();   \
+    }
+#else
+#define SOFTPWM_TIMER_ISR
+#endif
+
+class SoftPwm
+{
+public:
+    SoftPwm();
+    bool begin();
+    uint8_t attach(uint8_t pin); // return the channel, SOFTPWM_NONE if all are used
+    void setLevel(uint8_t channel, uint8_t level);
+    uint8_t getLevel(uint8_t channel);
+    bool isRunning();
+    uint16_t getIsrCycles(); // longest interrupt since the last call
+    static void step();      // one bit of all channels, run by the timer interrupt
+
+private:
+    bool _running;
+};
+
+#endif
@@ -31,7 +31,7 @@ Switch::Switch(uint8_t pin, bool reverse) : _pin(pin), _reverse(reverse)
 void Switch::begin()
 {
     pinMode(_pin, INPUT_PULLUP);
-    getState();
+    getState(millis());
 }
 
 void Switch::setDebounce(uint8_t delay){
@@ -39,7 +39,7 @@ void Switch::setDebounce(uint8_t delay){
     _debounceDelay = delay;
 }
 
-bool Switch::getState()
+bool Switch::getState(unsigned long now)
 {
     // Register previous state for toggle functions
     _statePrev = _state;
@@ -58,11 +58,11 @@ bool Switch::getState()
     if (_reading != _readingPrev)
     {
         _readingPrev = _reading;
-        _toggleNow = millis();
+        _toggleNow = now;
     }
 
     // check if reading is maintained for the debounce delay
-    if (millis() - _toggleNow > _debounceDelay)
+    if (now - _toggleNow > _debounceDelay)
     {
         // If true and reading is different from current state, change state
         if (_reading != _state)
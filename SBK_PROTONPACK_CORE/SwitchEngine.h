@@ -27,7 +27,7 @@ public:
     Switch(uint8_t pin, bool reverse);
     void begin();
     void setDebounce(uint8_t delay);
-    bool getState();
+    bool getState(unsigned long now);
     bool isON();
     bool toggleON();
     bool toggleOFF();
@@ -0,0 +1,60 @@
+/*
+ *  TimestepEngine.cpp is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+
+#include "TimestepEngine.h"
+
+Timestep::Timestep()
+{
+    _prevTime = 0;
+}
+
+void Timestep::reset(unsigned long now)
+{
+    _prevTime = now;
+}
+
+// Return the number of steps due at this time, 0 if the interval is not elapsed yet
+uint8_t Timestep::steps(unsigned long now, uint16_t interval)
+{
+    unsigned long elapsed = now - _prevTime;
+    if (elapsed < interval)
+    {
+        return 0;
+    }
+    if (interval == 0)
+    {
+        _prevTime = now;
+        return 1;
+    }
+    // Subtractions only, no long division on AVR
+    uint8_t steps = 0;
+    while (elapsed >= interval && steps < TIMESTEP_MAX_CATCHUP)
+    {
+        elapsed -= interval;
+        steps++;
+    }
+    if (elapsed >= interval)
+    {
+        // Too late to catch up : start again from now
+        _prevTime = now;
+        return 1;
+    }
+    _prevTime = now - elapsed;
+    return steps;
+}
@@ -0,0 +1,43 @@
+/*
+ *  TimestepEngine.h is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+
+#ifndef TIMESTEPENGINE_H
+#define TIMESTEPENGINE_H
+
+#include <Arduino.h>
+
+/*  Fixed timestep for periodic animations : steps() returns how many animation steps are due */
+/*  since the last call and moves its time reference by that many intervals, not to now. */
+/*  A late loop is then caught up on the next call, the animation keeps its speed whatever the loop load. */
+/*  When more than TIMESTEP_MAX_CATCHUP steps are due, the animation was not running (or the MCU was */
+/*  stalled far too long) : the time reference is moved to now and only one step is returned. */
+#define TIMESTEP_MAX_CATCHUP 8 // most steps run in one call to catch up a late loop
+
+class Timestep
+{
+public:
+    Timestep();
+    void reset(unsigned long now);
+    uint8_t steps(unsigned long now, uint16_t interval);
+
+private:
+    unsigned long _prevTime;
+};
+
+#endif
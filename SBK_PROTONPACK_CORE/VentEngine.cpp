@@ -21,6 +21,7 @@
 Vent::Vent(Adafruit_NeoPixel &strip, uint8_t start, uint8_t end)
   : _strip(strip), _start(start), _end(end) {
   _prevTime = 0;
+  _rampStartTime = 0;
   _prevTimeRed = 0;
   _prevTimeGreen = 0;
   _prevTimeBlue = 0;
@@ -28,6 +29,9 @@ Vent::Vent(Adafruit_NeoPixel &strip, uint8_t start, uint8_t end)
   _redTracker = 0;
   _greenTracker = 0;
   _blueTracker = 0;
+  _seq.line = CO_DONE;
+  _seq.first = false;
+  _seq.start = 0;
 }
 
 void Vent::begin() {
@@ -55,10 +59,9 @@ void Vent::setColor(uint8_t red, uint8_t green, uint8_t blue) {
   _blueTracker = blue;
 }
 
-bool Vent::rampToRed(int16_t ramp_time, bool init) {
-  static unsigned long rampStartTime;
+bool Vent::rampToRed(int16_t ramp_time, bool init, unsigned long now) {
   if (init) {
-    rampStartTime = millis();
+    _rampStartTime = now;
   }
   int16_t redTarget = 255;
   int16_t greenTarget = 0;
@@ -68,21 +71,20 @@ bool Vent::rampToRed(int16_t ramp_time, bool init) {
   int16_t greenIncrement = 5;
   int16_t blueIncrement = 5;
 
-  _rampColor(&_redTracker, ramp_time, init, &_initRedTracker, redTarget, &_intervalRed, redIncrement, &_prevTimeRed);
-  _rampColor(&_greenTracker, ramp_time, init, &_initGreenTracker, greenTarget, &_intervalGreen, greenIncrement, &_prevTimeGreen);
-  _rampColor(&_blueTracker, ramp_time, init, &_initBlueTracker, blueTarget, &_intervalBlue, blueIncrement, &_prevTimeBlue);
+  _rampColor(&_redTracker, ramp_time, init, &_initRedTracker, redTarget, &_intervalRed, redIncrement, &_prevTimeRed, now);
+  _rampColor(&_greenTracker, ramp_time, init, &_initGreenTracker, greenTarget, &_intervalGreen, greenIncrement, &_prevTimeGreen, now);
+  _rampColor(&_blueTracker, ramp_time, init, &_initBlueTracker, blueTarget, &_intervalBlue, blueIncrement, &_prevTimeBlue, now);
 
-  if ((_redTracker == redTarget && _greenTracker == greenTarget && _blueTracker == blueTarget) || (millis() - rampStartTime > ramp_time)) {
+  if ((_redTracker == redTarget && _greenTracker == greenTarget && _blueTracker == blueTarget) || (now - _rampStartTime > ramp_time)) {
     return true;
   } else {
     return false;
   }
 }
 
-bool Vent::rampToOrange(int16_t ramp_time, bool init) {
-  static unsigned long rampStartTime;
+bool Vent::rampToOrange(int16_t ramp_time, bool init, unsigned long now) {
   if (init) {
-    rampStartTime = millis();
+    _rampStartTime = now;
   }
 
   int16_t redTarget = 255;
@@ -93,21 +95,20 @@ bool Vent::rampToOrange(int16_t ramp_time, bool init) {
   int16_t greenIncrement = 5;
   int16_t blueIncrement = 5;
 
-  _rampColor(&_redTracker, ramp_time, init, &_initRedTracker, redTarget, &_intervalRed, redIncrement, &_prevTimeRed);
-  _rampColor(&_greenTracker, ramp_time, init, &_initGreenTracker, greenTarget, &_intervalGreen, greenIncrement, &_prevTimeGreen);
-  _rampColor(&_blueTracker, ramp_time, init, &_initBlueTracker, blueTarget, &_intervalBlue, blueIncrement, &_prevTimeBlue);
+  _rampColor(&_redTracker, ramp_time, init, &_initRedTracker, redTarget, &_intervalRed, redIncrement, &_prevTimeRed, now);
+  _rampColor(&_greenTracker, ramp_time, init, &_initGreenTracker, greenTarget, &_intervalGreen, greenIncrement, &_prevTimeGreen, now);
+  _rampColor(&_blueTracker, ramp_time, init, &_initBlueTracker, blueTarget, &_intervalBlue, blueIncrement, &_prevTimeBlue, now);
 
-  if ((_redTracker == redTarget && _greenTracker == greenTarget && _blueTracker == blueTarget) || (millis() - rampStartTime > ramp_time)) {
+  if ((_redTracker == redTarget && _greenTracker == greenTarget && _blueTracker == blueTarget) || (now - _rampStartTime > ramp_time)) {
     return true;
   } else {
     return false;
   }
 }
 
-bool Vent::rampToCoolBlue(int16_t ramp_time, bool init) {
-  static unsigned long rampStartTime;
+bool Vent::rampToCoolBlue(int16_t ramp_time, bool init, unsigned long now) {
   if (init) {
-    rampStartTime = millis();
+    _rampStartTime = now;
   }
   int16_t redTarget = 50;
   int16_t greenTarget = 50;
@@ -117,37 +118,36 @@ bool Vent::rampToCoolBlue(int16_t ramp_time, bool init) {
   int16_t greenIncrement = 5;
   int16_t blueIncrement = 5;
 
-  _rampColor(&_redTracker, ramp_time, init, &_initRedTracker, redTarget, &_intervalRed, redIncrement, &_prevTimeRed);
-  _rampColor(&_greenTracker, ramp_time, init, &_initGreenTracker, greenTarget, &_intervalGreen, greenIncrement, &_prevTimeGreen);
-  _rampColor(&_blueTracker, ramp_time, init, &_initBlueTracker, blueTarget, &_intervalBlue, blueIncrement, &_prevTimeBlue);
+  _rampColor(&_redTracker, ramp_time, init, &_initRedTracker, redTarget, &_intervalRed, redIncrement, &_prevTimeRed, now);
+  _rampColor(&_greenTracker, ramp_time, init, &_initGreenTracker, greenTarget, &_intervalGreen, greenIncrement, &_prevTimeGreen, now);
+  _rampColor(&_blueTracker, ramp_time, init, &_initBlueTracker, blueTarget, &_intervalBlue, blueIncrement, &_prevTimeBlue, now);
 
-  if ((_redTracker == redTarget && _greenTracker == greenTarget && _blueTracker == blueTarget) || (millis() - rampStartTime > ramp_time)) {
+  if ((_redTracker == redTarget && _greenTracker == greenTarget && _blueTracker == blueTarget) || (now - _rampStartTime > ramp_time)) {
     return true;
   } else {
     return false;
   }
 }
 
-bool Vent::fadeOut(int16_t ramp_time, bool init) {
-  static unsigned long rampStartTime;
+bool Vent::fadeOut(int16_t ramp_time, bool init, unsigned long now) {
   if (init) {
-    rampStartTime = millis();
+    _rampStartTime = now;
   }
   int16_t redIncrement = 5;
   int16_t greenIncrement = 5;
   int16_t blueIncrement = 5;
 
-  _rampColor(&_redTracker, ramp_time, init, &_initRedTracker, 0, &_intervalRed, redIncrement, &_prevTimeRed);
-  _rampColor(&_greenTracker, ramp_time, init, &_initGreenTracker, 0, &_intervalGreen, greenIncrement, &_prevTimeGreen);
-  _rampColor(&_blueTracker, ramp_time, init, &_initBlueTracker, 0, &_intervalBlue, blueIncrement, &_prevTimeBlue);
-  if ((_redTracker == 0 && _greenTracker == 0 && _blueTracker == 0) || (millis() - rampStartTime > ramp_time)) {
+  _rampColor(&_redTracker, ramp_time, init, &_initRedTracker, 0, &_intervalRed, redIncrement, &_prevTimeRed, now);
+  _rampColor(&_greenTracker, ramp_time, init, &_initGreenTracker, 0, &_intervalGreen, greenIncrement, &_prevTimeGreen, now);
+  _rampColor(&_blueTracker, ramp_time, init, &_initBlueTracker, 0, &_intervalBlue, blueIncrement, &_prevTimeBlue, now);
+  if ((_redTracker == 0 && _greenTracker == 0 && _blueTracker == 0) || (now - _rampStartTime > ramp_time)) {
     return true;
   } else {
     return false;
   }
 }
 
-bool Vent::_rampColor(int16_t *colorTracker, int16_t rampTime, bool init, int16_t *initTracker, int16_t tg, int16_t *interval, int16_t increment, unsigned long *prevTime) {
+bool Vent::_rampColor(int16_t *colorTracker, int16_t rampTime, bool init, int16_t *initTracker, int16_t tg, int16_t *interval, int16_t increment, unsigned long *prevTime, unsigned long now) {
   // Record initial vent color trackers
   if (init) {
     *initTracker = *colorTracker;
@@ -170,8 +170,8 @@ bool Vent::_rampColor(int16_t *colorTracker, int16_t rampTime, bool init, int16_
 
     // Update color tracker
     if (*colorTracker != tg) {
-      if (millis() - *prevTime >= *interval) {
-        *prevTime = millis();
+      if (now - *prevTime >= *interval) {
+        *prevTime = now;
         *colorTracker = _ramp_parameter(*colorTracker, *initTracker, tg, increment);
       }
     }
@@ -201,89 +201,60 @@ int16_t Vent::_ramp_parameter(int16_t param, int16_t ini, int16_t tg, int16_t in
 }
 
 
-void Vent::cooling(int16_t ramp_time, int16_t fadeOut_time, bool init) {
-
-  static bool rampToBlueDone = false;
-  static bool fadeOutInit = false;
-
-  // reset the sequence if init is true
-  if (init) { rampToBlueDone = false; }
-
-  // ramp to cool blue phase
-  if (!rampToBlueDone) {
-    if (rampToCoolBlue(ramp_time, init)) {
-      rampToBlueDone = true;
-      fadeOutInit = true;
-    };
-  } else {
-    // Fade out phase
-    fadeOut(fadeOut_time, fadeOutInit);
-    if (fadeOutInit) {
-      fadeOutInit = false;
-    }
+bool Vent::cooling(int16_t ramp_time, int16_t fadeOut_time, bool init, unsigned long now) {
+  // 2 phases animation : ramp to cool blue, fade out.
+  if (init) {
+    CO_RESET(_seq);
   }
+  CO_BEGIN(_seq);
+  CO_AWAIT(_seq, rampToCoolBlue(ramp_time, CO_FIRST(_seq), now));
+  CO_AWAIT(_seq, fadeOut(fadeOut_time, CO_FIRST(_seq), now) && _isOff());
+  CO_END(_seq);
 }
 
-void Vent::shutdown(int16_t red_ramp_time, int16_t blue_ramp_time, int16_t fadeOut_time, bool init) {
-// 3 phases animation : ramp to red, ramp to cool blue, fade out.
-
-  static bool rampToRedDone = false;
-  static bool rampToBlueInit = false;
-  static bool rampToBlueDone = false;
-  static bool fadeOutInit = false;
-
-  // reset the sequence if init is true
+bool Vent::shutdown(int16_t red_ramp_time, int16_t blue_ramp_time, int16_t fadeOut_time, bool init, unsigned long now) {
+  // 3 phases animation : ramp to red, ramp to cool blue, fade out.
   if (init) {
-    rampToRedDone = false;
-    rampToBlueDone = false;
+    CO_RESET(_seq);
   }
+  CO_BEGIN(_seq);
+  CO_AWAIT(_seq, rampToRed(red_ramp_time, CO_FIRST(_seq), now));
+  CO_AWAIT(_seq, rampToCoolBlue(blue_ramp_time, CO_FIRST(_seq), now));
+  CO_AWAIT(_seq, fadeOut(fadeOut_time, CO_FIRST(_seq), now) && _isOff());
+  CO_END(_seq);
+}
 
-  // Ramp to red phase
-  if (!rampToRedDone && !rampToBlueDone) {
-    if (rampToRed(red_ramp_time, init)) {
-      rampToRedDone = true;
-      rampToBlueInit = true;
-    };
-  }
-  // Ramp to cool blue phase
-  else if (rampToRedDone && !rampToBlueDone) {
-    if (rampToCoolBlue(blue_ramp_time, rampToBlueInit)) {
-      rampToBlueDone = true;
-      fadeOutInit = true;
-    };
-    rampToBlueInit = false;
-  }
-  // Fade out phase
-  else {
-    fadeOut(fadeOut_time, fadeOutInit);
-    fadeOutInit = false;
+bool Vent::boot(int16_t boot_time, bool init, unsigned long now) {
+  // 2 phases animation : colors left by the last sequence fade out in the first 30% of boot time, dark until the end.
+  int16_t increment = 10;
+  int16_t fadeoutTime = (uint32_t)boot_time * 30 * increment / 100;
+  if (init) {
+    CO_RESET(_seq);
   }
+  CO_BEGIN(_seq);
+  CO_AWAIT(_seq, _rampColor(&_redTracker, fadeoutTime, CO_FIRST(_seq), &_initRedTracker, 0, &_intervalRed, increment, &_prevTimeRed, now)
+                   & _rampColor(&_greenTracker, fadeoutTime, CO_FIRST(_seq), &_initGreenTracker, 0, &_intervalGreen, increment, &_prevTimeGreen, now)
+                   & _rampColor(&_blueTracker, fadeoutTime, CO_FIRST(_seq), &_initBlueTracker, 0, &_intervalBlue, increment, &_prevTimeBlue, now));
+  CO_WAIT(_seq, (uint32_t)boot_time * 70 / 100, now);
+  CO_END(_seq);
+}
 
+bool Vent::warming(int16_t warming_time, bool init, unsigned long now) {
+  // 2 phases animation : blue and green fade out in the first 10% of warming time, then red fades in until 75%.
+  int16_t redIncrement = 1;
+  int16_t blueIncrement = 10;
+  int16_t blueFadeOutTime = (uint32_t)warming_time * 10 * blueIncrement / 100;
+  int16_t redFadeInTime = (uint32_t)warming_time * 65 * redIncrement / 100;
+  if (init) {
+    CO_RESET(_seq);
   }
-
-
-  /*
-
-REMOVED ANIMATIONS BECAUSE THEY SEEMS TO CREATE BUGS
-
-void Vent::boot(int16_t boot_time, bool init)
-{
-    int16_t increment = 10;
-    int16_t fadeoutTime = (uint32_t)boot_time * 30 * increment / 100;
-
-    // Fade out vent
-    _rampColor(&_redTracker, fadeoutTime, init, &_initRedTracker, 0, &_intervalRed, increment, &_prevTimeRed);
-    _rampColor(&_blueTracker, fadeoutTime, init, &_initBlueTracker, 0, &_intervalBlue, increment, &_prevTimeBlue);
+  CO_BEGIN(_seq);
+  CO_AWAIT(_seq, _rampColor(&_blueTracker, blueFadeOutTime, CO_FIRST(_seq), &_initBlueTracker, 0, &_intervalBlue, blueIncrement, &_prevTimeBlue, now)
+                   & _rampColor(&_greenTracker, blueFadeOutTime, CO_FIRST(_seq), &_initGreenTracker, 0, &_intervalGreen, blueIncrement, &_prevTimeGreen, now));
+  CO_AWAIT(_seq, _rampColor(&_redTracker, redFadeInTime, CO_FIRST(_seq), &_initRedTracker, 255, &_intervalRed, redIncrement, &_prevTimeRed, now));
+  CO_END(_seq);
 }
 
-void Vent::warming(int16_t warming_time, bool init)
-{
-    int16_t redIncrement = 1;
-    int16_t blueIncrement = 10;
-    int16_t redFadeInTime = (uint32_t)warming_time * 75 * redIncrement / 100;
-    int16_t blueFadeOutTime = (uint32_t)warming_time * 10 * blueIncrement / 100;
-    _rampColor(&_redTracker, redFadeInTime, init, &_initRedTracker, 255, &_intervalRed, redIncrement, &_prevTimeRed);
-    _rampColor(&_blueTracker, blueFadeOutTime, init, &_initBlueTracker, 0, &_intervalBlue, blueIncrement, &_prevTimeBlue);
+bool Vent::_isOff() {
+  return _redTracker == 0 && _greenTracker == 0 && _blueTracker == 0;
 }
-
-*/
\ No newline at end of file
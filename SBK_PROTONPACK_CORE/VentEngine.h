@@ -21,6 +21,7 @@
 
 #include <Arduino.h>
 #include <Adafruit_NeoPixel.h>
+#include "CoroutineEngine.h"
 
 class Vent
 {
@@ -30,21 +31,24 @@ public:
     void update();
     void clear();
     void setColor(uint8_t red, uint8_t green, uint8_t blue);
-    bool rampToCoolBlue(int16_t ramp_time, bool init);
-    bool rampToRed(int16_t ramp_time, bool init);
-    bool rampToOrange(int16_t ramp_time, bool init);
-    bool fadeOut(int16_t ramp_time, bool init);
-    // REMOVED ANIMATIONS BECAUSE THEY SEEMS TO CREATE BUGS
-    // void boot(int16_t boot_time, bool init);
-    // void warming(int16_t warming_time, bool init);
-    void cooling(int16_t ramp_time, int16_t fadeOut_time, bool init);
-    void shutdown(int16_t red_ramp_time, int16_t blue_ramp_time, int16_t fadeOut_time, bool init);
+    bool rampToCoolBlue(int16_t ramp_time, bool init, unsigned long now);
+    bool rampToRed(int16_t ramp_time, bool init, unsigned long now);
+    bool rampToOrange(int16_t ramp_time, bool init, unsigned long now);
+    bool fadeOut(int16_t ramp_time, bool init, unsigned long now);
+    // Multi-steps sequences, one at a time : restarted by init, return true when done
+    bool boot(int16_t boot_time, bool init, unsigned long now);
+    bool warming(int16_t warming_time, bool init, unsigned long now);
+    bool cooling(int16_t ramp_time, int16_t fadeOut_time, bool init, unsigned long now);
+    bool shutdown(int16_t red_ramp_time, int16_t blue_ramp_time, int16_t fadeOut_time, bool init, unsigned long now);
 
 private:
-    bool _rampColor(int16_t *colorTracker, int16_t rampTime, bool init, int16_t *initTracker, int16_t tg, int16_t *interval, int16_t increment, unsigned long *prevTime);
+    bool _rampColor(int16_t *colorTracker, int16_t rampTime, bool init, int16_t *initTracker, int16_t tg, int16_t *interval, int16_t increment, unsigned long *prevTime, unsigned long now);
     int16_t _ramp_parameter(int16_t color, int16_t ini, int16_t tg, int16_t incr);
+    bool _isOff();
     Adafruit_NeoPixel &_strip;
+    Coroutine _seq;
     unsigned long _prevTime;
+    unsigned long _rampStartTime; // start of the running ramp, one at a time
     unsigned long _prevTimeRed;
     unsigned long _prevTimeGreen;
     unsigned long _prevTimeBlue;
@@ -0,0 +1,158 @@
+/*
+ *  VolumePotEngine.cpp is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+#include "VolumePotEngine.h"
+
+#if defined(__AVR_ATmega4809__) || defined(__AVR_ATmega328P__)
+#define VOLPOT_FREERUN
+#endif
+
+// Filtered pot reading, 10 bits reading x 16 (fixed point with 4 fractional bits).
+// IIR low pass : filtered += (16 x sample - filtered) / 8, done with shifts only.
+static volatile uint16_t potFiltered = 0;
+
+static inline void potFilterSample(uint16_t sample)
+{
+    potFiltered = potFiltered - (potFiltered >> 3) + (sample << 1);
+}
+
+#if defined(__AVR_ATmega4809__)
+ISR(ADC0_RESRDY_vect)
+{
+    potFilterSample(ADC0.RES); // reading the result clears the interrupt flag
+}
+#elif defined(__AVR_ATmega328P__)
+ISR(ADC_vect)
+{
+    potFilterSample(ADC);
+}
+#endif
+
+VolumePot::VolumePot()
+{
+    _active = false;
+    _pin = 0;
+    _max = 0;
+    _level = 0;
+    _prevRead = 0;
+}
+
+void VolumePot::begin(uint8_t pin, uint8_t max)
+{
+    _pin = pin;
+    _max = max;
+    pinMode(pin, INPUT);
+    // Start the filter at the actual pot position
+    uint16_t reading = analogRead(pin);
+    potFiltered = reading << 4;
+    _level = _levelAt(reading << 4);
+    _active = true;
+
+#if defined(__AVR_ATmega4809__)
+    // Free-running conversions, slowed down to about 1 kHz : prescaler 256 and longest sampling delays
+    ADC0.CTRLA &= ~ADC_ENABLE_bm;
+    ADC0.MUXPOS = digitalPinToAnalogInput(pin);
+    ADC0.CTRLC = (ADC0.CTRLC & ~ADC_PRESC_gm) | ADC_PRESC_DIV256_gc;
+    ADC0.CTRLD = (ADC0.CTRLD & ~ADC_SAMPDLY_gm) | (15 << ADC_SAMPDLY_gp);
+    ADC0.SAMPCTRL = 31;
+    ADC0.INTCTRL = ADC_RESRDY_bm;
+    ADC0.CTRLA = ADC_ENABLE_bm | ADC_FREERUN_bm;
+    ADC0.COMMAND = ADC_STCONV_bm;
+#elif defined(__AVR_ATmega328P__)
+    // Conversions triggered by timer 0 overflow (the millis() tick), about 1 kHz
+    if (pin >= A0)
+    {
+        pin -= A0;
+    }
+    ADMUX = _BV(REFS0) | (pin & 0x07);
+    ADCSRB = _BV(ADTS2);
+    ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+#endif
+}
+
+// Return true when the settled volume level changed
+bool VolumePot::update()
+{
+    if (!_active)
+    {
+        return false;
+    }
+
+#ifndef VOLPOT_FREERUN
+    if (millis() - _prevRead < VOLPOT_READ_DELAY)
+    {
+        return false;
+    }
+    _prevRead = millis();
+    potFilterSample(analogRead(_pin));
+#endif
+
+    noInterrupts();
+    uint16_t filtered = potFiltered;
+    interrupts();
+
+    uint8_t level = _levelAt(filtered);
+    if (level == _level)
+    {
+        return false;
+    }
+    // Hysteresis : the new level must still be reached with the reading moved back by the margin
+    if (level > _level)
+    {
+        level = _levelAt(filtered > (VOLPOT_HYSTERESIS << 4) ? filtered - (VOLPOT_HYSTERESIS << 4) : 0);
+        if (level <= _level)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        level = _levelAt(filtered + (VOLPOT_HYSTERESIS << 4));
+        if (level >= _level)
+        {
+            return false;
+        }
+    }
+    _level = level;
+    return true;
+}
+
+uint8_t VolumePot::getLevel()
+{
+    return _level;
+}
+
+bool VolumePot::isActive()
+{
+    return _active;
+}
+
+// Same as map(reading, VOLPOT_LOW, VOLPOT_HIGH, 0, max) on the filtered reading, without long math
+uint8_t VolumePot::_levelAt(uint16_t filtered)
+{
+    uint16_t reading = filtered >> 4;
+    if (reading <= VOLPOT_LOW)
+    {
+        return 0;
+    }
+    if (reading >= VOLPOT_HIGH)
+    {
+        return _max;
+    }
+    return (uint16_t)(reading - VOLPOT_LOW) * _max / (VOLPOT_HIGH - VOLPOT_LOW);
+}
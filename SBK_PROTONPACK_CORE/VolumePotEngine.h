@@ -0,0 +1,52 @@
+/*
+ *  VolumePotEngine.h is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+#ifndef VOLUMEPOTENGINE_H
+#define VOLUMEPOTENGINE_H
+
+#include <Arduino.h>
+
+/*  Volume potentiometer read without blocking the main loop : */
+/*  on ATmega4809 (Nano Every) and ATmega328P (Nano), the ADC runs by itself and each sample */
+/*  is filtered in its interrupt, on other MCU the pot is read with analogRead() every VOLPOT_READ_DELAY. */
+/*  The filtered value is turned into a volume level with hysteresis, so the level only changes */
+/*  when the pot is really moved, not when noise sits on a level boundary. */
+#define VOLPOT_LOW 10        // pot reading for volume 0
+#define VOLPOT_HIGH 1000     // pot reading for max volume
+#define VOLPOT_HYSTERESIS 6  // pot reading margin to cross before changing level
+#define VOLPOT_READ_DELAY 20 // ms between analogRead() when no free-running ADC is available
+
+class VolumePot
+{
+public:
+    VolumePot();
+    void begin(uint8_t pin, uint8_t max);
+    bool update();
+    uint8_t getLevel();
+    bool isActive();
+
+private:
+    uint8_t _levelAt(uint16_t filtered);
+    bool _active;
+    uint8_t _pin;
+    uint8_t _max;
+    uint8_t _level;
+    unsigned long _prevRead;
+};
+
+#endif
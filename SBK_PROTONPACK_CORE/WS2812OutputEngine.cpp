@@ -0,0 +1,803 @@
+/*
+ *  WS2812OutputEngine.cpp is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+#include "WS2812OutputEngine.h"
+
+#if defined(__AVR__) && (F_CPU == 16000000L)
+#define WS2812_PARALLEL_CAPABLE // this MCU can build the parallel output, used when ACONFIG.h sets WS2812_PARALLEL
+/*  Bit timing at 16 MHz, 20 cycles (1.25 us) per bit : both pins high -> 0 bits low after T0H cycles */
+/*  -> 1 bits low after T1H cycles. ST takes 2 cycles on ATmega328P (AVRe) and 1 cycle on ATmega4809 (AVRxt), */
+/*  NOPs make up the difference : T0H is 7 cycles (0.44 us) on AVRe and 6 cycles (0.375 us) on AVRxt, */
+/*  T1H is 13 cycles (0.81 us) and the bit 20 cycles on both. */
+/*  Cycles count per bit, s = ST cycles : */
+/*    high  : st(s) mov(1) sbrc/or(2) sbrc/or(2)                      = s + 5         */
+/*    0->1  : st(s) lsl(1) lsl(1) dec(1) NOP_1H                       = s + 3 + NOP_1H */
+/*    low   : st(s) NOP_L brne(2)                                     = s + 2 + NOP_L  */
+#if defined(__AVR_XMEGA__)
+#define WS2812_CYCLES_ST 1
+#define WS2812_NOPS_1H 3
+#define WS2812_NOPS_L 4
+#else
+#define WS2812_CYCLES_ST 2
+#define WS2812_NOPS_1H 1
+#define WS2812_NOPS_L 3
+#endif
+#define WS2812_CYCLES_T0H (WS2812_CYCLES_ST + 5)                                      // high time of 0 bits
+#define WS2812_CYCLES_T1H (WS2812_CYCLES_T0H + WS2812_CYCLES_ST + 3 + WS2812_NOPS_1H) // high time of 1 bits
+#define WS2812_CYCLES_BIT (WS2812_CYCLES_T1H + WS2812_CYCLES_ST + 2 + WS2812_NOPS_L)  // bit period
+/*  NOPs asm from their count */
+#define WS2812_NOP_1 "nop\n\t"
+#define WS2812_NOP_2 WS2812_NOP_1 WS2812_NOP_1
+#define WS2812_NOP_3 WS2812_NOP_2 WS2812_NOP_1
+#define WS2812_NOP_4 WS2812_NOP_3 WS2812_NOP_1
+#define WS2812_NOPS_ASM(n) WS2812_NOP_##n
+#define WS2812_NOPS(n) WS2812_NOPS_ASM(n)
+#endif
+#define WS2812_LATCH 300 // us, reset time between frames
+#define WS2812_US_PER_BYTE 10 // us to send one pixel byte, 8 bits of 1.25 us, interrupts off
+#define WS2812_DITHER_US_PER_BYTE 11 // us to dither and send again one pixel byte
+
+/*  Linear toe under the gamma curve : at least level / 4 out, so the low levels stay distinct instead of */
+/*  all turning into 0 or 1. The toe meets the gamma curve at level 107 (output 27). */
+#define WS2812_TOE 4
+/*  Gamma 2.6 (same as Adafruit_NeoPixel::gamma8()) of the dithered levels, 8.8 fixed point */
+static const uint16_t WS2812_GAMMA16[WS2812_DITHER_LEVELS] PROGMEM = {
+    0, 0, 0, 1, 1, 2, 4, 6,
+    8, 11, 14, 18, 23, 28, 34, 41,
+    49, 57, 66, 76, 87, 99, 112, 125,
+    140, 156, 172, 190, 209, 229, 250, 272,
+    296, 321, 346, 374, 402, 432, 463, 495,
+    529, 564, 600, 638, 677, 718, 760, 804,
+    849, 896, 944, 994, 1046, 1099, 1153, 1210,
+    1268, 1328, 1389, 1452, 1517, 1584, 1652, 1722};
+
+/*  WS2812B datasheet timings, ns : T0H 400, T1H 800, T0L 850, T1L 450, all +/- 150, bit period 1250 +/- 600. */
+/*  Checked at compile time for the parallel output and the USART output bit timings. Both have a T1L */
+/*  (438 and 375 ns) under the 450 ns minimum of the original WS2812 : WS2812B or later parts are assumed. */
+#define WS2812_NS(cycles) ((cycles) * 1000000L / (F_CPU / 1000L))
+#define WS2812_IN_RANGE(ns, typ) ((ns) >= (typ) - 150 && (ns) <= (typ) + 150)
+#define WS2812_IN_SPEC(t0h, t1h, bit) (WS2812_IN_RANGE(t0h, 400) && WS2812_IN_RANGE(t1h, 800) &&                 \
+                                       WS2812_IN_RANGE((bit) - (t0h), 850) && WS2812_IN_RANGE((bit) - (t1h), 450) && \
+                                       (bit) >= 650 && (bit) <= 1850)
+#ifdef WS2812_PARALLEL_CAPABLE
+static_assert(WS2812_IN_SPEC(WS2812_NS(WS2812_CYCLES_T0H), WS2812_NS(WS2812_CYCLES_T1H), WS2812_NS(WS2812_CYCLES_BIT)),
+              "WS2812 parallel output bit timing out of spec");
+static_assert(WS2812_NS(WS2812_CYCLES_BIT) * 8 <= WS2812_US_PER_BYTE * 1000L, "WS2812 parallel output slower than WS2812_US_PER_BYTE");
+#endif
+
+/*  WS2812 symbols for USART SPI output : 4 bits nibble -> 12 SPI bits, WS2812 bit 0 = 100, bit 1 = 110 */
+static const uint16_t WS2812_SYMBOLS[16] PROGMEM = {
+    0x924, 0x926, 0x934, 0x936, 0x9A4, 0x9A6, 0x9B4, 0x9B6,
+    0xD24, 0xD26, 0xD34, 0xD36, 0xDA4, 0xDA6, 0xDB4, 0xDB6};
+
+#if defined(__AVR_ATmega4809__)
+#define WS2812_USART_CAPABLE // this MCU can send chain A by USART, used when ACONFIG.h sets WS2812_USART
+/*  SPI clock = F_CPU / (2 x 3) = 2.67 MHz at 16 MHz (MSPI baud has no fractional part, 2.4 MHz is not possible) */
+/*  375 ns per SPI bit : 0 bits are 375 ns high, 1 bits are 750 ns high, 1.125 us per WS2812 bit. */
+#define WS2812_USART_BAUD (3 << 6)
+#define WS2812_USART_US_PER_BYTE 9 // us to send one pixel byte (24 SPI bits)
+static_assert(WS2812_IN_SPEC(WS2812_NS(6), WS2812_NS(12), WS2812_NS(18)), // 1, 2 and 3 SPI bits of 6 cycles
+              "WS2812 USART output bit timing out of spec");
+static USART_t *ws2812Usart = 0;
+static const uint8_t *ws2812Next = 0;
+static uint16_t ws2812Left = 0;
+static volatile bool ws2812Busy = false;
+
+static inline void ws2812UsartSend()
+{
+    if (ws2812Left > 0)
+    {
+        ws2812Usart->TXDATAL = *ws2812Next++;
+        ws2812Left--;
+    }
+    else
+    {
+        ws2812Usart->CTRLA &= ~USART_DREIE_bm; // frame done
+        ws2812Busy = false;
+    }
+}
+
+ISR(USART0_DRE_vect)
+{
+    ws2812UsartSend();
+}
+
+ISR(USART2_DRE_vect)
+{
+    ws2812UsartSend();
+}
+#endif
+
+WS2812Output::WS2812Output(Adafruit_NeoPixel &stripA, Adafruit_NeoPixel &stripB)
+    : _stripA(stripA), _stripB(stripB)
+{
+    _parallel = false;
+    _usart = false;
+    _symbols = 0;
+    _port = 0;
+    _maskA = 0;
+    _maskB = 0;
+    _endTime = 0;
+    _uartByteUs = 0;
+    _uartSoft = false;
+    _blackouts = 0;
+    _lossBlackouts = 0;
+    _bytesLost = 0;
+    _blackoutMax = 0;
+    for (uint8_t chain = 0; chain < 2; chain++)
+    {
+        _lut[chain] = 0;
+        _brightness[chain] = 255;
+        _balance[chain][0] = 255;
+        _balance[chain][1] = 255;
+        _balance[chain][2] = 255;
+        _frac[chain] = 0;
+        _dither[chain] = 0;
+        _lowLevels[chain] = false;
+        _from[chain] = 0;
+        _last[chain] = 0;
+        _fadeStart[chain] = 0;
+        _fadeTime[chain] = 0;
+    }
+    clearOverlays(WS2812_CHAIN_A);
+    clearOverlays(WS2812_CHAIN_B);
+}
+
+void WS2812Output::begin(bool usart)
+{
+    if (usart && _beginUsart())
+    {
+        _usart = true;
+    }
+}
+
+// Both chains in one pass, false if their pins are not on the same port or chain A is sent by USART
+bool WS2812Output::beginParallel()
+{
+#ifdef WS2812_PARALLEL_CAPABLE
+    int16_t pinA = _stripA.getPin();
+    int16_t pinB = _stripB.getPin();
+    if (!_usart && pinA >= 0 && pinB >= 0 && pinA != pinB && digitalPinToPort(pinA) == digitalPinToPort(pinB))
+    {
+        _port = portOutputRegister(digitalPinToPort(pinA));
+        _maskA = digitalPinToBitMask(pinA);
+        _maskB = digitalPinToBitMask(pinB);
+        _parallel = true;
+    }
+#endif
+    return _parallel;
+}
+
+bool WS2812Output::isParallel()
+{
+    return _parallel;
+}
+
+bool WS2812Output::isUsart()
+{
+    return _usart;
+}
+
+void WS2812Output::show()
+{
+    if (_parallel)
+    {
+        _applyColorStage(WS2812_CHAIN_A);
+        _applyColorStage(WS2812_CHAIN_B);
+        _showParallel();
+    }
+    else
+    {
+        showA();
+        showB();
+    }
+}
+
+void WS2812Output::showA()
+{
+    _applyColorStage(WS2812_CHAIN_A);
+    _sendA();
+}
+
+void WS2812Output::showB()
+{
+    _applyColorStage(WS2812_CHAIN_B);
+    _sendB();
+}
+
+// Wait for the last outputs to be sent and latched, so the next show starts at once
+void WS2812Output::waitReady()
+{
+#ifdef WS2812_USART_CAPABLE
+    while (ws2812Busy)
+    {
+    }
+#endif
+    while ((long)(micros() - _endTime) < WS2812_LATCH || !_stripA.canShow() || !_stripB.canShow())
+    {
+    }
+}
+
+void WS2812Output::_sendA()
+{
+    if (_usart)
+    {
+        _showUsart();
+    }
+    else
+    {
+        _stripA.show();
+        _blackout(_stripA.numPixels() * 3);
+    }
+}
+
+void WS2812Output::_sendB()
+{
+#ifdef WS2812_USART_CAPABLE
+    // Chain B output turns interrupts off : chain A frame must be done first
+    while (ws2812Busy)
+    {
+    }
+#endif
+    _stripB.show();
+    _blackout(_stripB.numPixels() * 3);
+}
+
+// Start gamma, brightness and white balance for one chain. Balance is the max level of each color.
+void WS2812Output::beginColorStage(uint8_t chain, uint8_t brightness, uint8_t red, uint8_t green, uint8_t blue)
+{
+    if (chain > WS2812_CHAIN_B)
+    {
+        return;
+    }
+    if (!_lut[chain])
+    {
+        _lut[chain] = new uint8_t[3 * 256];
+    }
+    _brightness[chain] = brightness;
+    _balance[chain][0] = red;
+    _balance[chain][1] = green;
+    _balance[chain][2] = blue;
+    _buildColorStage(chain);
+}
+
+// Runtime dimming : only the tables are rebuilt
+void WS2812Output::setBrightness(uint8_t chain, uint8_t brightness)
+{
+    if (chain > WS2812_CHAIN_B || brightness == _brightness[chain])
+    {
+        return;
+    }
+    _brightness[chain] = brightness;
+    _buildColorStage(chain);
+}
+
+void WS2812Output::setWhiteBalance(uint8_t chain, uint8_t red, uint8_t green, uint8_t blue)
+{
+    if (chain > WS2812_CHAIN_B)
+    {
+        return;
+    }
+    _balance[chain][0] = red;
+    _balance[chain][1] = green;
+    _balance[chain][2] = blue;
+    _buildColorStage(chain);
+}
+
+// Start dithering the lowest levels of one chain, false if the color stage is off or a refresh is over budget
+bool WS2812Output::beginDither(uint8_t chain)
+{
+    if (chain > WS2812_CHAIN_B || !_lut[chain])
+    {
+        return false;
+    }
+    uint16_t bytes = _strip(chain).numPixels() * 3;
+    if ((uint32_t)bytes * WS2812_DITHER_US_PER_BYTE > WS2812_DITHER_BUDGET)
+    {
+        return false;
+    }
+    if (!_dither[chain])
+    {
+        _frac[chain] = new uint8_t[3 * WS2812_DITHER_LEVELS];
+        _dither[chain] = new uint8_t[bytes];
+        // Errors spread between pixels, so they do not all step up on the same refresh
+        for (uint16_t i = 0; i < bytes; i++)
+        {
+            _dither[chain][i] = (i * 7) & 0x0F;
+        }
+    }
+    _buildColorStage(chain);
+    return true;
+}
+
+bool WS2812Output::isDithering(uint8_t chain)
+{
+    return chain <= WS2812_CHAIN_B && _lowLevels[chain];
+}
+
+// Dither and send the chain again between its engines updates, when it has dithered content
+void WS2812Output::refresh(uint8_t chain)
+{
+    if (!isDithering(chain) || _parallel)
+    {
+        return;
+    }
+    _redither(chain);
+    if (chain == WS2812_CHAIN_A)
+    {
+        _sendA();
+    }
+    else
+    {
+        _sendB();
+    }
+}
+
+Adafruit_NeoPixel &WS2812Output::_strip(uint8_t chain)
+{
+    return (chain == WS2812_CHAIN_A) ? _stripA : _stripB;
+}
+
+void WS2812Output::_buildColorStage(uint8_t chain)
+{
+    uint8_t *lut = _lut[chain];
+    if (!lut || _strip(chain).numPixels() == 0)
+    {
+        return;
+    }
+    uint8_t order[3];
+    _byteOrder(chain, order);
+
+    for (uint8_t k = 0; k < 3; k++)
+    {
+        // Color scale for this byte position, 0-255
+        uint16_t scale = ((uint16_t)_brightness[chain] * _balance[chain][order[k] % 3] + 127) / 255;
+        for (uint16_t level = 0; level < 256; level++)
+        {
+            uint8_t out = ((uint16_t)Adafruit_NeoPixel::gamma8(level) * scale + 127) / 255;
+            uint8_t toe = ((uint32_t)level * scale + 255 * WS2812_TOE / 2) / (255 * WS2812_TOE);
+            out = max(out, toe);
+            // Keep the lowest level visible
+            if (out == 0 && level > 0 && scale > 0)
+            {
+                out = 1;
+            }
+            *lut++ = out;
+        }
+        if (!_frac[chain])
+        {
+            continue;
+        }
+        // Dithered levels : integer part in the table, fraction aside
+        uint8_t *intPart = lut - 256;
+        uint8_t *frac = &_frac[chain][k * WS2812_DITHER_LEVELS];
+        for (uint8_t level = 0; level < WS2812_DITHER_LEVELS; level++)
+        {
+            uint16_t out = ((uint32_t)pgm_read_word(&WS2812_GAMMA16[level]) * scale + 127) / 255;
+            uint16_t toe = ((uint32_t)level * scale << 8) / (255 * WS2812_TOE);
+            out = max(out, toe);
+            if (level > 0 && scale > 0 && out < (WS2812_DITHER_MIN << 4))
+            {
+                out = WS2812_DITHER_MIN << 4;
+            }
+            intPart[level] = out >> 8;
+            frac[level] = (out >> 4) & 0x0F;
+        }
+    }
+}
+
+void WS2812Output::_applyColorStage(uint8_t chain)
+{
+    const uint8_t *lut = _lut[chain];
+    if (!lut)
+    {
+        return;
+    }
+    uint8_t *p = _strip(chain).getPixels();
+    if (!_dither[chain])
+    {
+        for (uint16_t i = _strip(chain).numPixels(); i > 0; i--)
+        {
+            p[0] = lut[p[0]];
+            p[1] = lut[256 + p[1]];
+            p[2] = lut[512 + p[2]];
+            p += 3;
+        }
+        return;
+    }
+    uint8_t *d = _dither[chain];
+    uint8_t lowLevels = 0;
+    for (uint16_t i = _strip(chain).numPixels(); i > 0; i--)
+    {
+        for (uint8_t k = 0; k < 3; k++)
+        {
+            uint8_t level = *p;
+            uint8_t out = lut[(k << 8) + level];
+            uint8_t frac = (level < WS2812_DITHER_LEVELS) ? _frac[chain][k * WS2812_DITHER_LEVELS + level] : 0;
+            uint8_t error = (*d & 0x0F) + frac;
+            if (error > 0x0F)
+            {
+                error -= 0x10;
+                out++;
+            }
+            *d++ = (frac << 4) | error;
+            *p++ = out;
+            lowLevels |= frac;
+        }
+    }
+    _lowLevels[chain] = lowLevels;
+}
+
+// Next dithering step on the last output : remove the last step carry, add the fraction again
+void WS2812Output::_redither(uint8_t chain)
+{
+    uint8_t *p = _strip(chain).getPixels();
+    uint8_t *d = _dither[chain];
+    for (uint16_t i = _strip(chain).numPixels() * 3; i > 0; i--, p++, d++)
+    {
+        uint8_t frac = *d >> 4;
+        if (!frac)
+        {
+            continue;
+        }
+        uint8_t error = *d & 0x0F;
+        // The error wrapped under the fraction if the last step carried
+        if (error < frac)
+        {
+            (*p)--;
+        }
+        error += frac;
+        if (error > 0x0F)
+        {
+            error -= 0x10;
+            (*p)++;
+        }
+        *d = (frac << 4) | error;
+    }
+}
+
+// Color of each chain byte position (0 red, 1 green, 2 blue)
+void WS2812Output::_byteOrder(uint8_t chain, uint8_t order[3])
+{
+    // Find the chain bytes order (GRB, RGB...) : write 1, 2, 3 in red, green, blue of the first pixel
+    uint8_t *pixel = _strip(chain).getPixels();
+    uint8_t saved[3] = {pixel[0], pixel[1], pixel[2]};
+    _strip(chain).setPixelColor(0, 1, 2, 3);
+    order[0] = pixel[0] - 1, order[1] = pixel[1] - 1, order[2] = pixel[2] - 1;
+    pixel[0] = saved[0], pixel[1] = saved[1], pixel[2] = saved[2];
+}
+
+void WS2812Output::beginCompositor(uint8_t chain)
+{
+    if (chain > WS2812_CHAIN_B || _from[chain])
+    {
+        return;
+    }
+    uint16_t bytes = _strip(chain).numPixels() * 3;
+    _from[chain] = new uint8_t[bytes];
+    _last[chain] = new uint8_t[bytes];
+    memset(_from[chain], 0, bytes);
+    memset(_last[chain], 0, bytes);
+}
+
+// Fade from the last composed frame to the engines animations in time ms
+void WS2812Output::crossfade(uint8_t chain, uint16_t time, unsigned long now)
+{
+    if (chain > WS2812_CHAIN_B || !_from[chain])
+    {
+        return;
+    }
+    // Frozen copy of the last composed frame : a fade restarted while fading goes on from the blended frame
+    memcpy(_from[chain], _last[chain], _strip(chain).numPixels() * 3);
+    _fadeStart[chain] = now;
+    _fadeTime[chain] = time;
+}
+
+void WS2812Output::setOverlay(uint8_t chain, uint8_t layer, uint16_t first, uint16_t last, uint8_t red, uint8_t green, uint8_t blue, uint8_t mode, uint8_t alpha)
+{
+    if (chain > WS2812_CHAIN_B || layer >= WS2812_OVERLAYS || _strip(chain).numPixels() == 0)
+    {
+        return;
+    }
+    WS2812Overlay &overlay = _overlay[chain][layer];
+    uint8_t rgb[3] = {red, green, blue};
+    uint8_t order[3];
+    _byteOrder(chain, order);
+    for (uint8_t k = 0; k < 3; k++)
+    {
+        overlay.color[k] = rgb[order[k] % 3];
+    }
+    overlay.first = first;
+    overlay.last = min(last, (uint16_t)(_strip(chain).numPixels() - 1));
+    overlay.mode = mode;
+    overlay.alpha = alpha;
+}
+
+void WS2812Output::clearOverlays(uint8_t chain)
+{
+    if (chain > WS2812_CHAIN_B)
+    {
+        return;
+    }
+    for (uint8_t layer = 0; layer < WS2812_OVERLAYS; layer++)
+    {
+        _overlay[chain][layer].first = 1;
+        _overlay[chain][layer].last = 0;
+    }
+}
+
+// Alpha 0-255 to a 0-256 weight, so 255 is the full color and 0 is nothing
+uint16_t WS2812Output::_weight(uint8_t alpha)
+{
+    return alpha + (alpha >> 7);
+}
+
+// Crossfade and overlays in one pass on the chain buffer, before its output
+void WS2812Output::compose(uint8_t chain, unsigned long now)
+{
+    if (chain > WS2812_CHAIN_B || !_from[chain])
+    {
+        return;
+    }
+    // New frame weight, 0-256
+    uint16_t mix = 256;
+    if (_fadeTime[chain] > 0)
+    {
+        unsigned long elapsed = now - _fadeStart[chain];
+        if (elapsed >= _fadeTime[chain])
+        {
+            _fadeTime[chain] = 0;
+        }
+        else
+        {
+            mix = (elapsed << 8) / _fadeTime[chain];
+        }
+    }
+    // Overlays colors scaled once for add and max blending
+    uint8_t scaled[WS2812_OVERLAYS][3];
+    for (uint8_t layer = 0; layer < WS2812_OVERLAYS; layer++)
+    {
+        const WS2812Overlay &overlay = _overlay[chain][layer];
+        for (uint8_t k = 0; k < 3; k++)
+        {
+            scaled[layer][k] = ((uint16_t)overlay.color[k] * _weight(overlay.alpha)) >> 8;
+        }
+    }
+
+    uint8_t *p = _strip(chain).getPixels();
+    uint8_t *from = _from[chain];
+    uint8_t *last = _last[chain];
+    uint16_t pixels = _strip(chain).numPixels();
+    for (uint16_t i = 0; i < pixels; i++)
+    {
+        for (uint8_t k = 0; k < 3; k++)
+        {
+            uint8_t level = *p;
+            // Weights sum is 256 : no overflow of 16 bits
+            if (mix < 256)
+            {
+                level = ((uint16_t)*from * (256 - mix) + (uint16_t)level * mix) >> 8;
+            }
+            for (uint8_t layer = 0; layer < WS2812_OVERLAYS; layer++)
+            {
+                const WS2812Overlay &overlay = _overlay[chain][layer];
+                if (i < overlay.first || i > overlay.last)
+                {
+                    continue;
+                }
+                uint8_t color = scaled[layer][k];
+                if (overlay.mode == WS2812_BLEND_ADD)
+                {
+                    level = (level > 255 - color) ? 255 : level + color;
+                }
+                else if (overlay.mode == WS2812_BLEND_MAX)
+                {
+                    level = (level > color) ? level : color;
+                }
+                else
+                {
+                    uint16_t alpha = _weight(overlay.alpha);
+                    level = ((uint16_t)level * (256 - alpha) + (uint16_t)overlay.color[k] * alpha) >> 8;
+                }
+            }
+            // Outgoing frame of the next crossfade, kept before the color stage changes the chain
+            *last++ = level;
+            *p++ = level;
+            from++;
+        }
+    }
+}
+
+// Start counting the interrupts off windows of the outputs, and the audio player UART bytes they could make lost
+void WS2812Output::watchUart(uint32_t baud, bool softwareSerial)
+{
+    _uartByteUs = 10000000UL / baud; // 10 bits per byte
+    _uartSoft = softwareSerial;
+}
+
+// Interrupts were off for this number of chain bytes : worst case with player bytes arriving back to back.
+//  SoftwareSerial : a byte starting while interrupts are off is read late, so it is lost.
+//  Hardware UART : 2 bytes in the receive buffer and 1 in the shift register, next ones overrun.
+void WS2812Output::_blackout(uint16_t bytes)
+{
+    if (_uartByteUs == 0)
+    {
+        return;
+    }
+    uint32_t us = (uint32_t)bytes * WS2812_US_PER_BYTE;
+    uint16_t lost;
+    if (_uartSoft)
+    {
+        lost = (us + _uartByteUs - 1) / _uartByteUs;
+    }
+    else
+    {
+        uint16_t arrived = us / _uartByteUs + 1;
+        lost = (arrived > 3) ? arrived - 3 : 0;
+    }
+    _blackouts++;
+    if (lost > 0)
+    {
+        _lossBlackouts++;
+        _bytesLost += lost;
+    }
+    if (us > _blackoutMax)
+    {
+        _blackoutMax = us;
+    }
+}
+
+void WS2812Output::printStats(Print &out)
+{
+    out.print(F("LEDs outputs with interrupts off : ")), out.println(_blackouts);
+    out.print(F("Longest interrupts off (us) : ")), out.println(_blackoutMax);
+    out.print(F("Player byte time (us) : ")), out.print(_uartByteUs);
+    out.println(_uartSoft ? F(" SoftwareSerial") : F(" hardware UART"));
+    out.print(F("Outputs that can lose player bytes : ")), out.println(_lossBlackouts);
+    out.print(F("Player bytes lost, worst case : ")), out.println(_bytesLost);
+}
+
+// 1 pixel byte -> 3 symbol bytes, MSB first
+void WS2812Output::encodeUsart(const uint8_t *pixels, uint16_t bytes, uint8_t *symbols)
+{
+    for (uint16_t i = 0; i < bytes; i++)
+    {
+        uint16_t high = pgm_read_word(&WS2812_SYMBOLS[pixels[i] >> 4]);
+        uint16_t low = pgm_read_word(&WS2812_SYMBOLS[pixels[i] & 0x0F]);
+        *symbols++ = high >> 4;
+        *symbols++ = (high << 4) | (low >> 8);
+        *symbols++ = low;
+    }
+}
+
+void WS2812Output::_showParallel()
+{
+#ifdef WS2812_PARALLEL_CAPABLE
+    const uint8_t *pixelsA = _stripA.getPixels();
+    const uint8_t *pixelsB = _stripB.getPixels();
+    uint16_t bytesA = _stripA.numPixels() * 3;
+    uint16_t bytesB = _stripB.numPixels() * 3;
+    uint16_t bytes = max(bytesA, bytesB);
+    volatile uint8_t *port = _port;
+    uint8_t maskA = _maskA;
+    uint8_t maskB = _maskB;
+    uint8_t bit, next;
+
+    while (micros() - _endTime < WS2812_LATCH)
+    {
+    }
+
+    noInterrupts();
+    uint8_t lo = *port & ~(maskA | maskB);
+    uint8_t hi = lo | maskA | maskB;
+    for (uint16_t i = 0; i < bytes; i++)
+    {
+        // Shorter chain is padded with zeros, extra bits go out of its last LED
+        uint8_t a = (i < bytesA) ? pixelsA[i] : 0;
+        uint8_t b = (i < bytesB) ? pixelsB[i] : 0;
+        // 8 bits, MSB first. The low time between bytes is stretched by the loop above, WS2812 tolerates it.
+        asm volatile(
+            "ldi %[bit], 8\n\t"
+            "1:\n\t"
+            "st %a[port], %[hi]\n\t"
+            "mov %[next], %[lo]\n\t"
+            "sbrc %[a], 7\n\t"
+            "or %[next], %[maskA]\n\t"
+            "sbrc %[b], 7\n\t"
+            "or %[next], %[maskB]\n\t"
+            "st %a[port], %[next]\n\t"
+            "lsl %[a]\n\t"
+            "lsl %[b]\n\t"
+            "dec %[bit]\n\t" WS2812_NOPS(WS2812_NOPS_1H)
+            "st %a[port], %[lo]\n\t" WS2812_NOPS(WS2812_NOPS_L)
+            "brne 1b\n\t"
+            : [a] "+r"(a), [b] "+r"(b), [bit] "=&d"(bit), [next] "=&r"(next)
+            : [port] "e"(port), [hi] "r"(hi), [lo] "r"(lo), [maskA] "r"(maskA), [maskB] "r"(maskB));
+    }
+    interrupts();
+    _endTime = micros();
+    _blackout(bytes);
+#endif
+}
+
+bool WS2812Output::_beginUsart()
+{
+#ifdef WS2812_USART_CAPABLE
+    int16_t pin = _stripA.getPin();
+    if (pin < 0)
+    {
+        return false;
+    }
+    uint8_t port = digitalPinToPort(pin);
+    uint8_t bit = digitalPinToBitPosition(pin);
+    if (port == PA && bit == 0) // D2 on Nano Every
+    {
+        ws2812Usart = &USART0;
+        PORTMUX.USARTROUTEA = (PORTMUX.USARTROUTEA & ~PORTMUX_USART0_gm) | PORTMUX_USART0_DEFAULT_gc;
+    }
+    else if (port == PA && bit == 4)
+    {
+        ws2812Usart = &USART0;
+        PORTMUX.USARTROUTEA = (PORTMUX.USARTROUTEA & ~PORTMUX_USART0_gm) | PORTMUX_USART0_ALT1_gc;
+    }
+    else if (port == PF && bit == 0)
+    {
+        ws2812Usart = &USART2;
+        PORTMUX.USARTROUTEA = (PORTMUX.USARTROUTEA & ~PORTMUX_USART2_gm) | PORTMUX_USART2_DEFAULT_gc;
+    }
+    else if (port == PF && bit == 4) // D6 on Nano Every
+    {
+        ws2812Usart = &USART2;
+        PORTMUX.USARTROUTEA = (PORTMUX.USARTROUTEA & ~PORTMUX_USART2_gm) | PORTMUX_USART2_ALT1_gc;
+    }
+    else
+    {
+        return false;
+    }
+    // Level 1 priority : other interrupt handlers can't delay the next symbol byte
+    CPUINT.LVL1VEC = (ws2812Usart == &USART0) ? USART0_DRE_vect_num : USART2_DRE_vect_num;
+    _symbols = new uint8_t[_stripA.numPixels() * 9];
+    digitalWrite(pin, LOW);
+    pinMode(pin, OUTPUT);
+    ws2812Usart->BAUD = WS2812_USART_BAUD;
+    ws2812Usart->CTRLC = USART_CMODE_MSPI_gc; // SPI master, MSB first, TxD idles low after the last 0 bit
+    ws2812Usart->CTRLB = USART_TXEN_bm;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void WS2812Output::_showUsart()
+{
+#ifdef WS2812_USART_CAPABLE
+    uint16_t bytes = _stripA.numPixels() * 3;
+    // Previous frame sent and latched
+    while (ws2812Busy || (long)(micros() - _endTime) < WS2812_LATCH)
+    {
+    }
+    encodeUsart(_stripA.getPixels(), bytes, _symbols);
+    noInterrupts();
+    ws2812Next = _symbols;
+    ws2812Left = bytes * 3;
+    ws2812Busy = true;
+    ws2812Usart->CTRLA |= USART_DREIE_bm;
+    interrupts();
+    _endTime = micros() + (unsigned long)bytes * WS2812_USART_US_PER_BYTE; // frame end, for the latch time
+#endif
+}
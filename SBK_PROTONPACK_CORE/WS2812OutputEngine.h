@@ -0,0 +1,121 @@
+/*
+ *  WS2812OutputEngine.h is a part of SBK_PROTONPACK_CORE (VERSION 2.4) code for sound effects and animations of a Proton Pack replica
+ *  Copyright (c) 2023-2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE>.
+ *
+ *  SBK_PROTONPACK_CORE is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_PROTONPACK_CORE is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+#ifndef WS2812OUTPUTENGINE_H
+#define WS2812OUTPUTENGINE_H
+
+#include <Arduino.h>
+#include <Adafruit_NeoPixel.h>
+
+/*  Chains are shown one after the other with Adafruit_NeoPixel::show(), or in one pass when both data */
+/*  pins are on the same port of a 16 MHz AVR (beginParallel()), the shorter chain padded with zeros. */
+/*  On ATmega4809, chain A can be streamed by an USART in SPI mode (begin(true), D2 or D6), 3 SPI bits */
+/*  for each WS2812 bit, from a level 1 priority interrupt : interrupts stay enabled. */
+/*  Color stage (beginColorStage()) : gamma, brightness and white balance applied in place by tables just */
+/*  before each output, so engines must write every pixel again before it. */
+/*  Compositor (beginCompositor()) : crossfade from the last composed frame, then overlays over pixels ranges. */
+/*  Dithering (beginDither()) : the lowest levels keep 1/16 steps, sent again by refresh() between updates. */
+/*  watchUart() counts the outputs sent with interrupts off and the player bytes they could make lost. */
+#define WS2812_CHAIN_A 0
+#define WS2812_CHAIN_B 1
+#define WS2812_OVERLAYS 2    // overlay layers for each chain
+#define WS2812_BLEND_ADD 0   // overlay color scaled by alpha is added, saturated to 255
+#define WS2812_BLEND_MAX 1   // brightest of pixel and overlay color scaled by alpha
+#define WS2812_BLEND_ALPHA 2 // pixel mixed with overlay color, alpha 255 = overlay color
+#define WS2812_DITHER_LEVELS 64    // lowest engines levels dithered, output under 16
+#define WS2812_DITHER_MIN 4        // 1/16 steps, lowest output of a level over 0 : 4 refreshes dither period at most
+#define WS2812_DITHER_BUDGET 2000  // us, longest refresh of a dithered chain
+
+struct WS2812Overlay
+{
+    uint16_t first; // first and last pixels, first > last when the layer is off
+    uint16_t last;
+    uint8_t color[3]; // in the chain bytes order
+    uint8_t mode;
+    uint8_t alpha;
+};
+
+class WS2812Output
+{
+public:
+    WS2812Output(Adafruit_NeoPixel &stripA, Adafruit_NeoPixel &stripB);
+    void begin(bool usart = false);
+    bool beginParallel();
+    bool isParallel();
+    bool isUsart();
+    void show();
+    void showA();
+    void showB();
+    void waitReady();
+    void beginColorStage(uint8_t chain, uint8_t brightness, uint8_t red, uint8_t green, uint8_t blue);
+    void setBrightness(uint8_t chain, uint8_t brightness);
+    void setWhiteBalance(uint8_t chain, uint8_t red, uint8_t green, uint8_t blue);
+    bool beginDither(uint8_t chain);
+    bool isDithering(uint8_t chain);
+    void refresh(uint8_t chain);
+    void beginCompositor(uint8_t chain);
+    void crossfade(uint8_t chain, uint16_t time, unsigned long now);
+    void setOverlay(uint8_t chain, uint8_t layer, uint16_t first, uint16_t last, uint8_t red, uint8_t green, uint8_t blue, uint8_t mode, uint8_t alpha);
+    void clearOverlays(uint8_t chain);
+    void compose(uint8_t chain, unsigned long now);
+    void watchUart(uint32_t baud, bool softwareSerial);
+    void printStats(Print &out);
+    static void encodeUsart(const uint8_t *pixels, uint16_t bytes, uint8_t *symbols);
+
+private:
+    void _showParallel();
+    void _showUsart();
+    bool _beginUsart();
+    void _buildColorStage(uint8_t chain);
+    void _applyColorStage(uint8_t chain);
+    void _redither(uint8_t chain);
+    void _sendA();
+    void _sendB();
+    void _byteOrder(uint8_t chain, uint8_t order[3]);
+    static uint16_t _weight(uint8_t alpha);
+    void _blackout(uint16_t bytes);
+    Adafruit_NeoPixel &_strip(uint8_t chain);
+    Adafruit_NeoPixel &_stripA;
+    Adafruit_NeoPixel &_stripB;
+    bool _parallel;
+    bool _usart;
+    uint8_t *_symbols;
+    volatile uint8_t *_port;
+    uint8_t _maskA;
+    uint8_t _maskB;
+    unsigned long _endTime;
+    uint8_t *_lut[2];        // 3 x 256 bytes tables for each chain, in the chain bytes order
+    uint8_t _brightness[2];
+    uint8_t _balance[2][3];  // red, green, blue
+    uint8_t *_frac[2];       // 3 x WS2812_DITHER_LEVELS gamma output fractions (1/16) for each chain
+    uint8_t *_dither[2];     // fraction (high nibble) and error (low nibble) of each chain byte
+    bool _lowLevels[2];      // last output had dithered bytes
+    uint8_t *_from[2];       // crossfade start frame, frozen by crossfade()
+    uint8_t *_last[2];       // last composed frame
+    unsigned long _fadeStart[2];
+    uint16_t _fadeTime[2];   // 0 = not fading
+    WS2812Overlay _overlay[2][WS2812_OVERLAYS];
+    uint16_t _uartByteUs;    // 0 = stats off
+    bool _uartSoft;
+    uint32_t _blackouts;
+    uint32_t _lossBlackouts;
+    uint32_t _bytesLost;
+    uint16_t _blackoutMax;   // us
+};
+
+#endif
@@ -0,0 +1,534 @@
+/*
+ *  DFPlayerEmulatorEngine.cpp is a part of SBK_DFPLAYER_EMULATOR (Version 0) code for emulating a DFPlayer Mini
+ *  audio player used in many Ghostbusters props replica.
+ *  Copyright (c) 2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE/tree/main/Tools/SBK_DFPLAYER_EMULATOR>.
+ *
+ *  SBK_DFPLAYER_EMULATOR is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_DFPLAYER_EMULATOR is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+#include "DFPlayerEmulatorEngine.h"
+
+#define DFP_RESET_TIME 1000  // time the real player takes to come back online after a reset command
+#define DFP_ADVERT_FOLDER 0xFF // internal folder number for tracks played from the /ADVERT folder
+
+DFPlayerEmulator::DFPlayerEmulator(Stream &serial, const uint16_t *trackLengths, uint16_t tracksNumber)
+    : _serial(serial), _trackLengths(trackLengths), _tracksNumber(tracksNumber)
+{
+    _folderTracks = 0;
+    _folderTrackLength = 0;
+    _latency = 0;
+    _rxLoss = 0;
+    _txLoss = 0;
+    _busyWindow = 0;
+    _seed = 0xACE1;
+    resetStats();
+}
+
+void DFPlayerEmulator::begin()
+{
+    _rxIndex = 0;
+    _lastCommandTime = 0;
+    _commandsHead = 0;
+    _commandsCount = 0;
+    _repliesHead = 0;
+    _repliesCount = 0;
+    _state = DFP_STOPPED;
+    _folder = 0;
+    _track = 0;
+    _startTime = 0;
+    _position = 0;
+    _length = 0;
+    _repeatTrack = false;
+    _repeatFolder = false;
+    _advert = false;
+    _silenceStart = millis();
+    _volume = 20;
+    _eq = 0;
+    // A real player announces itself when it comes online
+    _queueReply(DFP_REPLY_ONLINE, 0x02, millis() + DFP_RESET_TIME);
+}
+
+void DFPlayerEmulator::update()
+{
+    // Incoming command bytes
+    while (_serial.available() > 0)
+    {
+        uint8_t b = _serial.read();
+        stats.bytesReceived++;
+        if (_lose(_rxLoss))
+        {
+            stats.bytesLostRx++;
+        }
+        else
+        {
+            _readByte(b);
+        }
+    }
+
+    // Commands are executed once the response latency is over
+    while (_commandsCount > 0 && (long)(millis() - _commands[_commandsHead].due) >= 0)
+    {
+        _Frame frame = _commands[_commandsHead];
+        _commandsHead = (_commandsHead + 1) % DFP_QUEUE_SIZE;
+        _commandsCount--;
+        _execute(frame);
+    }
+
+    // Virtual playback
+    if (_state == DFP_PLAYING)
+    {
+        _position = millis() - _startTime;
+        if (_position >= _length)
+        {
+            _trackDone();
+        }
+    }
+
+    // Replies
+    while (_repliesCount > 0 && (long)(millis() - _replies[_repliesHead].due) >= 0)
+    {
+        _sendFrame(_replies[_repliesHead].cmd, _replies[_repliesHead].param);
+        _repliesHead = (_repliesHead + 1) % DFP_QUEUE_SIZE;
+        _repliesCount--;
+    }
+}
+
+void DFPlayerEmulator::setLatency(uint16_t latency)
+{
+    _latency = latency;
+}
+
+void DFPlayerEmulator::setByteLoss(uint16_t rxLoss, uint16_t txLoss)
+{
+    // Loss rates are in bytes per thousand
+    _rxLoss = min(1000, rxLoss);
+    _txLoss = min(1000, txLoss);
+}
+
+void DFPlayerEmulator::setBusyWindow(uint16_t busyWindow)
+{
+    _busyWindow = busyWindow;
+}
+
+void DFPlayerEmulator::setFolderTracks(uint8_t folderTracks, uint16_t folderTrackLength)
+{
+    _folderTracks = folderTracks;
+    _folderTrackLength = folderTrackLength;
+}
+
+void DFPlayerEmulator::resetStats()
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+void DFPlayerEmulator::printStats(Print &out)
+{
+    out.print("Bytes received      : "), out.println(stats.bytesReceived);
+    out.print("Bytes lost RX / TX  : "), out.print(stats.bytesLostRx), out.print(" / "), out.println(stats.bytesLostTx);
+    out.print("Frames OK / corrupt : "), out.print(stats.framesReceived), out.print(" / "), out.println(stats.framesCorrupted);
+    out.print("Commands executed   : "), out.println(stats.commandsExecuted);
+    out.print("Commands busy/overf.: "), out.print(stats.commandsIgnoredBusy), out.print(" / "), out.println(stats.commandsOverflow);
+    out.print("Replies sent        : "), out.println(stats.repliesSent);
+    out.print("Tracks completed    : "), out.println(stats.tracksCompleted);
+    out.print("Track transitions   : "), out.println(stats.transitions);
+    out.print("Gap avg / max (ms)  : ");
+    out.print(stats.transitions > 0 ? stats.gapTotal / stats.transitions : 0);
+    out.print(" / "), out.println(stats.gapMax);
+    uint32_t commands = stats.framesReceived + stats.framesCorrupted;
+    out.print("Dropped commands    : ");
+    out.print(stats.framesCorrupted + stats.commandsIgnoredBusy + stats.commandsOverflow);
+    out.print(" of "), out.println(commands);
+}
+
+uint8_t DFPlayerEmulator::getState()
+{
+    return _state;
+}
+
+uint16_t DFPlayerEmulator::getTrack()
+{
+    return _track;
+}
+
+uint32_t DFPlayerEmulator::getPosition()
+{
+    return _position;
+}
+
+void DFPlayerEmulator::_readByte(uint8_t b)
+{
+    // Wait for a start byte before filling a new frame
+    if (_rxIndex == 0 && b != DFP_START_BYTE)
+    {
+        return;
+    }
+    _rxFrame[_rxIndex++] = b;
+    if (_rxIndex >= DFP_FRAME_LENGTH)
+    {
+        _parseFrame();
+    }
+}
+
+void DFPlayerEmulator::_parseFrame()
+{
+    _rxIndex = 0;
+    if (_rxFrame[1] != DFP_VERSION || _rxFrame[2] != DFP_LENGTH || _rxFrame[9] != DFP_END_BYTE)
+    {
+        // A lost byte shifts the frame : resync on the next start byte already received
+        stats.framesCorrupted++;
+        for (uint8_t i = 1; i < DFP_FRAME_LENGTH; i++)
+        {
+            if (_rxFrame[i] == DFP_START_BYTE)
+            {
+                for (uint8_t j = i; j < DFP_FRAME_LENGTH; j++)
+                {
+                    _rxFrame[_rxIndex++] = _rxFrame[j];
+                }
+                break;
+            }
+        }
+        return;
+    }
+    if (_checksum(_rxFrame) != (((uint16_t)_rxFrame[7] << 8) | _rxFrame[8]))
+    {
+        stats.framesCorrupted++;
+        _queueReply(DFP_REPLY_ERROR, DFP_ERROR_CHECKSUM, millis() + _latency);
+        return;
+    }
+    stats.framesReceived++;
+
+    // Busy player ignores commands sent too quickly
+    if (_busyWindow > 0 && (millis() - _lastCommandTime) < _busyWindow)
+    {
+        stats.commandsIgnoredBusy++;
+        return;
+    }
+    _lastCommandTime = millis();
+
+    _Frame frame;
+    frame.cmd = _rxFrame[3];
+    frame.feedback = _rxFrame[4];
+    frame.param = ((uint16_t)_rxFrame[5] << 8) | _rxFrame[6];
+    frame.due = millis() + _latency;
+    if (!_push(_commands, _commandsHead, _commandsCount, frame))
+    {
+        stats.commandsOverflow++;
+    }
+}
+
+void DFPlayerEmulator::_execute(const _Frame &frame)
+{
+    stats.commandsExecuted++;
+    if (frame.feedback)
+    {
+        _queueReply(DFP_REPLY_ACK, 0, millis());
+    }
+
+    switch (frame.cmd)
+    {
+    case 0x01: // next
+        _play(_folder, (_track + 1 > (_folder == 0 ? _tracksNumber - 1 : _folderTracks)) ? 1 : _track + 1);
+        break;
+    case 0x02: // previous
+        _play(_folder, (_track <= 1) ? (_folder == 0 ? _tracksNumber - 1 : _folderTracks) : _track - 1);
+        break;
+    case 0x03: // play track from root
+    case 0x12: // play track from /MP3 folder
+        _repeatTrack = false;
+        _repeatFolder = false;
+        _play(0, frame.param);
+        break;
+    case 0x04: // volume up
+        _volume = min(30, _volume + 1);
+        break;
+    case 0x05: // volume down
+        _volume = _volume > 0 ? _volume - 1 : 0;
+        break;
+    case 0x06: // volume
+        _volume = min(30, frame.param & 0xFF);
+        break;
+    case 0x07: // EQ
+        _eq = frame.param & 0xFF;
+        break;
+    case 0x08: // single track repeat
+        _repeatTrack = true;
+        _repeatFolder = false;
+        _play(0, frame.param);
+        break;
+    case 0x0A: // standby
+        _stop();
+        break;
+    case 0x0C: // reset
+        _stop();
+        _repeatTrack = false;
+        _repeatFolder = false;
+        _queueReply(DFP_REPLY_ONLINE, 0x02, millis() + DFP_RESET_TIME);
+        break;
+    case 0x0D: // resume
+        if (_state == DFP_PAUSED)
+        {
+            _state = DFP_PLAYING;
+            _startTime = millis() - _position;
+        }
+        break;
+    case 0x0E: // pause
+        if (_state == DFP_PLAYING)
+        {
+            _state = DFP_PAUSED;
+        }
+        break;
+    case 0x0F: // play track from folder
+        _play(frame.param >> 8, frame.param & 0xFF);
+        break;
+    case 0x13: // insert advertisement, main track resumes when it is done
+        if (_state != DFP_PLAYING || _advert)
+        {
+            _queueReply(DFP_REPLY_ERROR, DFP_ERROR_ADVERT, millis());
+        }
+        else if (_trackLength(DFP_ADVERT_FOLDER, frame.param) == 0)
+        {
+            _queueReply(DFP_REPLY_ERROR, DFP_ERROR_FILE_INDEX, millis());
+        }
+        else
+        {
+            _advertSavedState = _state;
+            _advertSavedFolder = _folder;
+            _advertSavedTrack = _track;
+            _advertSavedPosition = _position;
+            _advertSavedLength = _length;
+            _advert = true;
+            _folder = DFP_ADVERT_FOLDER;
+            _track = frame.param;
+            _length = _trackLength(DFP_ADVERT_FOLDER, frame.param);
+            _position = 0;
+            _startTime = millis();
+            stats.transitions++;
+        }
+        break;
+    case 0x14: // play track from large folder
+        _play(frame.param >> 12, frame.param & 0x0FFF);
+        break;
+    case 0x15: // stop advertisement
+        if (_advert)
+        {
+            _position = _length;
+            _trackDone();
+        }
+        break;
+    case 0x16: // stop
+        _repeatFolder = false;
+        _stop();
+        break;
+    case 0x17: // repeat folder
+        _repeatTrack = false;
+        _repeatFolder = true;
+        _play(frame.param, 1);
+        break;
+    case 0x18: // random all
+        if (_tracksNumber > 1)
+        {
+            _play(0, 1 + _random() % (_tracksNumber - 1));
+        }
+        break;
+    case 0x19: // repeat current track : 0 = start, 1 = stop
+        _repeatTrack = (frame.param == 0);
+        break;
+    case 0x09: // playback source
+    case 0x10: // volume adjust
+    case 0x11: // repeat all
+    case 0x1A: // DAC
+        break;
+    case 0x42: // status query
+        _queueReply(0x42, _state, millis());
+        break;
+    case 0x43: // volume query
+        _queueReply(0x43, _volume, millis());
+        break;
+    case 0x44: // EQ query
+        _queueReply(0x44, _eq, millis());
+        break;
+    case 0x45: // playback mode query
+        _queueReply(0x45, _repeatTrack ? 2 : (_repeatFolder ? 1 : 0), millis());
+        break;
+    case 0x46: // version query
+        _queueReply(0x46, 8, millis());
+        break;
+    case 0x47: // SD card files query
+        _queueReply(0x47, _tracksNumber - 1 + _folderTracks, millis());
+        break;
+    case 0x4B: // SD card current track query
+        _queueReply(0x4B, _track, millis());
+        break;
+    case 0x4E: // folder files query
+        _queueReply(0x4E, _folderTracks, millis());
+        break;
+    case 0x4F: // folders query
+        _queueReply(0x4F, _folderTracks > 0 ? 1 : 0, millis());
+        break;
+    default:
+        _queueReply(DFP_REPLY_ERROR, DFP_ERROR_WRONG_STACK, millis());
+        break;
+    }
+}
+
+void DFPlayerEmulator::_play(uint8_t folder, uint16_t track)
+{
+    uint32_t length = _trackLength(folder, track);
+    if (length == 0)
+    {
+        _queueReply(DFP_REPLY_ERROR, DFP_ERROR_FILE_INDEX, millis());
+        return;
+    }
+
+    // Silence between the last track end and this one
+    if (_state != DFP_PLAYING)
+    {
+        uint32_t gap = millis() - _silenceStart;
+        stats.gapTotal += gap;
+        stats.gapMax = max(stats.gapMax, (uint16_t)min(gap, 0xFFFF));
+    }
+    stats.transitions++;
+
+    _advert = false;
+    _state = DFP_PLAYING;
+    _folder = folder;
+    _track = track;
+    _length = length;
+    _position = 0;
+    _startTime = millis();
+}
+
+void DFPlayerEmulator::_stop()
+{
+    if (_state != DFP_STOPPED)
+    {
+        _silenceStart = millis();
+    }
+    _state = DFP_STOPPED;
+    _advert = false;
+    _position = 0;
+}
+
+void DFPlayerEmulator::_trackDone()
+{
+    stats.tracksCompleted++;
+
+    // Advertisement done, main track resumes where it was
+    if (_advert)
+    {
+        _advert = false;
+        _state = _advertSavedState;
+        _folder = _advertSavedFolder;
+        _track = _advertSavedTrack;
+        _position = _advertSavedPosition;
+        _length = _advertSavedLength;
+        _startTime = millis() - _position;
+        return;
+    }
+
+    _queueReply(DFP_REPLY_TRACK_DONE, _track, millis());
+    if (_repeatTrack)
+    {
+        _position = 0;
+        _startTime = millis();
+    }
+    else if (_repeatFolder)
+    {
+        _play(_folder, _track + 1 > _folderTracks ? 1 : _track + 1);
+    }
+    else
+    {
+        _stop();
+    }
+}
+
+uint32_t DFPlayerEmulator::_trackLength(uint8_t folder, uint16_t track)
+{
+    if (track == 0)
+    {
+        return 0;
+    }
+    // Root and advert tracks share the pack tracks lengths table, index 0 is the offset entry
+    if (folder == 0 || folder == DFP_ADVERT_FOLDER)
+    {
+        return track < _tracksNumber ? _trackLengths[track] : 0;
+    }
+    // Themes folder
+    return track <= _folderTracks ? _folderTrackLength : 0;
+}
+
+void DFPlayerEmulator::_queueReply(uint8_t cmd, uint16_t param, unsigned long due)
+{
+    _Frame frame;
+    frame.cmd = cmd;
+    frame.feedback = 0;
+    frame.param = param;
+    frame.due = due;
+    _push(_replies, _repliesHead, _repliesCount, frame);
+}
+
+void DFPlayerEmulator::_sendFrame(uint8_t cmd, uint16_t param)
+{
+    uint8_t frame[DFP_FRAME_LENGTH] = {DFP_START_BYTE, DFP_VERSION, DFP_LENGTH, cmd, 0, (uint8_t)(param >> 8), (uint8_t)(param & 0xFF), 0, 0, DFP_END_BYTE};
+    uint16_t checksum = _checksum(frame);
+    frame[7] = checksum >> 8;
+    frame[8] = checksum & 0xFF;
+    for (uint8_t i = 0; i < DFP_FRAME_LENGTH; i++)
+    {
+        if (_lose(_txLoss))
+        {
+            stats.bytesLostTx++;
+        }
+        else
+        {
+            _serial.write(frame[i]);
+        }
+    }
+    stats.repliesSent++;
+}
+
+bool DFPlayerEmulator::_push(_Frame *queue, uint8_t &head, uint8_t &count, const _Frame &frame)
+{
+    if (count >= DFP_QUEUE_SIZE)
+    {
+        return false;
+    }
+    queue[(head + count) % DFP_QUEUE_SIZE] = frame;
+    count++;
+    return true;
+}
+
+uint16_t DFPlayerEmulator::_checksum(const uint8_t *frame)
+{
+    uint16_t sum = 0;
+    for (uint8_t i = 1; i < 7; i++)
+    {
+        sum += frame[i];
+    }
+    return -sum;
+}
+
+bool DFPlayerEmulator::_lose(uint16_t perMille)
+{
+    return perMille > 0 && (_random() % 1000) < perMille;
+}
+
+uint16_t DFPlayerEmulator::_random()
+{
+    // xorshift16, repeatable from one run to the next
+    _seed ^= _seed << 7;
+    _seed ^= _seed >> 9;
+    _seed ^= _seed << 8;
+    return _seed;
+}
@@ -0,0 +1,146 @@
+/*
+ *  DFPlayerEmulatorEngine.h is a part of SBK_DFPLAYER_EMULATOR (Version 0) code for emulating a DFPlayer Mini
+ *  audio player used in many Ghostbusters props replica.
+ *  Copyright (c) 2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE/tree/main/Tools/SBK_DFPLAYER_EMULATOR>.
+ *
+ *  SBK_DFPLAYER_EMULATOR is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_DFPLAYER_EMULATOR is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+#ifndef DFPLAYEREMULATORENGINE_H
+#define DFPLAYEREMULATORENGINE_H
+
+#include <Arduino.h>
+
+// DFPlayer Mini serial frame : 7E FF 06 CMD FEEDBACK MSB LSB CHECKSUM_MSB CHECKSUM_LSB EF
+#define DFP_FRAME_LENGTH 10
+#define DFP_START_BYTE 0x7E
+#define DFP_VERSION 0xFF
+#define DFP_LENGTH 0x06
+#define DFP_END_BYTE 0xEF
+// Replies sent by the player
+#define DFP_REPLY_ONLINE 0x3F
+#define DFP_REPLY_TRACK_DONE 0x3D
+#define DFP_REPLY_ERROR 0x40
+#define DFP_REPLY_ACK 0x41
+// Error codes sent with DFP_REPLY_ERROR
+#define DFP_ERROR_BUSY 0x01
+#define DFP_ERROR_WRONG_STACK 0x03
+#define DFP_ERROR_CHECKSUM 0x04
+#define DFP_ERROR_FILE_INDEX 0x05
+#define DFP_ERROR_ADVERT 0x07
+// Virtual player states, same values as the status query reply
+#define DFP_STOPPED 0
+#define DFP_PLAYING 1
+#define DFP_PAUSED 2
+// Commands and replies waiting for the emulated response latency
+#define DFP_QUEUE_SIZE 8
+
+struct DFPlayerEmulatorStats
+{
+    uint32_t bytesReceived;
+    uint32_t bytesLostRx;       // command bytes dropped before parsing (byte loss emulation)
+    uint32_t bytesLostTx;       // reply bytes dropped before sending (byte loss emulation)
+    uint32_t framesReceived;    // valid frames
+    uint32_t framesCorrupted;   // bad length, end byte or checksum
+    uint32_t commandsExecuted;
+    uint32_t commandsIgnoredBusy;
+    uint32_t commandsOverflow;  // command queue full
+    uint32_t repliesSent;
+    uint32_t tracksCompleted;
+    uint32_t transitions;       // play commands that started a track
+    uint32_t gapTotal;          // silence between end of a track and start of the next one, in ms
+    uint16_t gapMax;
+};
+
+class DFPlayerEmulator
+{
+public:
+    DFPlayerEmulator(Stream &serial, const uint16_t *trackLengths, uint16_t tracksNumber);
+    void begin();
+    void update();
+    void setLatency(uint16_t latency);
+    void setByteLoss(uint16_t rxLoss, uint16_t txLoss);
+    void setBusyWindow(uint16_t busyWindow);
+    void setFolderTracks(uint8_t folderTracks, uint16_t folderTrackLength);
+    void resetStats();
+    void printStats(Print &out);
+    uint8_t getState();
+    uint16_t getTrack();
+    uint32_t getPosition();
+    DFPlayerEmulatorStats stats;
+
+private:
+    struct _Frame
+    {
+        uint8_t cmd;
+        uint8_t feedback;
+        uint16_t param;
+        unsigned long due;
+    };
+    void _readByte(uint8_t b);
+    void _parseFrame();
+    void _execute(const _Frame &frame);
+    void _play(uint8_t folder, uint16_t track);
+    void _stop();
+    void _trackDone();
+    uint32_t _trackLength(uint8_t folder, uint16_t track);
+    void _queueReply(uint8_t cmd, uint16_t param, unsigned long due);
+    void _sendFrame(uint8_t cmd, uint16_t param);
+    bool _push(_Frame *queue, uint8_t &head, uint8_t &count, const _Frame &frame);
+    uint16_t _checksum(const uint8_t *frame);
+    bool _lose(uint16_t perMille);
+    uint16_t _random();
+    Stream &_serial;
+    const uint16_t *_trackLengths;
+    uint16_t _tracksNumber;
+    uint8_t _folderTracks;
+    uint16_t _folderTrackLength;
+    // Emulation settings
+    uint16_t _latency;
+    uint16_t _rxLoss;
+    uint16_t _txLoss;
+    uint16_t _busyWindow;
+    // Frame parser
+    uint8_t _rxFrame[DFP_FRAME_LENGTH];
+    uint8_t _rxIndex;
+    unsigned long _lastCommandTime;
+    // Delayed commands and replies
+    _Frame _commands[DFP_QUEUE_SIZE];
+    uint8_t _commandsHead;
+    uint8_t _commandsCount;
+    _Frame _replies[DFP_QUEUE_SIZE];
+    uint8_t _repliesHead;
+    uint8_t _repliesCount;
+    // Virtual playback
+    uint8_t _state;
+    uint8_t _folder;
+    uint16_t _track;
+    unsigned long _startTime;
+    uint32_t _position;
+    uint32_t _length;
+    bool _repeatTrack;
+    bool _repeatFolder;
+    bool _advert;
+    uint8_t _advertSavedState;
+    uint8_t _advertSavedFolder;
+    uint16_t _advertSavedTrack;
+    uint32_t _advertSavedPosition;
+    uint32_t _advertSavedLength;
+    unsigned long _silenceStart;
+    uint8_t _volume;
+    uint8_t _eq;
+    uint16_t _seed;
+};
+
+#endif
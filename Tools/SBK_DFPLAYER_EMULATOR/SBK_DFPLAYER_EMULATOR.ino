@@ -0,0 +1,192 @@
+/**********************************************************************************************
+ *    SBK_DFPLAYER_EMULATOR is a code to emulate a DFPlayer Mini audio player used in many
+ *    Ghostbusters props replica.
+ *    Copyright (c) 2024 Samuel Barabé
+ *
+ *    This program is free software: you can redistribute it and/or modify it under the terms
+ *    of the GNU General Public License as published by the Free Software Foundation, either
+ *    version 3 of the License, or any later version.
+ *
+ *    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *    See the GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License along with this program.
+ *    If not, see <https://www.gnu.org/licenses/>.
+ ***********************************************************************************************/
+
+/**********************************************************************************************
+ *    GENERAL INFO :
+ *
+ *    SBK_DFPLAYER_EMULATOR
+ *    <https://github.com/sbarabe/SBK_PROTONPACK_CORE/tree/main/Tools/SBK_DFPLAYER_EMULATOR>
+ *    Version 0
+ *
+ *    You can use this code on a spare Arduino with a second hardware serial port (Nano Every,
+ *    Mega, Leonardo...) to replace the DFPlayer Mini while testing the pack sound sequencing.
+ *    It answers the pack commands like the real player, with virtual tracks that "play" for
+ *    their defined length, and reports how many commands were lost and how long the silent
+ *    gaps between tracks were.
+ *    1) Line 59 >>> Define the Serial Monitor baud rate, the player link is always 9600 baud.
+ *    2) Lines 62-67 >>> Define the emulated response latency, byte loss rates and busy window.
+ *       Start with 0 everywhere, then increase them to see how the pack copes with a bad player.
+ *    3) Lines 69-85 >>> Copy your TRACK_LENGTH table from the pack ACONFIG.h.
+ *    4) Lines 87-89 >>> Define how many themes tracks are in the "/01/" folder and their length.
+ *    5) Wire the pack player TX pin to this arduino RX1 pin, the pack player RX pin to this
+ *       arduino TX1 pin (through a 1K resistor like the real player), and join the grounds.
+ *    6) Load the code to your arduino module, open your Serial Monitor on the Arduino IDE, and set
+ *       the right baud rate in the Serial Monitor windows.
+ *    7) Send these characters in the Serial Monitor to control the emulator :
+ *       s        : print statistics
+ *       r        : reset statistics
+ *       l<ms>    : set response latency, ex. "l30"
+ *       d<rx>,<tx> : set RX and TX bytes loss per thousand, ex. "d5,0"
+ *       b<ms>    : set busy window, ex. "b100"
+ *
+ *    Each track start and end is printed in the Serial Monitor, as the pack would hear it.
+ *
+ ***********************************************************************************************/
+
+#include <Arduino.h>
+#include "DFPlayerEmulatorEngine.h"
+
+/*********************************************/
+/*                                           */
+/*       EMULATOR definition and helpers     */
+/*                                           */
+/*********************************************/
+/* Serial Monitor baud rate */
+#define BAUD_RATE 9600
+#define PLAYER_BAUD_RATE 9600 // DFPlayer Mini fixed baud rate
+
+/* Emulation settings at start-up, can be changed from the Serial Monitor */
+#define LATENCY 20        // ms between a command reception and its execution, real player is around 10-30 ms
+#define RX_BYTE_LOSS 0    // received bytes lost per thousand
+#define TX_BYTE_LOSS 0    // sent bytes lost per thousand
+#define BUSY_WINDOW 0     // ms after an accepted command during which new commands are ignored
+#define STATS_PERIOD 0    // ms between automatic statistics print, 0 = only on "s" command
+
+/* Tracks milliseconds lengths in index order : copy them from the pack ACONFIG.h */
+/* Track index 0 is just an offset with tracks index, like in the pack ACONFIG.h  */
+const uint16_t TRACK_LENGTH[] = {
+    0,     // no track, it just to offset with tracks index
+    5000,  // track #1
+    10000, // track #2
+    10000, // track #3
+    3000,  // track #4
+    3000,  // track #5
+    10000, // track #6
+    7000,  // track #7
+    7000,  // track #8
+    3000,  // track #9
+    5000,  // track #10
+    3000   // track #11
+};
+const uint16_t TRACKS_NUMBER = sizeof(TRACK_LENGTH) / sizeof(TRACK_LENGTH[0]);
+
+/* Themes tracks in the "/01/" folder */
+#define THEMES_NUMBER 3
+#define THEME_LENGTH 30000
+
+DFPlayerEmulator player(Serial1, TRACK_LENGTH, TRACKS_NUMBER);
+
+char consoleBuffer[16];
+uint8_t consoleIndex = 0;
+
+void runCommand() {
+  char *arg = consoleBuffer + 1;
+  switch (consoleBuffer[0]) {
+    case 's':
+      player.printStats(Serial);
+      break;
+    case 'r':
+      player.resetStats();
+      Serial.println(F("Statistics reset"));
+      break;
+    case 'l':
+      player.setLatency(atoi(arg));
+      Serial.print(F("Latency (ms) : "));
+      Serial.println(atoi(arg));
+      break;
+    case 'd':
+      {
+        char *comma = strchr(arg, ',');
+        uint16_t rxLoss = atoi(arg);
+        uint16_t txLoss = comma ? atoi(comma + 1) : rxLoss;
+        player.setByteLoss(rxLoss, txLoss);
+        Serial.print(F("Bytes loss RX / TX (per thousand) : "));
+        Serial.print(rxLoss);
+        Serial.print(F(" / "));
+        Serial.println(txLoss);
+        break;
+      }
+    case 'b':
+      player.setBusyWindow(atoi(arg));
+      Serial.print(F("Busy window (ms) : "));
+      Serial.println(atoi(arg));
+      break;
+    default:
+      Serial.println(F("Commands : s, r, l<ms>, d<rx>,<tx>, b<ms>"));
+      break;
+  }
+}
+
+void readConsole() {
+  while (Serial.available() > 0) {
+    char c = Serial.read();
+    if (c != '\n' && c != '\r') {
+      if (consoleIndex < sizeof(consoleBuffer) - 1) {
+        consoleBuffer[consoleIndex++] = c;
+      }
+      continue;
+    }
+    if (consoleIndex == 0) {
+      continue;
+    }
+    consoleBuffer[consoleIndex] = '\0';
+    consoleIndex = 0;
+    runCommand();
+  }
+}
+
+void setup() {
+  Serial.begin(BAUD_RATE);
+  Serial1.begin(PLAYER_BAUD_RATE);
+  player.setLatency(LATENCY);
+  player.setByteLoss(RX_BYTE_LOSS, TX_BYTE_LOSS);
+  player.setBusyWindow(BUSY_WINDOW);
+  player.setFolderTracks(THEMES_NUMBER, THEME_LENGTH);
+  player.begin();
+  Serial.println(F("SBK_DFPLAYER_EMULATOR ready"));
+}
+
+void loop() {
+  static uint8_t prevState = DFP_STOPPED;
+  static uint16_t prevTrack = 0;
+  static unsigned long prevStatsTime = 0;
+
+  player.update();
+
+  /* Report tracks starts and ends */
+  if (player.getState() != prevState || player.getTrack() != prevTrack) {
+    Serial.print(millis());
+    Serial.print(F(" ms : "));
+    if (player.getState() == DFP_PLAYING) {
+      Serial.print(F("playing track #"));
+      Serial.println(player.getTrack());
+    } else if (player.getState() == DFP_PAUSED) {
+      Serial.println(F("paused"));
+    } else {
+      Serial.println(F("stopped"));
+    }
+    prevState = player.getState();
+    prevTrack = player.getTrack();
+  }
+
+  if (STATS_PERIOD > 0 && millis() - prevStatsTime >= STATS_PERIOD) {
+    prevStatsTime = millis();
+    player.printStats(Serial);
+  }
+
+  readConsole();
+}
@@ -0,0 +1,32 @@
+/*
+ *  HostArduino.cpp is a part of SBK_HOST_TESTS (Version 0), host tests of SBK_PROTONPACK_CORE engines.
+ *  Copyright (c) 2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE/tree/main/Tools/SBK_HOST_TESTS>.
+ *
+ *  SBK_HOST_TESTS is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_HOST_TESTS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+#include <Arduino.h>
+
+HardwareSerial Serial;
+
+static unsigned long hostMicros = 0;
+
+unsigned long millis() { return hostMicros / 1000; }
+unsigned long micros() { return hostMicros; }
+void delay(unsigned long ms) { hostMicros += ms * 1000; }
+void delayMicroseconds(unsigned int us) { hostMicros += us; }
+void hostAdvance(unsigned long us) { hostMicros += us; }
+
+long random(long howbig) { return howbig > 0 ? rand() % howbig : 0; }
+long random(long howsmall, long howbig) { return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall); }
@@ -0,0 +1,63 @@
+/*
+ *  HostSerial.h is a part of SBK_HOST_TESTS (Version 0), host tests of SBK_PROTONPACK_CORE engines.
+ *  Copyright (c) 2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE/tree/main/Tools/SBK_HOST_TESTS>.
+ *
+ *  SBK_HOST_TESTS is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_HOST_TESTS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+#ifndef HOSTSERIAL_H
+#define HOSTSERIAL_H
+
+#include <Arduino.h>
+
+/*  Serial line between a player and its emulator : each end reads one direction and writes the other. */
+
+// One direction of a serial line
+struct SerialLine
+{
+    uint8_t bytes[256];
+    uint8_t head;
+    uint8_t count;
+};
+
+// One end of a serial line between the player and its emulator
+class SerialEnd : public Stream
+{
+public:
+    SerialEnd(SerialLine &in, SerialLine &out) : _in(in), _out(out) {}
+    int available() { return _in.count; }
+    int read()
+    {
+        if (_in.count == 0)
+        {
+            return -1;
+        }
+        uint8_t b = _in.bytes[_in.head++];
+        _in.count--;
+        return b;
+    }
+    int peek() { return _in.count ? _in.bytes[_in.head] : -1; }
+    size_t write(uint8_t b)
+    {
+        _out.bytes[(uint8_t)(_out.head + _out.count++)] = b;
+        return 1;
+    }
+    using Print::write;
+
+private:
+    SerialLine &_in;
+    SerialLine &_out;
+};
+
+#endif
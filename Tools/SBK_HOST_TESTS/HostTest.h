@@ -0,0 +1,39 @@
+/*
+ *  HostTest.h is a part of SBK_HOST_TESTS (Version 0), host tests of SBK_PROTONPACK_CORE engines.
+ *  Copyright (c) 2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE/tree/main/Tools/SBK_HOST_TESTS>.
+ *
+ *  SBK_HOST_TESTS is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_HOST_TESTS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+#ifndef HOSTTEST_H
+#define HOSTTEST_H
+
+#include <stdio.h>
+
+/*  CHECK() prints the failed condition, the test program returns the failures count. */
+static int hostFailures = 0;
+
+#define CHECK(condition)                                                          \
+    do                                                                            \
+    {                                                                             \
+        if (!(condition))                                                         \
+        {                                                                         \
+            printf("  FAILED %s:%d : %s\n", __FILE__, __LINE__, #condition);      \
+            hostFailures++;                                                       \
+        }                                                                         \
+    } while (0)
+
+#define TEST_RESULT(name) (printf("%s : %s\n", name, hostFailures ? "FAILED" : "OK"), hostFailures)
+
+#endif
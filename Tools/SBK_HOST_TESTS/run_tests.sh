@@ -0,0 +1,93 @@
+#!/bin/sh
+###############################################################################################
+#    SBK_HOST_TESTS : host tests of SBK_PROTONPACK_CORE engines.
+#    Copyright (c) 2024 Samuel Barabé
+#
+#    This program is free software: you can redistribute it and/or modify it under the terms
+#    of the GNU General Public License as published by the Free Software Foundation, either
+#    version 3 of the License, or any later version.
+#
+#    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+#    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+#    See the GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License along with this program.
+#    If not, see <https://www.gnu.org/licenses/>.
+###############################################################################################
+
+###############################################################################################
+#    GENERAL INFO :
+#
+#    Runs on the host computer with g++ (C++11), from this folder :
+#
+#      sh run_tests.sh
+#
+#    Each test_xxx.cpp is built with the sketch engines, stub/Arduino.h (simulated time) and the
+#    libraries installed by PlatformIO in .pio/libdeps, then run. Exits with 1 if a test failed.
+###############################################################################################
+
+CORE=../../SBK_PROTONPACK_CORE
+LIBS=../../.pio/libdeps/nano_every
+BUILD=${TMPDIR:-/tmp}/sbk_host_tests
+CXX="${CXX:-g++} -std=gnu++11 -Wall -Istub -I. -I$CORE"
+mkdir -p "$BUILD"
+failed=0
+
+# run_test <test> <sources and flags...>
+run_test() {
+    name=$1
+    shift
+    if $CXX "$name.cpp" HostArduino.cpp "$@" -o "$BUILD/$name" && "$BUILD/$name"; then
+        :
+    else
+        failed=1
+    fi
+}
+
+run_test test_dual_player -I../SBK_DFPLAYER_EMULATOR -I$LIBS/DFPlayerMini_Fast/src -I$LIBS/FireTimer/src \
+    $CORE/VolumePotEngine.cpp ../SBK_DFPLAYER_EMULATOR/DFPlayerEmulatorEngine.cpp \
+    $LIBS/DFPlayerMini_Fast/src/DFPlayerMini_Fast.cpp $LIBS/FireTimer/src/FireTimer.cpp
+
+run_test test_overlay_player -I../SBK_DFPLAYER_EMULATOR -I$LIBS/DFPlayerMini_Fast/src -I$LIBS/FireTimer/src \
+    $CORE/VolumePotEngine.cpp ../SBK_DFPLAYER_EMULATOR/DFPlayerEmulatorEngine.cpp \
+    $LIBS/DFPlayerMini_Fast/src/DFPlayerMini_Fast.cpp $LIBS/FireTimer/src/FireTimer.cpp
+
+run_test test_player_faults -I../SBK_DFPLAYER_EMULATOR -I$LIBS/DFPlayerMini_Fast/src -I$LIBS/FireTimer/src \
+    $CORE/VolumePotEngine.cpp ../SBK_DFPLAYER_EMULATOR/DFPlayerEmulatorEngine.cpp \
+    $LIBS/DFPlayerMini_Fast/src/DFPlayerMini_Fast.cpp $LIBS/FireTimer/src/FireTimer.cpp
+
+run_test test_timestep $CORE/TimestepEngine.cpp
+
+run_test test_ws2812_usart "-I$LIBS/Adafruit NeoPixel" $CORE/WS2812OutputEngine.cpp
+
+run_test test_ws2812_color_stage "-I$LIBS/Adafruit NeoPixel" $CORE/WS2812OutputEngine.cpp
+
+run_test test_ws2812_crossfade "-I$LIBS/Adafruit NeoPixel" $CORE/WS2812OutputEngine.cpp
+
+# Parallel WS2812 bit loop : the engine asm preprocessed for each AVR core, ST cycles given to the simulation.
+# The engine T0H, T1H and bit cycles constants are added at the end of the preprocessed file, then evaluated.
+ws2812_parallel() {
+    mcu=$1
+    st=$2
+    shift 2
+    i="$BUILD/WS2812OutputEngine_$mcu.i"
+    if { cat $CORE/WS2812OutputEngine.cpp; echo "WS2812_CYCLES_T0H : WS2812_CYCLES_T1H : WS2812_CYCLES_BIT"; } |
+        $CXX -E -P -D__AVR__ -D__AVR_${mcu}__ "$@" -DF_CPU=16000000L "-I$LIBS/Adafruit NeoPixel" -x c++ - -o "$i"; then
+        cycles=$(tail -n 1 "$i")
+        t0h=$((${cycles%% :*}))
+        bit=$((${cycles##*: }))
+        cycles=${cycles#*: }
+        t1h=$((${cycles%% :*}))
+        "$BUILD/test_ws2812_parallel" "$i" $st $mcu $t0h $t1h $bit || failed=1
+    else
+        failed=1
+    fi
+}
+if $CXX test_ws2812_parallel.cpp HostArduino.cpp -o "$BUILD/test_ws2812_parallel"; then
+    ws2812_parallel ATmega328P 2
+    ws2812_parallel ATmega4809 1 -D__AVR_XMEGA__
+else
+    failed=1
+fi
+
+exit $failed
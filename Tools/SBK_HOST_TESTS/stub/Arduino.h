@@ -0,0 +1,138 @@
+/*
+ *  Arduino.h is a part of SBK_HOST_TESTS (Version 0), host tests of SBK_PROTONPACK_CORE engines.
+ *  Copyright (c) 2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE/tree/main/Tools/SBK_HOST_TESTS>.
+ *
+ *  SBK_HOST_TESTS is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_HOST_TESTS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/*  Just enough of the Arduino core to run the engines on the host computer. */
+/*  Time is simulated : millis() and micros() only move with delay(), delayMicroseconds() and hostAdvance(). */
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <stddef.h>
+
+#ifndef F_CPU
+#define F_CPU 16000000L
+#endif
+typedef bool boolean;
+typedef uint8_t byte;
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define DEC 10
+#define HEX 16
+#define BIN 2
+#define PROGMEM
+class __FlashStringHelper;
+#define F(x) (reinterpret_cast<const __FlashStringHelper *>(x))
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define pgm_read_ptr(p) (*(void *const *)(p))
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define clockCyclesPerMicrosecond() (F_CPU / 1000000L)
+#define noInterrupts()
+#define interrupts()
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void hostAdvance(unsigned long us); // moves the simulated time
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return 0; }
+inline int analogRead(uint8_t) { return 0; }
+long random(long howbig);
+long random(long howsmall, long howbig);
+
+class Print
+{
+public:
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            write(buffer[i]);
+        }
+        return size;
+    }
+    size_t print(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+    size_t print(const __FlashStringHelper *s) { return print((const char *)s); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(long n, int base = DEC) { return _printf(base == HEX ? "%lX" : "%ld", n); }
+    size_t print(unsigned long n, int base = DEC) { return _printf(base == HEX ? "%lX" : "%lu", n); }
+    size_t print(int n, int base = DEC) { return print((long)n, base); }
+    size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+    size_t print(unsigned char n, int base = DEC) { return print((unsigned long)n, base); }
+    size_t print(double n, int digits = 2) { return _printf("%.*f", digits, n); }
+    size_t println() { return print("\n"); }
+    template <class T>
+    size_t println(T value) { return print(value) + println(); }
+    template <class T>
+    size_t println(T value, int format) { return print(value, format) + println(); }
+
+private:
+    template <class T>
+    size_t _printf(const char *format, T value)
+    {
+        char buffer[24];
+        snprintf(buffer, sizeof(buffer), format, value);
+        return print(buffer);
+    }
+    template <class T>
+    size_t _printf(const char *format, int digits, T value)
+    {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), format, digits, value);
+        return print(buffer);
+    }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+    void setTimeout(unsigned long) {}
+};
+
+// Serial Monitor : printed on stdout, nothing received
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long) {}
+    int available() { return 0; }
+    int read() { return -1; }
+    int peek() { return -1; }
+    size_t write(uint8_t c) { return fputc(c, stdout) == EOF ? 0 : 1; }
+    using Print::write;
+    operator bool() { return true; }
+};
+extern HardwareSerial Serial;
+
+#endif
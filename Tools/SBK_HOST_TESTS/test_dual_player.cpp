@@ -0,0 +1,144 @@
+/*
+ *  test_dual_player.cpp is a part of SBK_HOST_TESTS (Version 0), host tests of SBK_PROTONPACK_CORE engines.
+ *  Copyright (c) 2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE/tree/main/Tools/SBK_HOST_TESTS>.
+ *
+ *  SBK_HOST_TESTS is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_HOST_TESTS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+/*  DualPlayer<> with the DFPlayerMini_Fast backend, each voice wired to a DFPlayerEmulator. */
+/*  The pack fire cycle is played like the sketch does it with DUAL_PLAYER : the charged idle hum */
+/*  loops on the loop voice, firing and tail tracks are layered over it on the sound FX voice. */
+/*  Checks the hum never stops and prints the commands count and silent gaps per fire cycle. */
+
+#include <Arduino.h>
+#include "HostTest.h"
+#include "HostSerial.h"
+#include "PlayerEngine.h"
+#include "PlayerBackend_DFPlayerMini_Fast.h"
+#include "DFPlayerEmulatorEngine.h"
+
+#define FIRE_CYCLES 5
+#define COMMAND_DELAY 20
+#define LATENCY 20
+
+const int16_t CHARGED_IDLE_TRACK = 3;
+const int16_t FIRING_RAMP_TRACK = 6;
+const int16_t FIRING_MAX_TRACK = 7;
+const int16_t TAIL_TRACK = 9;
+const uint16_t TRACK_LENGTH[] = {0, 5000, 10000, 10000, 3000, 3000, 10000, 7000, 7000, 3000, 3000, 3000};
+const uint16_t TRACKS_NUMBER = sizeof(TRACK_LENGTH) / sizeof(TRACK_LENGTH[0]);
+const uint16_t FIRING_RAMP_LENGTH = 1500; // ramp state length before the firing max track
+const uint16_t FIRING_LENGTH = 6000;      // fire button held
+
+SerialLine loopTx = {}, loopRx = {}, sfxTx = {}, sfxRx = {};
+SerialEnd loopPack(loopRx, loopTx), loopBoard(loopTx, loopRx);
+SerialEnd sfxPack(sfxRx, sfxTx), sfxBoard(sfxTx, sfxRx);
+DFPlayerEmulator loopEmulator(loopBoard, TRACK_LENGTH, TRACKS_NUMBER);
+DFPlayerEmulator sfxEmulator(sfxBoard, TRACK_LENGTH, TRACKS_NUMBER);
+DualPlayer<PlayerBackend_DFPlayerMini_Fast> player(30, 20, 0, 1, 2, 3, 0, false, COMMAND_DELAY, 80, 100);
+bool humChecked = false;      // the hum must be playing from now on
+bool humStopped = false;
+bool firing = false;          // between the firing ramp start and the tail end
+unsigned long silence = 0;    // ms without sound FX while firing
+unsigned long silenceMax = 0; // longest silence while firing
+unsigned long silenceRun = 0;
+
+// Runs the pack main loop for the duration, 1 ms per loop
+void run(unsigned long duration)
+{
+    for (unsigned long t = 0; t < duration; t++)
+    {
+        hostAdvance(1000);
+        player.update();
+        loopEmulator.update();
+        sfxEmulator.update();
+        if (humChecked && (loopEmulator.getState() != DFP_PLAYING || loopEmulator.getTrack() != CHARGED_IDLE_TRACK))
+        {
+            humStopped = true;
+        }
+        if (firing && sfxEmulator.getState() != DFP_PLAYING)
+        {
+            silence++;
+            silenceRun++;
+            silenceMax = max(silenceMax, silenceRun);
+        }
+        else
+        {
+            silenceRun = 0;
+        }
+    }
+}
+
+// Waits for the sound FX track end, like checkIfTrackDoneExit() in the sketch
+void runUntilDone(unsigned long timeout)
+{
+    for (unsigned long t = 0; t < timeout && player.isPlaying(); t++)
+    {
+        run(1);
+    }
+}
+
+int main()
+{
+    loopEmulator.setLatency(LATENCY);
+    sfxEmulator.setLatency(LATENCY);
+    loopEmulator.begin();
+    sfxEmulator.begin();
+    CHECK(player.begin(loopPack, sfxPack));
+
+    // Charged idle hum, then a few seconds for the players to settle
+    player.loopFileNum(CHARGED_IDLE_TRACK);
+    player.setCyclingTrackPlaymode();
+    run(2000);
+    CHECK(loopEmulator.getState() == DFP_PLAYING && loopEmulator.getTrack() == CHARGED_IDLE_TRACK);
+    loopEmulator.resetStats();
+    sfxEmulator.resetStats();
+    humChecked = true;
+
+    for (uint8_t cycle = 0; cycle < FIRE_CYCLES; cycle++)
+    {
+        // STATE_FIRING_RAMP, then STATE_FIRING with its looping overlay, STATE_TAIL and back to charged idle
+        player.insertFileNum(FIRING_RAMP_TRACK, FIRING_RAMP_LENGTH);
+        while (sfxEmulator.getState() != DFP_PLAYING)
+        {
+            run(1); // command delay and player latency before the first sound
+        }
+        firing = true;
+        runUntilDone(FIRING_RAMP_LENGTH + 100);
+        for (unsigned long fired = 0; fired < FIRING_LENGTH; fired++)
+        {
+            if (!player.isPlaying())
+            {
+                player.insertFileNum(FIRING_MAX_TRACK, TRACK_LENGTH[FIRING_MAX_TRACK]);
+            }
+            run(1);
+        }
+        player.insertFileNum(TAIL_TRACK, TRACK_LENGTH[TAIL_TRACK]);
+        runUntilDone(TRACK_LENGTH[TAIL_TRACK] + 100);
+        firing = false;
+        player.stopInsert();
+        run(3000);
+        CHECK(sfxEmulator.getState() == DFP_STOPPED);
+    }
+
+    CHECK(!humStopped);
+    CHECK(loopEmulator.stats.transitions == 0); // the hum was never restarted
+    CHECK(loopEmulator.stats.commandsExecuted == 0);
+    CHECK(sfxEmulator.stats.transitions == 3 * FIRE_CYCLES);
+    CHECK(sfxEmulator.stats.commandsOverflow == 0 && sfxEmulator.stats.framesCorrupted == 0);
+    printf("  per fire cycle : loop voice %.1f commands, sound FX voice %.1f commands\n",
+           (double)loopEmulator.stats.commandsExecuted / FIRE_CYCLES, (double)sfxEmulator.stats.commandsExecuted / FIRE_CYCLES);
+    printf("  sound FX silence while firing : %.1f ms per fire cycle, %lu ms max\n", (double)silence / FIRE_CYCLES, silenceMax);
+    return TEST_RESULT("test_dual_player");
+}
@@ -0,0 +1,155 @@
+/*
+ *  test_overlay_player.cpp is a part of SBK_HOST_TESTS (Version 0), host tests of SBK_PROTONPACK_CORE engines.
+ *  Copyright (c) 2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE/tree/main/Tools/SBK_HOST_TESTS>.
+ *
+ *  SBK_HOST_TESTS is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_HOST_TESTS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+/*  Player<> with the DFPlayerMini_Fast backend, wired to a DFPlayerEmulator. The pack fire cycle is */
+/*  played like the sketch does it with TRACK_OVERLAY firing and tail tracks : the charged idle hum loops, */
+/*  the firing ramp, firing max (inserted again when done) and tail tracks are inserted over it. */
+/*  Checks the hum is never restarted and prints the commands count, the insert latency and the longest */
+/*  hum only gap between inserted tracks per fire cycle. */
+
+#include <Arduino.h>
+#include "HostTest.h"
+#include "HostSerial.h"
+#include "PlayerEngine.h"
+#include "PlayerBackend_DFPlayerMini_Fast.h"
+#include "DFPlayerEmulatorEngine.h"
+
+#define FIRE_CYCLES 5
+#define COMMAND_DELAY 20
+#define LATENCY 20
+
+const int16_t CHARGED_IDLE_TRACK = 3;
+const int16_t FIRING_RAMP_TRACK = 6;
+const int16_t FIRING_MAX_TRACK = 7;
+const int16_t TAIL_TRACK = 9;
+const uint16_t TRACK_LENGTH[] = {0, 5000, 10000, 10000, 3000, 3000, 1500, 2000, 7000, 3000, 3000, 3000};
+const uint16_t TRACKS_NUMBER = sizeof(TRACK_LENGTH) / sizeof(TRACK_LENGTH[0]);
+const uint16_t FIRING_LENGTH = 6000; // fire button held after the firing ramp
+
+SerialLine packTx = {}, packRx = {};
+SerialEnd pack(packRx, packTx), board(packTx, packRx);
+DFPlayerEmulator emulator(board, TRACK_LENGTH, TRACKS_NUMBER);
+Player<PlayerBackend_DFPlayerMini_Fast> player(30, 20, 0, 1, 0, false, COMMAND_DELAY);
+bool humChecked = false;      // the hum must be playing from now on
+bool humStopped = false;
+uint32_t inserts = 0;         // insertFileNum() calls
+unsigned long lastCommand = 0;
+int16_t inserted = 0;         // track inserted, waiting for the player
+unsigned long insertTime = 0;
+unsigned long latencyMax = 0; // insertFileNum() to the track heard
+bool firing = false;          // between the firing ramp start and the tail end
+unsigned long gapRun = 0;     // ms of hum only while firing
+unsigned long gapMax = 0;
+
+// Runs the pack main loop for the duration, 1 ms per loop
+void run(unsigned long duration)
+{
+    for (unsigned long t = 0; t < duration; t++)
+    {
+        hostAdvance(1000);
+        player.update();
+        emulator.update();
+        if (humChecked && emulator.getState() != DFP_PLAYING)
+        {
+            humStopped = true;
+        }
+        if (inserted && emulator.getTrack() == inserted)
+        {
+            latencyMax = max(latencyMax, millis() - insertTime);
+            inserted = 0;
+        }
+        if (firing && emulator.getTrack() == CHARGED_IDLE_TRACK)
+        {
+            gapRun++;
+            gapMax = max(gapMax, gapRun);
+        }
+        else
+        {
+            gapRun = 0;
+        }
+    }
+}
+
+// Inserts the track over the hum, like playThisStateTrack() in the sketch
+void insert(int16_t track)
+{
+    while (millis() - lastCommand <= COMMAND_DELAY)
+    {
+        run(1);
+    }
+    player.insertFileNum(track, TRACK_LENGTH[track]);
+    lastCommand = millis();
+    inserted = track;
+    insertTime = millis();
+    inserts++;
+}
+
+// Waits for the inserted track end, like checkIfTrackDoneExit() in the sketch
+void runUntilDone(unsigned long timeout)
+{
+    for (unsigned long t = 0; t < timeout && player.isPlaying(); t++)
+    {
+        run(1);
+    }
+}
+
+int main()
+{
+    emulator.setLatency(LATENCY);
+    emulator.begin();
+    CHECK(player.begin(pack));
+
+    // Charged idle hum, then a few seconds for the player to settle
+    player.loopFileNum(CHARGED_IDLE_TRACK);
+    run(2000);
+    CHECK(emulator.getState() == DFP_PLAYING && emulator.getTrack() == CHARGED_IDLE_TRACK);
+    emulator.resetStats();
+    humChecked = true;
+
+    for (uint8_t cycle = 0; cycle < FIRE_CYCLES; cycle++)
+    {
+        // STATE_FIRING_RAMP, STATE_FIRING_MAX inserted again when done, STATE_TAIL and back to charged idle
+        firing = true;
+        insert(FIRING_RAMP_TRACK);
+        runUntilDone(TRACK_LENGTH[FIRING_RAMP_TRACK] + 100);
+        insert(FIRING_MAX_TRACK);
+        for (unsigned long fired = 0; fired < FIRING_LENGTH; fired++)
+        {
+            if (!player.isPlaying())
+            {
+                insert(FIRING_MAX_TRACK);
+            }
+            run(1);
+        }
+        insert(TAIL_TRACK);
+        runUntilDone(TRACK_LENGTH[TAIL_TRACK] + 100);
+        firing = false;
+        player.stopInsert();
+        lastCommand = millis();
+        run(3000);
+        CHECK(emulator.getTrack() == CHARGED_IDLE_TRACK);
+    }
+
+    CHECK(!humStopped);
+    CHECK(emulator.stats.transitions == inserts); // every insert was heard, the hum was never restarted
+    CHECK(emulator.stats.commandsOverflow == 0 && emulator.stats.framesCorrupted == 0);
+    printf("  per fire cycle : %.1f commands, %.1f inserts, %lu hum restarts\n", (double)emulator.stats.commandsExecuted / FIRE_CYCLES,
+           (double)inserts / FIRE_CYCLES, (unsigned long)(emulator.stats.transitions - inserts));
+    printf("  insert latency %lu ms max, longest hum only gap while firing %lu ms\n", latencyMax, gapMax);
+    return TEST_RESULT("test_overlay_player");
+}
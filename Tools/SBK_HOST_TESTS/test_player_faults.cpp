@@ -0,0 +1,163 @@
+/*
+ *  test_player_faults.cpp is a part of SBK_HOST_TESTS (Version 0), host tests of SBK_PROTONPACK_CORE engines.
+ *  Copyright (c) 2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE/tree/main/Tools/SBK_HOST_TESTS>.
+ *
+ *  SBK_HOST_TESTS is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_HOST_TESTS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+/*  Player<> with the DFPlayerMini_Fast backend, wired to a DFPlayerEmulator with command bytes lost on */
+/*  the line (as during WS2812 show()) and a busy player ignoring commands sent too quickly. */
+/*  For each byte loss and busy window, fire cycles are played like the sketch with TRACK_REPLACE tracks : */
+/*  full cycles (firing ramp, firing max, tail, back to the hum) and fire taps (tail right after the ramp, */
+/*  one command delay later). Prints the dropped commands, by cause, and the transitions latency. */
+/*  Checks a clean line drops nothing, and that every dropped command is accounted for by the emulator. */
+
+#include <Arduino.h>
+#include "HostTest.h"
+#include "HostSerial.h"
+#include "PlayerEngine.h"
+#include "PlayerBackend_DFPlayerMini_Fast.h"
+#include "DFPlayerEmulatorEngine.h"
+
+#define FIRE_CYCLES 50
+#define COMMAND_DELAY 150 // PLAYER_COMMAND_DELAY in the sketch, shortest time between two commands
+#define LATENCY 20
+
+const int16_t CHARGED_IDLE_TRACK = 3;
+const int16_t FIRING_RAMP_TRACK = 6;
+const int16_t FIRING_MAX_TRACK = 7;
+const int16_t TAIL_TRACK = 9;
+const uint16_t TRACK_LENGTH[] = {0, 5000, 10000, 10000, 3000, 3000, 1500, 7000, 7000, 3000, 3000, 3000};
+const uint16_t TRACKS_NUMBER = sizeof(TRACK_LENGTH) / sizeof(TRACK_LENGTH[0]);
+const uint16_t FIRING_LENGTH = 3000; // fire button held after the firing ramp
+const uint16_t RX_LOSS[] = {0, 1, 5, 20};          // command bytes lost per thousand
+const uint16_t BUSY_WINDOW[] = {0, 100, 150, 200}; // ms
+
+// One sweep point : a fresh line, emulator and player
+struct Bench
+{
+    Bench() : pack(packRx, packTx), board(packTx, packRx), emulator(board, TRACK_LENGTH, TRACKS_NUMBER),
+              player(30, 20, 0, 1, 0, false, COMMAND_DELAY)
+    {
+        packTx = {};
+        packRx = {};
+    }
+    SerialLine packTx, packRx;
+    SerialEnd pack, board;
+    DFPlayerEmulator emulator;
+    Player<PlayerBackend_DFPlayerMini_Fast> player;
+    uint32_t sent = 0;      // commands sent by the player
+    uint32_t expected = 0;  // track transitions asked
+    uint32_t heard = 0;
+    unsigned long latencyTotal = 0;
+    unsigned long latencyMax = 0;
+    int16_t waiting = 0;    // track asked, not heard yet
+    unsigned long askTime = 0;
+
+    // Runs the pack main loop for the duration, 1 ms per loop
+    void run(unsigned long duration)
+    {
+        for (unsigned long t = 0; t < duration; t++)
+        {
+            hostAdvance(1000);
+            player.update();
+            emulator.update();
+            if (waiting && emulator.getState() == DFP_PLAYING && emulator.getTrack() == waiting)
+            {
+                unsigned long latency = millis() - askTime;
+                latencyTotal += latency;
+                latencyMax = max(latencyMax, latency);
+                heard++;
+                waiting = 0;
+            }
+        }
+    }
+
+    // Next pack state track, at least one command delay after the last one, like the sketch
+    void ask(int16_t track, bool looping)
+    {
+        if (looping)
+        {
+            player.loopFileNum(track);
+        }
+        else
+        {
+            player.playFileNum(track, TRACK_LENGTH[track]);
+        }
+        sent++;
+        expected++;
+        waiting = track;
+        askTime = millis();
+        run(COMMAND_DELAY);
+    }
+};
+
+int main()
+{
+    printf("  loss/1000 busy ms : dropped %% (busy, corrupted, overflow), transitions heard, latency avg/max ms\n");
+    for (uint8_t l = 0; l < sizeof(RX_LOSS) / sizeof(RX_LOSS[0]); l++)
+    {
+        for (uint8_t b = 0; b < sizeof(BUSY_WINDOW) / sizeof(BUSY_WINDOW[0]); b++)
+        {
+            Bench bench;
+            bench.emulator.setLatency(LATENCY);
+            bench.emulator.begin();
+            CHECK(bench.player.begin(bench.pack));
+            bench.ask(CHARGED_IDLE_TRACK, true);
+            bench.run(1000);
+            bench.emulator.setByteLoss(RX_LOSS[l], 0);
+            bench.emulator.setBusyWindow(BUSY_WINDOW[b]);
+            bench.emulator.resetStats();
+            bench.sent = bench.expected = bench.heard = 0;
+            bench.latencyTotal = bench.latencyMax = 0;
+
+            for (uint8_t cycle = 0; cycle < FIRE_CYCLES; cycle++)
+            {
+                // Full cycle : STATE_FIRING_RAMP, STATE_FIRING_MAX, STATE_TAIL, back to charged idle
+                bench.ask(FIRING_RAMP_TRACK, false);
+                bench.run(TRACK_LENGTH[FIRING_RAMP_TRACK] - COMMAND_DELAY);
+                bench.ask(FIRING_MAX_TRACK, false);
+                bench.run(FIRING_LENGTH - COMMAND_DELAY);
+                bench.ask(TAIL_TRACK, false);
+                bench.run(TRACK_LENGTH[TAIL_TRACK] - COMMAND_DELAY);
+                bench.ask(CHARGED_IDLE_TRACK, true);
+                bench.run(1000);
+                // Fire tap : released as soon as the player accepts the next command
+                bench.ask(FIRING_RAMP_TRACK, false);
+                bench.ask(TAIL_TRACK, false);
+                bench.run(TRACK_LENGTH[TAIL_TRACK] - COMMAND_DELAY);
+                bench.ask(CHARGED_IDLE_TRACK, true);
+                bench.run(1000);
+            }
+
+            DFPlayerEmulatorStats &stats = bench.emulator.stats;
+            uint32_t dropped = bench.sent - stats.commandsExecuted;
+            // A command lost on the line is corrupted (one of its bytes missing) or never seen (start byte missing)
+            CHECK(stats.commandsExecuted <= bench.sent);
+            CHECK(stats.commandsIgnoredBusy + stats.commandsOverflow <= dropped);
+            if (RX_LOSS[l] == 0)
+            {
+                CHECK(stats.framesCorrupted == 0 && stats.bytesLostRx == 0);
+            }
+            if (RX_LOSS[l] == 0 && BUSY_WINDOW[b] <= COMMAND_DELAY)
+            {
+                CHECK(dropped == 0 && bench.heard == bench.expected);
+            }
+            printf("  %9u %7u : %5.1f %% (%lu, %lu, %lu), %lu/%lu, %lu/%lu\n", RX_LOSS[l], BUSY_WINDOW[b], 100.0 * dropped / bench.sent,
+                   (unsigned long)stats.commandsIgnoredBusy, (unsigned long)stats.framesCorrupted, (unsigned long)stats.commandsOverflow,
+                   (unsigned long)bench.heard, (unsigned long)bench.expected, bench.heard ? bench.latencyTotal / bench.heard : 0, bench.latencyMax);
+        }
+    }
+    return TEST_RESULT("test_player_faults");
+}
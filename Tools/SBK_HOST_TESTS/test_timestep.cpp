@@ -0,0 +1,90 @@
+/*
+ *  test_timestep.cpp is a part of SBK_HOST_TESTS (Version 0), host tests of SBK_PROTONPACK_CORE engines.
+ *  Copyright (c) 2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE/tree/main/Tools/SBK_HOST_TESTS>.
+ *
+ *  SBK_HOST_TESTS is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_HOST_TESTS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+/*  Timestep::steps() under a jittery main loop (loop times from 1 ms to 3 intervals), then */
+/*  stalls around the TIMESTEP_MAX_CATCHUP cap and the interval == 0 path. The millis() rollover is */
+/*  not tested : unsigned long is 64 bits on the host. */
+/*  Steps must add up to the elapsed intervals (the animation keeps its speed) until the cap, */
+/*  then restart from the stall end. */
+
+#include <Arduino.h>
+#include "HostTest.h"
+#include "TimestepEngine.h"
+
+#define INTERVAL 20
+#define LOOPS 10000
+
+static uint32_t seed = 12345;
+
+// Loop time with jitter, deterministic
+static uint16_t jitter(uint16_t low, uint16_t high)
+{
+    seed = seed * 1103515245UL + 12345;
+    return low + (seed >> 16) % (high - low + 1);
+}
+
+int main()
+{
+    Timestep step;
+
+    // Jitter : 1 ms to 3 intervals per loop, every interval elapsed gives one step
+    unsigned long now = 1000;
+    step.reset(now);
+    unsigned long start = now;
+    uint32_t total = 0;
+    uint8_t most = 0;
+    for (uint16_t i = 0; i < LOOPS; i++)
+    {
+        now += jitter(1, 3 * INTERVAL);
+        uint8_t n = step.steps(now, INTERVAL);
+        total += n;
+        most = max(most, n);
+    }
+    CHECK(total == (now - start) / INTERVAL);
+    CHECK(most == 3);
+    unsigned long jitterSteps = total;
+
+    // Not elapsed yet
+    step.reset(now);
+    CHECK(step.steps(now + INTERVAL - 1, INTERVAL) == 0);
+    CHECK(step.steps(now + INTERVAL, INTERVAL) == 1);
+
+    // Stall at the cap : all steps caught up, the phase is kept
+    now += INTERVAL;
+    CHECK(step.steps(now + TIMESTEP_MAX_CATCHUP * INTERVAL + 5, INTERVAL) == TIMESTEP_MAX_CATCHUP);
+    now += TIMESTEP_MAX_CATCHUP * INTERVAL;
+    CHECK(step.steps(now + INTERVAL - 1, INTERVAL) == 0);
+    CHECK(step.steps(now + INTERVAL, INTERVAL) == 1);
+    now += INTERVAL;
+
+    // Stall over the cap : one step, then the next one an interval after the stall end
+    unsigned long stallEnd = now + (TIMESTEP_MAX_CATCHUP + 1) * INTERVAL + 5;
+    CHECK(step.steps(stallEnd, INTERVAL) == 1);
+    CHECK(step.steps(stallEnd + INTERVAL - 1, INTERVAL) == 0);
+    CHECK(step.steps(stallEnd + INTERVAL, INTERVAL) == 1);
+
+    // Interval 0 : one step per call, whatever the time
+    CHECK(step.steps(stallEnd + INTERVAL, 0) == 1);
+    CHECK(step.steps(stallEnd + INTERVAL, 0) == 1);
+    CHECK(step.steps(stallEnd + 5000, 0) == 1);
+    CHECK(step.steps(stallEnd + 5000 + INTERVAL - 1, INTERVAL) == 0);
+
+    printf("  %u loops with 1 to %u ms jitter : %lu steps of %u ms, %u steps at most in one call\n",
+           LOOPS, 3 * INTERVAL, jitterSteps, INTERVAL, most);
+    return TEST_RESULT("test_timestep");
+}
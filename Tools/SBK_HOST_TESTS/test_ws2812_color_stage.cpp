@@ -0,0 +1,77 @@
+/*
+ *  test_ws2812_color_stage.cpp is a part of SBK_HOST_TESTS (Version 0), host tests of SBK_PROTONPACK_CORE engines.
+ *  Copyright (c) 2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE/tree/main/Tools/SBK_HOST_TESTS>.
+ *
+ *  SBK_HOST_TESTS is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_HOST_TESTS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+/*  Color stage of WS2812OutputEngine.cpp : every engine level sent through showA() at full brightness. */
+/*  The output must never go down as the level goes up, every level over 0 must stay lit, the low levels */
+/*  must stay distinct (the linear toe under the gamma curve) and the upper levels must follow the gamma. */
+
+#include <Arduino.h>
+#include "HostTest.h"
+#include "WS2812OutputEngine.h"
+
+#define PWD_MAX_LEVEL 10 // GB12_PWD_MAX_BRIGHTNESS, powered down cyclotron pulse
+
+// Host chain buffer, output of the engine not used on host
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t n, int16_t p, neoPixelType t)
+{
+    numLEDs = n;
+    numBytes = n * 3;
+    pixels = (uint8_t *)calloc(numBytes, 1);
+}
+Adafruit_NeoPixel::~Adafruit_NeoPixel() { free(pixels); }
+void Adafruit_NeoPixel::show() {}
+void Adafruit_NeoPixel::setPixelColor(uint16_t, uint8_t, uint8_t, uint8_t) {}
+
+Adafruit_NeoPixel packLeds(1, 2, NEO_GRB + NEO_KHZ800);
+Adafruit_NeoPixel wandLeds(0, 3, NEO_GRB + NEO_KHZ800);
+WS2812Output ledsOutput(packLeds, wandLeds);
+
+int main()
+{
+    ledsOutput.beginColorStage(WS2812_CHAIN_A, 255, 255, 255, 255);
+    uint8_t out[256];
+    for (uint16_t level = 0; level < 256; level++)
+    {
+        memset(packLeds.getPixels(), level, 3);
+        ledsOutput.showA();
+        out[level] = packLeds.getPixels()[0];
+    }
+
+    CHECK(out[0] == 0 && out[255] == 255);
+    bool monotonic = true, lit = true, gamma = true;
+    uint8_t distinct = 0;
+    for (uint16_t level = 1; level < 256; level++)
+    {
+        monotonic = monotonic && out[level] >= out[level - 1];
+        lit = lit && out[level] > 0;
+        gamma = gamma && (level < 110 || out[level] == Adafruit_NeoPixel::gamma8(level));
+        distinct += (level <= 27 && out[level] != out[level - 1]);
+    }
+    CHECK(monotonic);
+    CHECK(lit);
+    CHECK(gamma);
+    CHECK(distinct >= 6); // plain gamma : the 27 lowest levels all give 0 (1 once kept lit)
+    CHECK(out[PWD_MAX_LEVEL] >= 3);
+    printf("  levels 0 to %u :", PWD_MAX_LEVEL);
+    for (uint8_t level = 0; level <= PWD_MAX_LEVEL; level++)
+    {
+        printf(" %u", out[level]);
+    }
+    printf(", %u distinct outputs for levels 1 to 27\n", distinct);
+    return TEST_RESULT("test_ws2812_color_stage");
+}
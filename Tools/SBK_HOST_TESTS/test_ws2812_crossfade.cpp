@@ -0,0 +1,76 @@
+/*
+ *  test_ws2812_crossfade.cpp is a part of SBK_HOST_TESTS (Version 0), host tests of SBK_PROTONPACK_CORE engines.
+ *  Copyright (c) 2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE/tree/main/Tools/SBK_HOST_TESTS>.
+ *
+ *  SBK_HOST_TESTS is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_HOST_TESTS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+/*  Compositor crossfade of WS2812OutputEngine.cpp : a state animation fading in over the last frame, then */
+/*  a new state entered while it is still fading (quick fire tap). The second fade must start from the */
+/*  blended frame on the chain, not jump back to the frame of the first state. */
+
+#include <Arduino.h>
+#include "HostTest.h"
+#include "WS2812OutputEngine.h"
+
+#define FADE_TIME 100
+
+// Host chain buffer, output of the engine not used on host
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t n, int16_t p, neoPixelType t)
+{
+    numLEDs = n;
+    numBytes = n * 3;
+    pixels = (uint8_t *)calloc(numBytes, 1);
+}
+Adafruit_NeoPixel::~Adafruit_NeoPixel() { free(pixels); }
+void Adafruit_NeoPixel::show() {}
+void Adafruit_NeoPixel::setPixelColor(uint16_t, uint8_t, uint8_t, uint8_t) {}
+
+Adafruit_NeoPixel packLeds(4, 2, NEO_GRB + NEO_KHZ800);
+Adafruit_NeoPixel wandLeds(0, 3, NEO_GRB + NEO_KHZ800);
+WS2812Output ledsOutput(packLeds, wandLeds);
+
+// Engines writing their animation, then composed at now : returns the first byte sent
+uint8_t frame(uint8_t level, unsigned long now)
+{
+    memset(packLeds.getPixels(), level, packLeds.numPixels() * 3);
+    ledsOutput.compose(WS2812_CHAIN_A, now);
+    return packLeds.getPixels()[0];
+}
+
+int main()
+{
+    ledsOutput.beginCompositor(WS2812_CHAIN_A);
+    CHECK(frame(200, 0) == 200);
+    CHECK(frame(200, 500) == 200);
+
+    // Firing state fades in over the idle frame
+    ledsOutput.crossfade(WS2812_CHAIN_A, FADE_TIME, 1000);
+    uint8_t half = frame(0, 1000 + FADE_TIME / 2);
+    CHECK(half >= 95 && half <= 105);
+
+    // Tail state entered half way : its fade starts from the blend, and ends on the tail animation
+    ledsOutput.crossfade(WS2812_CHAIN_A, FADE_TIME, 1000 + FADE_TIME / 2);
+    uint8_t restart = frame(100, 1000 + FADE_TIME / 2);
+    CHECK(restart == half);
+    CHECK(frame(100, 1000 + FADE_TIME) <= 101);
+    CHECK(frame(100, 1000 + 2 * FADE_TIME) == 100);
+    printf("  fade restarted half way from %u, the frame of the state before was 200\n", restart);
+
+    // A fade started once the last one is over starts from its end frame
+    ledsOutput.crossfade(WS2812_CHAIN_A, FADE_TIME, 2000);
+    CHECK(frame(0, 2000) == 100);
+    CHECK(frame(0, 2000 + FADE_TIME) == 0);
+    return TEST_RESULT("test_ws2812_crossfade");
+}
@@ -0,0 +1,361 @@
+/*
+ *  test_ws2812_parallel.cpp is a part of SBK_HOST_TESTS (Version 0), host tests of SBK_PROTONPACK_CORE engines.
+ *  Copyright (c) 2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE/tree/main/Tools/SBK_HOST_TESTS>.
+ *
+ *  SBK_HOST_TESTS is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_HOST_TESTS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+/*  Parallel WS2812 output of WS2812OutputEngine.cpp : its bit loop asm is simulated cycle by cycle. */
+/*  run_tests.sh preprocesses the engine for ATmega328P and ATmega4809 and gives the file and the ST */
+/*  instruction cycles (2 on AVRe, 1 on AVRxt) : the asm string is taken from the preprocessed engine, */
+/*  so the NOPs really compiled for that MCU are the ones simulated. The bytes loop around the asm is */
+/*  mirrored here (shorter chain padded with zeros). The port writes are decoded like a WS2812 would : */
+/*  each chain must receive its pixels bytes, then the padding, with high, low and bit times in spec and */
+/*  the same cycles as the engine WS2812_CYCLES_T0H, WS2812_CYCLES_T1H and WS2812_CYCLES_BIT. */
+
+#include <map>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include "HostTest.h"
+
+#define CYCLE_NS 62.5 // 16 MHz
+#define PIN_A 0x04    // D2 and D3 on PORTD of a Nano
+#define PIN_B 0x08
+#define US_PER_BYTE 10 // WS2812_US_PER_BYTE, used for the interrupts off time
+
+struct Instruction
+{
+    std::string op;
+    std::vector<std::string> args;
+};
+
+struct Edge
+{
+    uint32_t cycle;
+    uint8_t port;
+};
+
+// asm volatile( "..." "..." : of _showParallel(), string literals joined
+static std::string asmSource(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+    {
+        return "";
+    }
+    std::string text;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+    {
+        text.append(buffer, n);
+    }
+    fclose(f);
+    size_t start = text.find("asm volatile(", text.find("WS2812Output::_showParallel"));
+    size_t end = text.find("\n            :", start);
+    std::string code;
+    bool inString = false;
+    for (size_t i = start; i < end; i++)
+    {
+        if (text[i] == '"')
+        {
+            inString = !inString;
+        }
+        else if (inString && text[i] == '\\' && i + 1 < end)
+        {
+            code += (text[i + 1] == 'n') ? '\n' : ' ';
+            i++;
+        }
+        else if (inString)
+        {
+            code += text[i];
+        }
+    }
+    return code;
+}
+
+static std::string trim(const std::string &s)
+{
+    size_t first = s.find_first_not_of(" \t");
+    size_t last = s.find_last_not_of(" \t");
+    return first == std::string::npos ? "" : s.substr(first, last - first + 1);
+}
+
+static std::vector<Instruction> parse(const std::string &code)
+{
+    std::vector<Instruction> program;
+    size_t pos = 0;
+    while (pos < code.size())
+    {
+        size_t eol = code.find('\n', pos);
+        std::string line = trim(code.substr(pos, eol - pos));
+        pos = (eol == std::string::npos) ? code.size() : eol + 1;
+        if (line.empty())
+        {
+            continue;
+        }
+        Instruction instruction;
+        size_t space = line.find(' ');
+        instruction.op = line.substr(0, space);
+        if (space != std::string::npos)
+        {
+            std::string args = line.substr(space + 1);
+            size_t comma;
+            while ((comma = args.find(',')) != std::string::npos)
+            {
+                instruction.args.push_back(trim(args.substr(0, comma)));
+                args = args.substr(comma + 1);
+            }
+            instruction.args.push_back(trim(args));
+        }
+        program.push_back(instruction);
+    }
+    return program;
+}
+
+class BitLoop
+{
+public:
+    BitLoop(const std::vector<Instruction> &program, uint8_t stCycles) : cycle(0), port(0), unknown(false), _program(program), _st(stCycles)
+    {
+        _reg["lo"] = port & ~(PIN_A | PIN_B);
+        _reg["hi"] = _reg["lo"] | PIN_A | PIN_B;
+        _reg["maskA"] = PIN_A;
+        _reg["maskB"] = PIN_B;
+    }
+
+    // One asm volatile() run : 8 bits of a and b
+    void run(uint8_t a, uint8_t b)
+    {
+        _reg["a"] = a;
+        _reg["b"] = b;
+        bool zero = false;
+        for (size_t pc = 0; pc < _program.size(); pc++)
+        {
+            const Instruction &in = _program[pc];
+            if (in.op == "1:")
+            {
+                continue;
+            }
+            if (in.op == "st")
+            {
+                port = _r(in.args[1]);
+                cycle += _st;
+                edges.push_back({cycle, port});
+            }
+            else if (in.op == "ldi")
+            {
+                _r(in.args[0]) = atoi(in.args[1].c_str());
+                cycle += 1;
+            }
+            else if (in.op == "mov")
+            {
+                _r(in.args[0]) = _r(in.args[1]);
+                cycle += 1;
+            }
+            else if (in.op == "or")
+            {
+                zero = (_r(in.args[0]) |= _r(in.args[1])) == 0;
+                cycle += 1;
+            }
+            else if (in.op == "lsl")
+            {
+                zero = (_r(in.args[0]) <<= 1) == 0;
+                cycle += 1;
+            }
+            else if (in.op == "dec")
+            {
+                zero = --_r(in.args[0]) == 0;
+                cycle += 1;
+            }
+            else if (in.op == "nop")
+            {
+                cycle += 1;
+            }
+            else if (in.op == "sbrc")
+            {
+                bool skip = !((_r(in.args[0]) >> atoi(in.args[1].c_str())) & 1);
+                cycle += skip ? 2 : 1;
+                pc += skip ? 1 : 0;
+            }
+            else if (in.op == "brne")
+            {
+                cycle += zero ? 1 : 2;
+                if (!zero)
+                {
+                    pc = _label();
+                }
+            }
+            else
+            {
+                printf("  unknown instruction %s\n", in.op.c_str());
+                unknown = true;
+            }
+        }
+    }
+
+    uint32_t cycle;
+    uint8_t port;
+    std::vector<Edge> edges;
+    bool unknown;
+
+private:
+    uint8_t &_r(const std::string &arg)
+    {
+        // %[name] or %a[name]
+        size_t open = arg.find('[');
+        return _reg[arg.substr(open + 1, arg.find(']') - open - 1)];
+    }
+    size_t _label()
+    {
+        for (size_t pc = 0; pc < _program.size(); pc++)
+        {
+            if (_program[pc].op == "1:")
+            {
+                return pc;
+            }
+        }
+        return 0;
+    }
+    const std::vector<Instruction> &_program;
+    uint8_t _st;
+    std::map<std::string, uint8_t> _reg;
+};
+
+// Cycles of the high and bit times, the same for every bit of both chains
+struct Timing
+{
+    uint32_t t0h;
+    uint32_t t1h;
+    uint32_t bit;
+    bool uniform;
+};
+
+// Sets the timing or checks it is the same as before
+static void same(uint32_t &timing, uint32_t cycles, bool &uniform)
+{
+    if (timing == 0)
+    {
+        timing = cycles;
+    }
+    uniform = uniform && (timing == cycles);
+}
+
+// WS2812B times are all typical +/- 150 ns
+static bool inRange(double ns, double typ)
+{
+    return ns >= typ - 150 && ns <= typ + 150;
+}
+
+// Bytes seen by the WS2812 on one pin, high, low and bit times checked against the WS2812B datasheet
+static std::vector<uint8_t> decode(const std::vector<Edge> &edges, uint8_t pin, Timing &timing)
+{
+    std::vector<uint8_t> bytes;
+    uint8_t level = 0, current = 0, bits = 0;
+    uint32_t rise = 0, lastRise = 0;
+    double lastHighNs = 0;
+    bool first = true, lastOne = false;
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        uint8_t newLevel = (edges[i].port & pin) ? 1 : 0;
+        if (newLevel == level)
+        {
+            continue;
+        }
+        level = newLevel;
+        if (level)
+        {
+            rise = edges[i].cycle;
+            if (!first)
+            {
+                double bitNs = (rise - lastRise) * CYCLE_NS;
+                CHECK(bitNs >= 650 && bitNs <= 1850);
+                CHECK(inRange(bitNs - lastHighNs, lastOne ? 450 : 850));
+                same(timing.bit, rise - lastRise, timing.uniform);
+            }
+            first = false;
+            lastRise = rise;
+            continue;
+        }
+        double highNs = (edges[i].cycle - rise) * CYCLE_NS;
+        bool one = highNs >= 600;
+        CHECK(inRange(highNs, one ? 800 : 400));
+        lastHighNs = highNs;
+        lastOne = one;
+        same(one ? timing.t1h : timing.t0h, edges[i].cycle - rise, timing.uniform);
+        current = (current << 1) | one;
+        if (++bits == 8)
+        {
+            bytes.push_back(current);
+            bits = 0;
+        }
+    }
+    return bytes;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 7)
+    {
+        printf("usage : test_ws2812_parallel <preprocessed WS2812OutputEngine.cpp> <ST cycles> <MCU> <T0H> <T1H> <bit>\n");
+        return 1;
+    }
+    std::vector<Instruction> program = parse(asmSource(argv[1]));
+    CHECK(program.size() > 0);
+    BitLoop loop(program, atoi(argv[2]));
+
+    // Pack chain 45 pixels, wand chain 7 pixels, all bytes values
+    std::vector<uint8_t> pixelsA(45 * 3), pixelsB(7 * 3);
+    for (size_t i = 0; i < pixelsA.size(); i++)
+    {
+        pixelsA[i] = i * 37 + 11;
+    }
+    for (size_t i = 0; i < pixelsB.size(); i++)
+    {
+        pixelsB[i] = 255 - i * 13;
+    }
+    pixelsB[0] = 0x00;
+    pixelsB[1] = 0xFF;
+    // Bytes loop of _showParallel()
+    size_t bytes = max(pixelsA.size(), pixelsB.size());
+    for (size_t i = 0; i < bytes; i++)
+    {
+        uint8_t a = (i < pixelsA.size()) ? pixelsA[i] : 0;
+        uint8_t b = (i < pixelsB.size()) ? pixelsB[i] : 0;
+        loop.run(a, b);
+    }
+    CHECK(!loop.unknown);
+
+    Timing timing = {0, 0, 0, true};
+    std::vector<uint8_t> outA = decode(loop.edges, PIN_A, timing);
+    std::vector<uint8_t> outB = decode(loop.edges, PIN_B, timing);
+    CHECK(timing.uniform);
+    // Engine constants used for its compile time spec check
+    CHECK(timing.t0h == (uint32_t)atoi(argv[4]));
+    CHECK(timing.t1h == (uint32_t)atoi(argv[5]));
+    CHECK(timing.bit == (uint32_t)atoi(argv[6]));
+    std::vector<uint8_t> paddedB = pixelsB;
+    paddedB.resize(bytes, 0);
+    CHECK(outA == pixelsA);
+    CHECK(outB == paddedB);
+    // Interrupts off time : the asm alone must fit the time given to _blackout()
+    double usPerByte = loop.cycle * CYCLE_NS / 1000 / bytes;
+    CHECK(usPerByte <= US_PER_BYTE);
+    printf("  %s : T0H %lu cycles (%.0f ns), T1H %lu cycles (%.0f ns), bit %lu cycles (%.0f ns), %.2f us per byte\n",
+           argv[3], (unsigned long)timing.t0h, timing.t0h * CYCLE_NS, (unsigned long)timing.t1h, timing.t1h * CYCLE_NS,
+           (unsigned long)timing.bit, timing.bit * CYCLE_NS, usPerByte);
+    std::string name = std::string("test_ws2812_parallel ") + argv[3];
+    return TEST_RESULT(name.c_str());
+}
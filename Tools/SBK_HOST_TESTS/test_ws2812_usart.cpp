@@ -0,0 +1,114 @@
+/*
+ *  test_ws2812_usart.cpp is a part of SBK_HOST_TESTS (Version 0), host tests of SBK_PROTONPACK_CORE engines.
+ *  Copyright (c) 2024 Samuel Barabé
+ *
+ *  See this page for reference <https://github.com/sbarabe/SBK_PROTONPACK_CORE/tree/main/Tools/SBK_HOST_TESTS>.
+ *
+ *  SBK_HOST_TESTS is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Foundation, either version
+ *  3 of the License, or (at your option) any later version.
+ *
+ *  SBK_HOST_TESTS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See
+ *  the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with Foobar. If not,
+ *  see <https://www.gnu.org/licenses/>
+ */
+
+/*  USART (SPI) output encoding of WS2812OutputEngine.cpp : WS2812Output::encodeUsart() turns each pixel */
+/*  byte into 3 symbol bytes, 3 SPI bits for each WS2812 bit (100 = 0, 110 = 1), MSB first. Every byte */
+/*  value is checked against its expected 24 SPI bits, then a whole frame is encoded and its SPI bit */
+/*  stream decoded like a WS2812 would, with the SPI bit time of the ATmega4809 output (6 cycles). */
+
+#include <Arduino.h>
+#include "HostTest.h"
+#include "WS2812OutputEngine.h"
+
+#define SPI_BIT_NS 375 // F_CPU / 6 at 16 MHz
+#define FRAME_BYTES (45 * 3)
+
+// Output of the engine not used on host, only linked
+void Adafruit_NeoPixel::show() {}
+void Adafruit_NeoPixel::setPixelColor(uint16_t, uint8_t, uint8_t, uint8_t) {}
+
+// WS2812B times are all typical +/- 150 ns
+static bool inRange(uint32_t ns, uint32_t typ)
+{
+    return ns + 150 >= typ && ns <= typ + 150;
+}
+
+// SPI bit n of a symbols buffer, MSB first
+static uint8_t spiBit(const uint8_t *symbols, uint32_t n)
+{
+    return (symbols[n / 8] >> (7 - n % 8)) & 1;
+}
+
+int main()
+{
+    // Symbol table : 24 SPI bits of each byte value
+    uint8_t symbols[3 * FRAME_BYTES + 1];
+    bool symbolsOk = true;
+    for (uint16_t value = 0; value < 256; value++)
+    {
+        uint8_t pixel = value;
+        WS2812Output::encodeUsart(&pixel, 1, symbols);
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            uint8_t one = (value >> (7 - bit)) & 1;
+            symbolsOk = symbolsOk && spiBit(symbols, bit * 3) == 1 && spiBit(symbols, bit * 3 + 1) == one && spiBit(symbols, bit * 3 + 2) == 0;
+        }
+    }
+    CHECK(symbolsOk);
+
+    // Whole frame : 3 symbol bytes per pixel byte, nothing written after
+    uint8_t pixels[FRAME_BYTES];
+    for (uint16_t i = 0; i < FRAME_BYTES; i++)
+    {
+        pixels[i] = i * 37 + 11;
+    }
+    symbols[3 * FRAME_BYTES] = 0xA5;
+    WS2812Output::encodeUsart(pixels, FRAME_BYTES, symbols);
+    CHECK(symbols[3 * FRAME_BYTES] == 0xA5);
+
+    // SPI bit stream seen by the WS2812 : high times give the bits, high and low times in WS2812B spec
+    uint8_t decoded[FRAME_BYTES] = {};
+    uint32_t bits = 0, high = 0, t0h = 0, t1h = 0, lastRise = 0, lastHighNs = 0, period = 0;
+    bool timingOk = true, lastOne = false;
+    for (uint32_t n = 0; n <= 3 * 8 * FRAME_BYTES; n++)
+    {
+        uint8_t level = (n < 3 * 8 * FRAME_BYTES) ? spiBit(symbols, n) : 0; // line low after the frame
+        if (level && high == 0)
+        {
+            if (bits > 0)
+            {
+                period = (n - lastRise) * SPI_BIT_NS;
+                timingOk = timingOk && period >= 650 && period <= 1850 && inRange(period - lastHighNs, lastOne ? 450 : 850);
+            }
+            lastRise = n;
+        }
+        if (level)
+        {
+            high++;
+            continue;
+        }
+        if (high > 0)
+        {
+            uint32_t highNs = high * SPI_BIT_NS;
+            uint8_t one = highNs >= 600;
+            timingOk = timingOk && inRange(highNs, one ? 800 : 400);
+            lastHighNs = highNs;
+            lastOne = one;
+            (one ? t1h : t0h) = highNs;
+            decoded[bits / 8] |= one << (7 - bits % 8);
+            bits++;
+            high = 0;
+        }
+    }
+    CHECK(bits == 8 * FRAME_BYTES);
+    CHECK(memcmp(decoded, pixels, FRAME_BYTES) == 0);
+    CHECK(timingOk);
+    printf("  T0H %lu ns, T1H %lu ns, T0L %lu ns, T1L %lu ns, bit %lu ns, %u symbol bytes for %u pixel bytes\n",
+           (unsigned long)t0h, (unsigned long)t1h, (unsigned long)(period - t0h), (unsigned long)(period - t1h), (unsigned long)period, 3 * FRAME_BYTES, FRAME_BYTES);
+    return TEST_RESULT("test_ws2812_usart");
+}
@@ -0,0 +1,250 @@
+#!/usr/bin/env python3
+###############################################################################################
+#    SBK_KEYFRAME_ENCODER encodes WS2812 LEDs animations for the KeyframeEngine player of
+#    SBK_PROTONPACK_CORE.
+#    Copyright (c) 2024 Samuel Barabé
+#
+#    This program is free software: you can redistribute it and/or modify it under the terms
+#    of the GNU General Public License as published by the Free Software Foundation, either
+#    version 3 of the License, or any later version.
+#
+#    This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+#    without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+#    See the GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License along with this program.
+#    If not, see <https://www.gnu.org/licenses/>.
+###############################################################################################
+
+###############################################################################################
+#    GENERAL INFO :
+#
+#    SBK_KEYFRAME_ENCODER
+#    <https://github.com/sbarabe/SBK_PROTONPACK_CORE/tree/main/Tools/SBK_KEYFRAME_ENCODER">
+#    Version 0
+#
+#    Runs on the host computer (Python 3, no extra modules) :
+#
+#      python3 sbk_keyframe_encoder.py vent_boot.csv --name KF_VENT_BOOT --period 20 -o ../../SBK_PROTONPACK_CORE/KeyframeVentBoot.h
+#
+#    -o writes one generated header per animation, included by KeyframeAnimations.h. It only
+#    replaces a file written by the encoder, never a sketch file. Without -o, the C array is
+#    printed on the console to be pasted in KeyframeAnimations.h.
+#
+#    1) CSV input : one keyframe per line, "hold,r,g,b,r,g,b,..." with one r,g,b triplet per pixel
+#       and hold the number of periods the keyframe is shown. Lines starting with # are ignored.
+#    2) PNG input (8 bits RGB or RGBA, not interlaced) : one image row per period, one image
+#       column per pixel, top row first.
+#    3) Identical following keyframes are merged, then each keyframe is delta and run-length
+#       encoded against the previous one. The C array is written for the sketch and the raw
+#       and compressed sizes are reported on the console.
+#
+#    Stream format, read by KeyframeEngine.cpp :
+#      header   : pixels, period (ms), frames (uint16_t, low byte first)
+#      keyframe : hold (periods, 1 to 255), then ops until all the pixels are covered
+#      ops      : 0x00-0x7F SKIP  (h & 0x7F) + 1 pixels unchanged
+#                 0x80-0xBF COPY  (h & 0x3F) + 1 pixels, their R,G,B follow
+#                 0xC0-0xFF FILL  (h & 0x3F) + 1 pixels, one R,G,B follows
+#    The first keyframe is encoded against all pixels OFF, the player restarts from there.
+###############################################################################################
+
+import argparse
+import csv
+import struct
+import sys
+import zlib
+
+GENERATED = '// Generated by Tools/SBK_KEYFRAME_ENCODER'
+SKIP_MAX = 128
+RUN_MAX = 64
+HOLD_MAX = 255
+
+
+def read_csv(path):
+    frames = []
+    with open(path, newline='') as f:
+        for row in csv.reader(f):
+            row = [c.strip() for c in row if c.strip() != '']
+            if not row or row[0].startswith('#'):
+                continue
+            values = [int(c, 0) for c in row]
+            hold, data = values[0], values[1:]
+            if hold < 1:
+                sys.exit('%s: hold must be 1 or more' % path)
+            if len(data) % 3:
+                sys.exit('%s: a line is not made of r,g,b triplets' % path)
+            if any(v < 0 or v > 255 for v in data):
+                sys.exit('%s: colors are 0 to 255' % path)
+            frames.append((hold, bytes(data)))
+    return frames
+
+
+def read_png(path):
+    with open(path, 'rb') as f:
+        blob = f.read()
+    if blob[:8] != b'\x89PNG\r\n\x1a\n':
+        sys.exit('%s: not a PNG file' % path)
+    pos, idat = 8, b''
+    while pos < len(blob):
+        length, kind = struct.unpack('>I4s', blob[pos:pos + 8])
+        chunk = blob[pos + 8:pos + 8 + length]
+        if kind == b'IHDR':
+            width, height, depth, color, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+        elif kind == b'IDAT':
+            idat += chunk
+        pos += length + 12
+    if depth != 8 or color not in (2, 6) or interlace:
+        sys.exit('%s: only 8 bits RGB/RGBA not interlaced PNG are supported' % path)
+    bpp = 3 if color == 2 else 4
+    stride = width * bpp
+    raw = zlib.decompress(idat)
+    prev = bytearray(stride)
+    frames = []
+    for y in range(height):
+        kind = raw[y * (stride + 1)]
+        line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for i in range(stride):
+            a = line[i - bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i - bpp] if i >= bpp else 0
+            if kind == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif kind == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif kind == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xFF
+            elif kind == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                line[i] = (line[i] + (a if pa <= pb and pa <= pc else b if pb <= pc else c)) & 0xFF
+        prev = line
+        frames.append((1, bytes(v for i, v in enumerate(line) if i % bpp < 3)))
+    return frames
+
+
+def merge_holds(frames):
+    merged = []
+    for hold, data in frames:
+        while merged and merged[-1][1] == data and merged[-1][0] < HOLD_MAX and hold > 0:
+            take = min(hold, HOLD_MAX - merged[-1][0])
+            merged[-1] = (merged[-1][0] + take, data)
+            hold -= take
+        while hold > 0:
+            merged.append((min(hold, HOLD_MAX), data))
+            hold -= min(hold, HOLD_MAX)
+    return merged
+
+
+def pixel(data, i):
+    return data[i * 3:i * 3 + 3]
+
+
+def run_length(data, i, limit):
+    n = 1
+    while (i + n) * 3 < len(data) and n < limit and pixel(data, i + n) == pixel(data, i):
+        n += 1
+    return n
+
+
+def skip_length(data, prev, i, limit):
+    n = 0
+    while (i + n) * 3 < len(data) and n < limit and pixel(data, i + n) == pixel(prev, i + n):
+        n += 1
+    return n
+
+
+def encode_frame(data, prev):
+    out = bytearray()
+    pixels = len(data) // 3
+    i = 0
+    while i < pixels:
+        skip = skip_length(data, prev, i, SKIP_MAX)
+        if skip:
+            out.append(skip - 1)
+            i += skip
+            continue
+        run = run_length(data, i, RUN_MAX)
+        if run >= 2:
+            out.append(0xC0 | (run - 1))
+            out += pixel(data, i)
+            i += run
+            continue
+        # Literal pixels until a skip or a run is worth its own op
+        n = 0
+        while i + n < pixels and n < RUN_MAX:
+            if n and (skip_length(data, prev, i + n, 1) or run_length(data, i + n, 2) >= 2):
+                break
+            n += 1
+        out.append(0x80 | (n - 1))
+        out += data[i * 3:(i + n) * 3]
+        i += n
+    return out
+
+
+def encode(frames, pixels, period):
+    stream = bytearray((pixels, period)) + struct.pack('<H', len(frames))
+    prev = bytes(pixels * 3)
+    worst = 0
+    for hold, data in frames:
+        ops = encode_frame(data, prev)
+        worst = max(worst, len(ops))
+        stream.append(hold)
+        stream += ops
+        prev = data
+    return stream, worst
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Encode a WS2812 LEDs animation for the SBK_PROTONPACK_CORE keyframe player.')
+    parser.add_argument('input', help='CSV or PNG animation')
+    parser.add_argument('--name', default='KF_ANIMATION', help='C array name')
+    parser.add_argument('--period', type=int, default=20, help='period of one hold step, in ms (1 to 255)')
+    parser.add_argument('-o', '--output', help='header file to write, console if not set')
+    args = parser.parse_args()
+
+    if not 1 <= args.period <= 255:
+        sys.exit('period must be 1 to 255 ms')
+    frames = read_png(args.input) if args.input.lower().endswith('.png') else read_csv(args.input)
+    if not frames:
+        sys.exit('%s: no keyframe' % args.input)
+    pixels = len(frames[0][1]) // 3
+    if pixels < 1 or pixels > 255 or any(len(data) != pixels * 3 for _, data in frames):
+        sys.exit('%s: all keyframes need the same number of pixels (1 to 255)' % args.input)
+    frames = merge_holds(frames)
+    if len(frames) > 0xFFFF:
+        sys.exit('%s: too many keyframes' % args.input)
+
+    stream, worst = encode(frames, pixels, args.period)
+    raw = len(frames) * (pixels * 3 + 1) + 4
+    duration = sum(hold for hold, _ in frames) * args.period
+
+    lines = ['// %s : %d pixels, %d keyframes, %d ms, %d bytes (%d raw)'
+             % (args.name, pixels, len(frames), duration, len(stream), raw),
+             '%s from %s' % (GENERATED, args.input.replace('\\', '/').split('/')[-1]),
+             'const uint8_t %s[] PROGMEM = {' % args.name]
+    for i in range(0, len(stream), 16):
+        lines.append('    ' + ', '.join('0x%02X' % b for b in stream[i:i + 16]) + ',')
+    lines.append('};')
+    text = '\n'.join(lines) + '\n'
+
+    if args.output:
+        # Header of its own : a sketch file is never overwritten
+        try:
+            with open(args.output) as f:
+                if not f.readline().startswith(GENERATED):
+                    sys.exit('%s: not written by the encoder, choose a new file' % args.output)
+        except FileNotFoundError:
+            pass
+        guard = args.output.replace('\\', '/').split('/')[-1].upper().replace('.', '_')
+        with open(args.output, 'w') as f:
+            f.write('%s, do not edit : run the encoder again\n#ifndef %s\n#define %s\n\n#include <Arduino.h>\n\n%s\n#endif\n'
+                    % (GENERATED, guard, guard, text))
+    else:
+        sys.stdout.write(text)
+    sys.stderr.write('%s: %d pixels, %d keyframes, %d ms\n' % (args.name, pixels, len(frames), duration))
+    sys.stderr.write('    compressed %d bytes, raw %d bytes (%.1f %%)\n' % (len(stream), raw, 100.0 * len(stream) / raw))
+    sys.stderr.write('    largest keyframe %d bytes of ops for %d bytes of pixels\n' % (worst, pixels * 3))
+
+
+if __name__ == '__main__':
+    main()